@@ -35,47 +35,238 @@ int mpz_to_int_array(mpz_t input_int, int *output_array) {
     return len;
 }
 
-void int_array_to_mpz(int *polynomial_result, int n, mpz_t* total_result){
-    // //Convert to the real number
-    mpz_t temp, result, power;
+int mpz_to_double_array(mpz_t input_int, double *output_array, int stride) {
+    // Convert mpz_t to a string in base 10
+    char* int_str = mpz_get_str(NULL, 10, input_int);
+    int len = strlen(int_str);
+
+    // Store digits in reverse order
+    for (int i = 0; i < len; i++) {
+        output_array[i * stride] = int_str[len - 1 - i] - '0';
+    }
+
+    // Free the allocated string
+    free(int_str);
+    return len;
+}
+
+int limbs_to_coefficients(const mp_limb_t *limbs, size_t limb_count, int bits,
+                            double *output_array, int stride) {
+    // Skip zero limbs at the top, then count the bits. mpn_sizeinbase is
+    // exact for base 2 whatever the width of a limb
+    while (limb_count > 0 && limbs[limb_count - 1] == 0) {
+        limb_count--;
+    }
+    if (limb_count == 0) {
+        return 0;
+    }
+    size_t total_bits = mpn_sizeinbase(limbs, limb_count, 2);
+    int count = (total_bits + bits - 1) / bits;
+    mp_limb_t mask = ((mp_limb_t)1 << bits) - 1;
+
+    // A coefficient starts at bit shift of a limb and may continue in the
+    // next one. Every coefficient is computed on its own from its position,
+    // with no bit buffer carried from one iteration to the next
+    size_t position = 0;
+    for (int i = 0; i < count; i++, position += bits) {
+        size_t index = position / GMP_NUMB_BITS;
+        int shift = position % GMP_NUMB_BITS;
+        mp_limb_t value = limbs[index] >> shift;
+        if (index + 1 < limb_count) {
+            // (x << 1) << (63 - shift) is x << (64 - shift), without the
+            // undefined shift by 64 when shift is 0
+            value |= (limbs[index + 1] << 1) << (GMP_NUMB_BITS - 1 - shift);
+        }
+        output_array[i * stride] = (double)(value & mask);
+    }
+    return count;
+}
+
+int mpz_to_coefficients(mpz_t input_int, int bits, double *output_array, int stride) {
+    return limbs_to_coefficients(mpz_limbs_read(input_int), mpz_size(input_int),
+                                    bits, output_array, stride);
+}
 
-    // The below for loop is calculating the following line using GMP
+size_t coefficients_to_limbs(double *polynomial_result, int n, int bits,
+                                mp_limb_t *limbs, size_t limb_count) {
+    memset(limbs, 0, limb_count * sizeof(mp_limb_t));
+
+    mp_limb_t mask = ((mp_limb_t)1 << bits) - 1;
+    uint64_t carry = 0;
+    size_t position = 0;
+    // After the last coefficient only the carry is left, it has up to 64
+    // bits so it is written bits bits at a time like the coefficients
+    for (int i = 0; i < n || carry != 0; i++, position += bits) {
+        if (i < n) {
+            // The product coefficients are non-negative, small negative
+            // rounding errors round to 0
+            carry += (uint64_t)llround(polynomial_result[i]);
+        }
+        mp_limb_t value = carry & mask;
+        carry >>= bits;
+        // The top coefficients of a product are zero and may lie past the
+        // end of limbs, only the bits that are set are written
+        if (value == 0) {
+            continue;
+        }
+
+        size_t index = position / GMP_NUMB_BITS;
+        int shift = position % GMP_NUMB_BITS;
+        assert(index < limb_count);
+        limbs[index] |= value << shift;
+        if (shift + bits > GMP_NUMB_BITS && (value >> (GMP_NUMB_BITS - shift)) != 0) {
+            assert(index + 1 < limb_count);
+            limbs[index + 1] |= value >> (GMP_NUMB_BITS - shift);
+        }
+    }
+    while (limb_count > 0 && limbs[limb_count - 1] == 0) {
+        limb_count--;
+    }
+    return limb_count;
+}
+
+void coefficients_to_mpz(double *polynomial_result, int n, int bits,
+                            mpz_t total_result) {
+    // n coefficients of bits bits, plus the carry left after the last one
+    size_t limb_count = ((size_t)n * bits + 64) / GMP_NUMB_BITS + 1;
+    mp_limb_t *limbs = mpz_limbs_write(total_result, limb_count);
+    limb_count = coefficients_to_limbs(polynomial_result, n, bits, limbs, limb_count);
+    mpz_limbs_finish(total_result, limb_count);
+}
+
+// Decimal digits per chunk, 10^19 is the largest power of 10 in a uint64_t
+#define DECIMAL_CHUNK_DIGITS 19
+
+// Add the number with the coefficients in base 10^digits to total_result
+// 1. One carry pass turns the coefficients into values 0..10^digits - 1. A
+//    coefficient can be negative (or rounding can make it slightly
+//    negative), the carry is then negative too, so the value is the
+//    remainder rounded down
+// 2. As many coefficients as fit in 19 digits are read into uint64_t chunks
+// 3. The chunks are combined in pairs, chunk[2i] + chunk[2i+1] * 10^(w*2^level)
+//    for a chunk of w digits, halving the count at every level. The last
+//    levels multiply numbers of half the final size, so GMP's fast
+//    multiplication does the work and the whole assembly is O(M(n) log n)
+//    instead of one mpz_mul per digit
+static void Decimal_Coefficients_To_Mpz(long long *coefficients, int n, int digits,
+                                        mpz_t total_result) {
+    long long base = 1;
+    for (int i = 0; i < digits; i++) {
+        base *= 10;
+    }
+    long long carry = 0;
     for (int i = 0; i < n; i++) {
-        mpz_inits(temp, result, power, NULL);
-        // Calculate 10^i using GMP
-        mpz_ui_pow_ui(power, 10, i);
+        long long value = coefficients[i] + carry;
+        long long digit = value % base;
+        if (digit < 0) {
+            digit += base;
+        }
+        carry = (value - digit) / base;
+        coefficients[i] = digit;
+    }
 
-        // Convert creal(result[i]) to nearest integer and multiply by 10^i
-        mpz_set_d(temp, floor(creal(polynomial_result[i]) + 0.5));
-        mpz_mul(result, temp, power);
+    int per_chunk = DECIMAL_CHUNK_DIGITS / digits;
+    int chunk_count = (n + per_chunk - 1) / per_chunk;
+    mpz_t *chunks = (mpz_t *)malloc((chunk_count + 1) * sizeof(mpz_t));
+    for (int chunk = 0; chunk < chunk_count; chunk++) {
+        // The coefficients are stored lowest first, so read them from the
+        // top down
+        unsigned long value = 0;
+        int first = chunk * per_chunk;
+        int last = (first + per_chunk < n) ? first + per_chunk : n;
+        for (int i = last - 1; i >= first; i--) {
+            value = value * base + coefficients[i];
+        }
+        mpz_init_set_ui(chunks[chunk], value);
+    }
+
+    mpz_t power, high;
+    mpz_inits(power, high, NULL);
+    mpz_ui_pow_ui(power, 10, per_chunk * digits);
+    int count = chunk_count;
+    while (count > 1) {
+        for (int i = 0; i < count / 2; i++) {
+            mpz_mul(high, chunks[2 * i + 1], power);
+            mpz_add(chunks[i], chunks[2 * i], high);
+        }
+        if (count & 1) {
+            mpz_set(chunks[count / 2], chunks[count - 1]);
+        }
+        for (int i = (count + 1) / 2; i < count; i++) {
+            mpz_clear(chunks[i]);
+        }
+        count = (count + 1) / 2;
+        mpz_mul(power, power, power);
+    }
 
-        // Add to the total result
-        mpz_add(total_result[0], total_result[0], result);
-        // Cleanup
-        mpz_clears(temp, result, power, NULL);
+    if (chunk_count > 0) {
+        mpz_add(total_result, total_result, chunks[0]);
+        mpz_clear(chunks[0]);
     }
+    // Whatever is left in the carry is worth carry * 10^(n * digits)
+    if (carry != 0) {
+        mpz_ui_pow_ui(power, 10, (unsigned long)n * digits);
+        mpz_set_si(high, carry);
+        mpz_addmul(total_result, high, power);
+    }
+    mpz_clears(power, high, NULL);
+    free(chunks);
+}
+
+void int_array_to_mpz(int *polynomial_result, int n, mpz_t* total_result){
+    long long *coefficients = (long long *)malloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++) {
+        coefficients[i] = polynomial_result[i];
+    }
+    Decimal_Coefficients_To_Mpz(coefficients, n, 1, total_result[0]);
+    free(coefficients);
 }
 
 void complex_array_to_mpz(complex double *polynomial_result, int n,
                             mpz_t* total_result){
-    // //Convert to the real number
-    mpz_t temp, result, power;
-
-    // The below for loop is calculating the following line using GMP
+    // Round the real parts to the nearest integer
+    long long *coefficients = (long long *)malloc(n * sizeof(long long));
     for (int i = 0; i < n; i++) {
-        mpz_inits(temp, result, power, NULL);
-        // Calculate 10^i using GMP
-        mpz_ui_pow_ui(power, 10, i);
+        coefficients[i] = llround(creal(polynomial_result[i]));
+    }
+    Decimal_Coefficients_To_Mpz(coefficients, n, 1, total_result[0]);
+    free(coefficients);
+}
 
-        // Convert creal(result[i]) to nearest integer and multiply by 10^i
-        mpz_set_d(temp, floor(creal(polynomial_result[i]) + 0.5));
-        mpz_mul(result, temp, power);
+int mpz_to_decimal_coefficients(mpz_t input_int, int digits, double *output_array,
+                                int stride) {
+    // One radix conversion, then the digits are read in groups of digits
+    // from the lowest one, the last group can be shorter
+    char *int_str = mpz_get_str(NULL, 10, input_int);
+    char *first = (int_str[0] == '-') ? int_str + 1 : int_str;
+    int len = strlen(first);
+    if (len == 1 && first[0] == '0') {
+        free(int_str);
+        return 0;
+    }
+    int count = (len + digits - 1) / digits;
+    for (int i = 0; i < count; i++) {
+        int end = len - i * digits;
+        int start = (end - digits > 0) ? end - digits : 0;
+        int value = 0;
+        for (int j = start; j < end; j++) {
+            value = value * 10 + (first[j] - '0');
+        }
+        output_array[i * stride] = value;
+    }
+    free(int_str);
+    return count;
+}
 
-        // Add to the total result
-        mpz_add(total_result[0], total_result[0], result);
-        // Cleanup
-        mpz_clears(temp, result, power, NULL);
+void decimal_coefficients_to_mpz(double *polynomial_result, int n, int digits,
+                                    mpz_t total_result) {
+    long long *coefficients = (long long *)malloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++) {
+        coefficients[i] = llround(polynomial_result[i]);
     }
+    mpz_set_ui(total_result, 0);
+    Decimal_Coefficients_To_Mpz(coefficients, n, digits, total_result);
+    free(coefficients);
 }
 
 void Int_to_Array(long long input_int, complex double *output_array){
@@ -169,6 +360,73 @@ unsigned int Bit_Reverse(unsigned int x, int log2n) {
     return n;
 }
 
+// COBRA, Carter and Gatlin "Towards an optimal bit-reversal permutation program"
+// The index of a value is split into three parts (high b bits, middle bits,
+// low b bits) and the bit reversal maps (high, middle, low) to
+// (reverse(low), reverse(middle), reverse(high)). For every middle part the
+// 2^b x 2^b values with that middle part are read row by row into a small
+// buffer and written row by row to the output, so both the reads and the
+// writes are runs of 2^b consecutive values instead of scattered single
+// values that miss the cache when n is large.
+void COBRA_Bit_Reverse(complex double *input, complex double *output, int log2n) {
+    int block_bits = COBRA_BLOCK_BITS;
+    int block_size = 1 << block_bits;
+    int middle_bits = log2n - 2 * block_bits;
+    int high_shift = log2n - block_bits;
+    complex double buffer[block_size * block_size];
+
+    unsigned int reverse_block[block_size];
+    for (int i = 0; i < block_size; i++) {
+        reverse_block[i] = Bit_Reverse(i, block_bits);
+    }
+
+    for (int middle = 0; middle < (1 << middle_bits); middle++) {
+        int reverse_middle = Bit_Reverse(middle, middle_bits);
+
+        // Row reverse(high) of the buffer gets the values (high, middle, low)
+        for (int high = 0; high < block_size; high++) {
+            complex double *source = input + (high << high_shift) +
+                                        (middle << block_bits);
+            complex double *row = buffer + reverse_block[high] * block_size;
+            for (int low = 0; low < block_size; low++) {
+                row[low] = source[low];
+            }
+        }
+
+        // (reverse(low), reverse(middle), reverse(high)) is column low of row
+        // reverse(high), so every output run is one column of the buffer
+        for (int low = 0; low < block_size; low++) {
+            complex double *destination = output +
+                                            (reverse_block[low] << high_shift) +
+                                            (reverse_middle << block_bits);
+            for (int high = 0; high < block_size; high++) {
+                destination[high] = buffer[high * block_size + low];
+            }
+        }
+    }
+}
+
+// A plain transpose reads rows and writes columns, and every value written
+// to a column is in a different cache line. Going through the matrix in
+// small tiles lets the cache lines of the output column be filled completely
+// before they are evicted
+void Transpose_Blocked(complex double *input, int rows, int cols,
+                        complex double *output) {
+    for (int row_block = 0; row_block < rows; row_block += TRANSPOSE_BLOCK) {
+        int row_end = (row_block + TRANSPOSE_BLOCK < rows) ?
+                        row_block + TRANSPOSE_BLOCK : rows;
+        for (int col_block = 0; col_block < cols; col_block += TRANSPOSE_BLOCK) {
+            int col_end = (col_block + TRANSPOSE_BLOCK < cols) ?
+                            col_block + TRANSPOSE_BLOCK : cols;
+            for (int col = col_block; col < col_end; col++) {
+                for (int row = row_block; row < row_end; row++) {
+                    output[col * rows + row] = input[row * cols + col];
+                }
+            }
+        }
+    }
+}
+
 int get_half_length(mpz_t num) {
     char num_str[mpz_sizeinbase(num, 10) + 2];  // Ensure enough space for '\0'
     mpz_get_str(num_str, 10, num);  // Convert number to string base 10
@@ -196,4 +454,32 @@ void Array_Multiplication(int *input1, int *input2, int length_input1,
             result[i + j] += input1[i] * input2[j];
         }
     }
-}
\ No newline at end of file
+}
+
+void Array_Square(int *input, int length, int *result) {
+    memset(result, 0, (2 * length - 1) * sizeof(int));
+    // input[i] * input[j] and input[j] * input[i] are the same product, so
+    // every pair i < j is multiplied once and doubled
+    for (int i = 0; i < length; i++) {
+        for (int j = i + 1; j < length; j++) {
+            result[i + j] += input[i] * input[j];
+        }
+    }
+    for (int i = 0; i < 2 * length - 1; i++) {
+        result[i] *= 2;
+    }
+    for (int i = 0; i < length; i++) {
+        result[2 * i] += input[i] * input[i];
+    }
+}
+
+void Random_Digits(mpz_t value, gmp_randstate_t state, int digits) {
+    mpz_t low;
+    mpz_init(low);
+    mpz_ui_pow_ui(low, 10, digits - 1);
+    // 10^(digits-1) + random below 9 * 10^(digits-1)
+    mpz_mul_ui(value, low, 9);
+    mpz_urandomm(value, state, value);
+    mpz_add(value, value, low);
+    mpz_clear(low);
+}
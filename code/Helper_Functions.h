@@ -6,6 +6,7 @@
 #include <math.h>
 #include <complex.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
 #include <sys/ioctl.h>
@@ -18,10 +19,54 @@
 
 int mpz_to_complex_array(mpz_t input_int, complex double *output_array);
 
+// Add the number with the decimal coefficients polynomial_result (rounded
+// real parts) to total_result, in one carry pass and a divide and conquer
+// assembly
 void complex_array_to_mpz(complex double *polynomial_result, int n, mpz_t* total_result);
 
 int mpz_to_int_array(mpz_t input_int, int *output_array);
 
+// Store the digits in every stride'th double, with stride 2 on a complex
+// array the digits go into the real parts (output_array) or the imaginary
+// parts (output_array + 1)
+int mpz_to_double_array(mpz_t input_int, double *output_array, int stride);
+
+// Binary coefficients straight from the limbs of a number
+// The decimal conversions above need mpz_get_str, which is a radix
+// conversion and a malloc'd string on every call. Reading the limbs with
+// mpz_limbs_read and cutting them into coefficients of a fixed number of
+// bits is a single pass with no allocation, coefficient i is bits
+// i*bits..(i+1)*bits-1 of the number. bits must be between 1 and 32, the
+// number of coefficients written is returned (0 for the number 0)
+int limbs_to_coefficients(const mp_limb_t *limbs, size_t limb_count, int bits,
+                            double *output_array, int stride);
+
+// limbs_to_coefficients on the absolute value of input_int
+int mpz_to_coefficients(mpz_t input_int, int bits, double *output_array, int stride);
+
+// The carry pass of coefficients_to_mpz into limb_count limbs, which must
+// hold the whole number. Returns the number of limbs up to the highest
+// non-zero one
+size_t coefficients_to_limbs(double *polynomial_result, int n, int bits,
+                                mp_limb_t *limbs, size_t limb_count);
+
+// The inverse of mpz_to_coefficients for a product: rounds the n
+// coefficients, carries everything above bits bits into the next coefficient
+// in one pass and writes the bits straight into the limbs of total_result
+void coefficients_to_mpz(double *polynomial_result, int n, int bits, mpz_t total_result);
+
+// Store the absolute value of input_int in base 10^digits (digits at most
+// 9), one coefficient in every stride'th double, lowest first. Returns the
+// number of coefficients, 0 for the number 0
+int mpz_to_decimal_coefficients(mpz_t input_int, int digits, double *output_array,
+                                int stride);
+
+// The inverse of mpz_to_decimal_coefficients for a product: rounds the n
+// coefficients and carries them in base 10^digits into total_result
+void decimal_coefficients_to_mpz(double *polynomial_result, int n, int digits,
+                                    mpz_t total_result);
+
+// Same as complex_array_to_mpz for integer coefficients
 void int_array_to_mpz(int *polynomial_result, int n, mpz_t* total_result);
 
 // // Initialize a and b with inverse number, I.E 27 = a[0] = 7 and a[1] = 2
@@ -44,6 +89,22 @@ bool Correctness_Check(mpz_t result1, mpz_t result2);
 // of given index x
 unsigned int Bit_Reverse(unsigned int x, int log2n);
 
+// Blocks of 2^COBRA_BLOCK_BITS x 2^COBRA_BLOCK_BITS complex values (16 KB)
+// fit in the L1 cache
+#define COBRA_BLOCK_BITS 5
+
+// Cache optimal bit reversal (COBRA) of an array of 2^log2n values,
+// log2n must be at least 2 * COBRA_BLOCK_BITS
+void COBRA_Bit_Reverse(complex double *input, complex double *output, int log2n);
+
+// Tiles of TRANSPOSE_BLOCK x TRANSPOSE_BLOCK complex values (4 KB) are read
+// and written while both fit in the L1 cache
+#define TRANSPOSE_BLOCK 16
+
+// output (cols x rows) = transpose of input (rows x cols), both row-major
+void Transpose_Blocked(complex double *input, int rows, int cols,
+                        complex double *output);
+
 // calculate the half length of a value
 int get_half_length(mpz_t num);
 
@@ -53,4 +114,10 @@ void Array_Subtraction(int *a, int *b, int length, int *result);
 
 void Array_Multiplication(int *input1, int *input2, int length_input1, int length_input2, int *result);
 
+// Array_Multiplication of input with itself, about half the multiplications
+void Array_Square(int *input, int length, int *result);
+
+// A random number with exactly digits decimal digits
+void Random_Digits(mpz_t value, gmp_randstate_t state, int digits);
+
 #endif
\ No newline at end of file
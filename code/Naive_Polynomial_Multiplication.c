@@ -10,12 +10,18 @@ void Naive_Polynomial_Multiplication(int *input1, int *input2, int n, int *out){
 }
 
 double Polynomial_Multiply_Naive(mpz_t a, mpz_t b, int n, int* total_result){ 
- 
-    int padded_a[n], padded_b[n], polynomial_result[n];
+    return Polynomial_Multiply_Naive_ctx(a, b, n, total_result,
+                                            Get_Default_Multiply_Context(n));
+}
+
+double Polynomial_Multiply_Naive_ctx(mpz_t a, mpz_t b, int n, int* total_result,
+                                        Multiply_Context *context){
+    assert(n <= context->max_n);
+    int *padded_a = (int *)Context_Buffer(context, 0, context->max_n * sizeof(int));
+    int *padded_b = (int *)Context_Buffer(context, 1, context->max_n * sizeof(int));
 
     memset(padded_a, 0, n * sizeof(int));
     memset(padded_b, 0, n * sizeof(int));
-    memset(polynomial_result, 0, n * sizeof(int));
 
     mpz_to_int_array(a, padded_a); // Assume correct implementation
     mpz_to_int_array(b, padded_b);
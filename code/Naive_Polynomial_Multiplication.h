@@ -2,10 +2,15 @@
 #ifndef STANDARD_H
 #define STANDARD_H
 #include "Helper_Functions.h"
+#include "multiply_context.h"
 
 // Declare the function(s) from dft.c here
 void Naive_Polynomial_Multiplication(int *input1, int *input2, int n, int *out);
 
 double Polynomial_Multiply_Naive(mpz_t a, mpz_t b, int n, int* total_result);
 
+// Same multiplication with the scratch buffers of context
+double Polynomial_Multiply_Naive_ctx(mpz_t a, mpz_t b, int n, int* total_result,
+                                        Multiply_Context *context);
+
 #endif
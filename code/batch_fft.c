@@ -0,0 +1,316 @@
+#include "batch_fft.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_SIMD_X86
+#endif
+
+// Split work arrays of the lanes, slot 0 for the real and slot 1 for the
+// imaginary parts, and slot 2 for the copy of an in place vector. Like the plan buffers they make the batch transforms
+// unsafe to run from two threads at once
+static Multiply_Context *batch_work = NULL;
+
+// A lane stage does every butterfly of the stage with half segment length
+// half on rows of lanes values, w_re and w_im are the twiddles of the stage
+typedef void (*Lane_Stage_Kernel)(double *re, double *im, const double *w_re,
+                                    const double *w_im, int n, int half, int lanes);
+
+
+// Butterflies of lanes first .. lanes - 1 of two rows, the tail of the
+// vector kernels
+static inline void Lane_Butterflies(double *top_re, double *top_im, double *bottom_re,
+                                    double *bottom_im, double w_re, double w_im,
+                                    int first, int lanes) {
+    double t_re, t_im, u_re, u_im;
+    for (int b = first; b < lanes; b++) {
+        // t = w * v
+        t_re = w_re * bottom_re[b] - w_im * bottom_im[b];
+        t_im = w_re * bottom_im[b] + w_im * bottom_re[b];
+        u_re = top_re[b];
+        u_im = top_im[b];
+        top_re[b] = u_re + t_re;
+        top_im[b] = u_im + t_im;
+        bottom_re[b] = u_re - t_re;
+        bottom_im[b] = u_im - t_im;
+    }
+}
+
+static void Lane_Stage_Scalar(double *re, double *im, const double *w_re,
+                                const double *w_im, int n, int half, int lanes) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            size_t top = (size_t)(k + j) * lanes, bottom = top + (size_t)half * lanes;
+            Lane_Butterflies(re + top, im + top, re + bottom, im + bottom, w_re[j],
+                                w_im[j], 0, lanes);
+        }
+    }
+}
+
+#ifdef BATCH_SIMD_X86
+// Same kernels as Stage_SSE2, Stage_AVX2 and Stage_AVX512 of fft_simd.c, but
+// the vectors run along the lanes and the twiddle is broadcast
+
+__attribute__((target("sse2")))
+static void Lane_Stage_SSE2(double *re, double *im, const double *w_re,
+                            const double *w_im, int n, int half, int lanes) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            size_t top = (size_t)(k + j) * lanes, bottom = top + (size_t)half * lanes;
+            __m128d wr = _mm_set1_pd(w_re[j]), wi = _mm_set1_pd(w_im[j]);
+            int b = 0;
+            for (; b + 2 <= lanes; b += 2) {
+                __m128d vr = _mm_loadu_pd(re + bottom + b), vi = _mm_loadu_pd(im + bottom + b);
+                __m128d ur = _mm_loadu_pd(re + top + b), ui = _mm_loadu_pd(im + top + b);
+                __m128d tr = _mm_sub_pd(_mm_mul_pd(wr, vr), _mm_mul_pd(wi, vi));
+                __m128d ti = _mm_add_pd(_mm_mul_pd(wr, vi), _mm_mul_pd(wi, vr));
+                _mm_storeu_pd(re + top + b, _mm_add_pd(ur, tr));
+                _mm_storeu_pd(im + top + b, _mm_add_pd(ui, ti));
+                _mm_storeu_pd(re + bottom + b, _mm_sub_pd(ur, tr));
+                _mm_storeu_pd(im + bottom + b, _mm_sub_pd(ui, ti));
+            }
+            Lane_Butterflies(re + top, im + top, re + bottom, im + bottom, w_re[j],
+                                w_im[j], b, lanes);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void Lane_Stage_AVX2(double *re, double *im, const double *w_re,
+                            const double *w_im, int n, int half, int lanes) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            size_t top = (size_t)(k + j) * lanes, bottom = top + (size_t)half * lanes;
+            __m256d wr = _mm256_set1_pd(w_re[j]), wi = _mm256_set1_pd(w_im[j]);
+            int b = 0;
+            for (; b + 4 <= lanes; b += 4) {
+                __m256d vr = _mm256_loadu_pd(re + bottom + b), vi = _mm256_loadu_pd(im + bottom + b);
+                __m256d ur = _mm256_loadu_pd(re + top + b), ui = _mm256_loadu_pd(im + top + b);
+                __m256d tr = _mm256_fmsub_pd(wr, vr, _mm256_mul_pd(wi, vi));
+                __m256d ti = _mm256_fmadd_pd(wr, vi, _mm256_mul_pd(wi, vr));
+                _mm256_storeu_pd(re + top + b, _mm256_add_pd(ur, tr));
+                _mm256_storeu_pd(im + top + b, _mm256_add_pd(ui, ti));
+                _mm256_storeu_pd(re + bottom + b, _mm256_sub_pd(ur, tr));
+                _mm256_storeu_pd(im + bottom + b, _mm256_sub_pd(ui, ti));
+            }
+            Lane_Butterflies(re + top, im + top, re + bottom, im + bottom, w_re[j],
+                                w_im[j], b, lanes);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void Lane_Stage_AVX512(double *re, double *im, const double *w_re,
+                                const double *w_im, int n, int half, int lanes) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            size_t top = (size_t)(k + j) * lanes, bottom = top + (size_t)half * lanes;
+            __m512d wr = _mm512_set1_pd(w_re[j]), wi = _mm512_set1_pd(w_im[j]);
+            int b = 0;
+            for (; b + 8 <= lanes; b += 8) {
+                __m512d vr = _mm512_loadu_pd(re + bottom + b), vi = _mm512_loadu_pd(im + bottom + b);
+                __m512d ur = _mm512_loadu_pd(re + top + b), ui = _mm512_loadu_pd(im + top + b);
+                __m512d tr = _mm512_fmsub_pd(wr, vr, _mm512_mul_pd(wi, vi));
+                __m512d ti = _mm512_fmadd_pd(wr, vi, _mm512_mul_pd(wi, vr));
+                _mm512_storeu_pd(re + top + b, _mm512_add_pd(ur, tr));
+                _mm512_storeu_pd(im + top + b, _mm512_add_pd(ui, ti));
+                _mm512_storeu_pd(re + bottom + b, _mm512_sub_pd(ur, tr));
+                _mm512_storeu_pd(im + bottom + b, _mm512_sub_pd(ui, ti));
+            }
+            Lane_Butterflies(re + top, im + top, re + bottom, im + bottom, w_re[j],
+                                w_im[j], b, lanes);
+        }
+    }
+}
+#endif
+
+// The lane kernel matching the kernel fft_simd.c selected, so
+// Set_Split_FFT_Kernel also controls the batches
+static Lane_Stage_Kernel Select_Lane_Kernel() {
+    switch (Get_Split_FFT_Kernel()) {
+#ifdef BATCH_SIMD_X86
+    case SPLIT_KERNEL_SSE2:
+        return Lane_Stage_SSE2;
+    case SPLIT_KERNEL_AVX2:
+        return Lane_Stage_AVX2;
+    case SPLIT_KERNEL_AVX512:
+        return Lane_Stage_AVX512;
+#endif
+    default:
+        return Lane_Stage_Scalar;
+    }
+}
+
+// Transform lanes vectors, element k of lane v at input[k * row_stride +
+// v * lane_stride], and write them back to output with the same strides
+static void Lanes_Transform(complex double *input, complex double *output, int n,
+                            int lanes, size_t row_stride, size_t lane_stride,
+                            bool inverse) {
+    Split_FFT_Plan *split_plan = Get_Split_FFT_Plan(n);
+    unsigned int *bit_reverse = split_plan->plan->bit_reverse;
+    size_t values = (size_t)n * lanes;
+    double *re = (double *)Context_Buffer(batch_work, 0, values * sizeof(double));
+    double *im = (double *)Context_Buffer(batch_work, 1, values * sizeof(double));
+
+    // The inverse swaps the real and imaginary parts on the way in and out,
+    // see Split_IFFT
+    double *in_re = inverse ? im : re, *in_im = inverse ? re : im;
+    for (int k = 0; k < n; k++) {
+        complex double *source = input + bit_reverse[k] * row_stride;
+        double *row_re = in_re + (size_t)k * lanes, *row_im = in_im + (size_t)k * lanes;
+        for (int v = 0; v < lanes; v++) {
+            row_re[v] = creal(source[v * lane_stride]);
+            row_im[v] = cimag(source[v * lane_stride]);
+        }
+    }
+
+    Lane_Stage_Kernel kernel = Select_Lane_Kernel();
+    for (int half = 1; half < n; half <<= 1) {
+        kernel(re, im, split_plan->twiddle_re + half - 1,
+                split_plan->twiddle_im + half - 1, n, half, lanes);
+    }
+
+    double scale = inverse ? 1.0 / n : 1.0;
+    for (int k = 0; k < n; k++) {
+        complex double *target = output + k * row_stride;
+        double *row_re = in_re + (size_t)k * lanes, *row_im = in_im + (size_t)k * lanes;
+        for (int v = 0; v < lanes; v++) {
+            target[v * lane_stride] = (row_re[v] + row_im[v] * I) * scale;
+        }
+    }
+}
+
+static void Batch_Transform(complex double *input, int n, int batch, Batch_Layout layout,
+                            complex double *output, bool inverse) {
+    if (batch_work == NULL) {
+        batch_work = Multiply_Context_Create(0);
+    }
+    if (layout == BATCH_LAYOUT_CONTIGUOUS && n >= BATCH_BLOCK) {
+        // Only the SIMD engine transforms in place, with the others an in
+        // place batch goes through a copy of every vector in slot 2
+        complex double *vector = NULL;
+        if (input == output) {
+            vector = (complex double *)Context_Buffer(batch_work, 2,
+                                                      n * sizeof(complex double));
+        }
+        for (int v = 0; v < batch; v++) {
+            complex double *source = input + (size_t)v * n;
+            if (vector != NULL) {
+                memcpy(vector, source, n * sizeof(complex double));
+                source = vector;
+            }
+            if (inverse) {
+                FFT_Inverse(source, n, output + (size_t)v * n);
+            } else {
+                FFT_Forward(source, n, output + (size_t)v * n);
+            }
+        }
+        return;
+    }
+
+    int block = BATCH_BLOCK / n;
+    if (block < 1) {
+        block = 1;
+    }
+    for (int first = 0; first < batch; first += block) {
+        int lanes = (batch - first < block) ? batch - first : block;
+        if (layout == BATCH_LAYOUT_INTERLEAVED) {
+            Lanes_Transform(input + first, output + first, n, lanes, batch, 1, inverse);
+        } else {
+            Lanes_Transform(input + (size_t)first * n, output + (size_t)first * n, n,
+                            lanes, 1, n, inverse);
+        }
+    }
+}
+
+void Batch_FFT(complex double *input, int n, int batch, Batch_Layout layout,
+                complex double *output) {
+    Batch_Transform(input, n, batch, layout, output, false);
+}
+
+void Batch_IFFT(complex double *input, int n, int batch, Batch_Layout layout,
+                complex double *output) {
+    Batch_Transform(input, n, batch, layout, output, true);
+}
+
+
+double polynomial_multiply_batch(mpz_t *a, mpz_t *b, int count, int n, int *results) {
+    return polynomial_multiply_batch_ctx(a, b, count, n, results,
+                                            Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_batch_ctx(mpz_t *a, mpz_t *b, int count, int n, int *results,
+                                        Multiply_Context *context) {
+    assert(n <= context->max_n);
+    // Multiplications per block, even so the products pair up
+    int block = BATCH_BLOCK / n;
+    block = (block < 2) ? 2 : block & ~1;
+    if (block > count) {
+        block = count + (count & 1);
+    }
+    double elapsed_time = 0.0;
+    // Whether the products of a block rounded exactly, on the heap as the
+    // block can have thousands of lanes
+    bool *exact = (bool *)malloc(block * sizeof(bool));
+
+    for (int first = 0; first < count; first += block) {
+        int lanes = (count - first < block) ? count - first : block;
+        int pairs = (lanes + 1) >> 1;
+        // Fetched per block, an exact fallback of the previous block can
+        // have reused the buffers of the context
+        complex double *packed = (complex double *)Context_Buffer(context, 0,
+                                    (size_t)block * n * sizeof(complex double));
+        complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                    (size_t)block * n * sizeof(complex double));
+
+        // Lane v holds a in the real and b in the imaginary parts, rows of
+        // lanes values
+        memset(packed, 0, (size_t)lanes * n * sizeof(complex double));
+        for (int v = 0; v < lanes; v++) {
+            mpz_to_double_array(a[first + v], (double *)(packed + v), 2 * lanes);
+            mpz_to_double_array(b[first + v], (double *)(packed + v) + 1, 2 * lanes);
+        }
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        Batch_FFT(packed, n, lanes, BATCH_LAYOUT_INTERLEAVED, spectrum);
+
+        // The product spectrum of every lane as in Packed_Real_Product. The
+        // products are real, so lanes 2u and 2u + 1 go into the real and
+        // imaginary part of one lane of the inverse
+        for (int k = 0; k < n; k++) {
+            complex double *row = spectrum + (size_t)k * lanes;
+            complex double *mirror = spectrum + (size_t)((k == 0) ? 0 : n - k) * lanes;
+            complex double *target = packed + (size_t)k * pairs;
+            for (int u = 0; u < pairs; u++) {
+                complex double z_k = row[2 * u], z_mirror = conj(mirror[2 * u]);
+                complex double product = (z_k * z_k - z_mirror * z_mirror) * -0.25 * I;
+                if (2 * u + 1 < lanes) {
+                    z_k = row[2 * u + 1];
+                    z_mirror = conj(mirror[2 * u + 1]);
+                    product += (z_k * z_k - z_mirror * z_mirror) * 0.25;
+                }
+                target[u] = product;
+            }
+        }
+        Batch_IFFT(packed, n, pairs, BATCH_LAYOUT_INTERLEAVED, spectrum);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_time += end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        // Lane v is the real or imaginary part of lane v / 2 of the rows of
+        // pairs values. All lanes are rounded before any is redone, as the
+        // fallback uses the buffers of the context
+        for (int v = 0; v < lanes; v++) {
+            double *values = (double *)(spectrum + (v >> 1)) + (v & 1);
+            exact[v] = Round_FFT_Result_Strided(values, n, 2 * pairs,
+                                                results + (size_t)(first + v) * n);
+        }
+        for (int v = 0; v < lanes; v++) {
+            if (!exact[v]) {
+                elapsed_time += Exact_Fallback_Multiply(a[first + v], b[first + v], n,
+                                                        results + (size_t)(first + v) * n,
+                                                        context);
+            }
+        }
+    }
+    free(exact);
+    return elapsed_time;
+}
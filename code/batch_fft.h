@@ -0,0 +1,55 @@
+#ifndef BATCH_FFT_H
+#define BATCH_FFT_H
+#include "Helper_Functions.h"
+#include "fft_simd.h"
+#include "multiply_context.h"
+#include "fft_rounding.h"
+
+// Batched FFT
+// Many transforms of the same small size cost more in call overhead than in
+// butterflies: every call looks up its plan and converts its own array, and
+// a vector of 16 values has no stage wide enough for the SIMD kernels of
+// fft_simd.c. A batch of B vectors is instead transformed as one array of
+// n rows of B lanes, element k of every vector in row k. Every butterfly of
+// the radix-2 FFT then works on two whole rows with one twiddle, so the
+// vector kernels run along the lanes whatever n is, and the bit reversal
+// moves whole rows.
+//
+// The rows are kept in a split (re, im) work array like Split_FFT. The
+// batch can come in two layouts, which only change where the gather and
+// scatter passes read and write:
+//     BATCH_LAYOUT_INTERLEAVED    element k of vector v at data[k * batch + v]
+//     BATCH_LAYOUT_CONTIGUOUS     element k of vector v at data[v * n + k]
+// Large batches are transformed a block of lanes at a time so the work array
+// stays in the cache, and contiguous vectors of BATCH_BLOCK values or more
+// gain nothing from lanes and are transformed one by one with FFT_Forward.
+
+// Complex values (rows * lanes) transformed at a time, 512 KB
+#define BATCH_BLOCK (1 << 15)
+
+typedef enum {
+    BATCH_LAYOUT_INTERLEAVED,
+    BATCH_LAYOUT_CONTIGUOUS
+} Batch_Layout;
+
+// Forward FFT of batch vectors of length n, n a power of 2. input and output
+// use the same layout and may be the same array
+void Batch_FFT(complex double *input, int n, int batch, Batch_Layout layout,
+                complex double *output);
+
+// Inverse transforms, normalized by 1/n
+void Batch_IFFT(complex double *input, int n, int batch, Batch_Layout layout,
+                complex double *output);
+
+// count multiplications a[i] * b[i] of size n at once, the digits of
+// product i go to results[i * n .. i * n + n - 1]. Both operands of a
+// multiplication share one lane as in polynomial_multiply_iterative_FFT, and
+// the real products of two lanes share one lane of the inverse transform.
+// Returns the elapsed time of the transforms
+double polynomial_multiply_batch(mpz_t *a, mpz_t *b, int count, int n, int *results);
+
+// Same multiplications with the scratch buffers of context
+double polynomial_multiply_batch_ctx(mpz_t *a, mpz_t *b, int count, int n, int *results,
+                                        Multiply_Context *context);
+
+#endif
@@ -0,0 +1,171 @@
+#include "block_convolver.h"
+
+
+int Optimal_Convolution_Length(int kernel_length) {
+    int best = 2;
+    while (best < 2 * kernel_length) {
+        best <<= 1;
+    }
+    double best_cost = INFINITY;
+    for (int length = best; length <= BLOCK_CONVOLVER_MAX_FFT; length <<= 1) {
+        double cost = length * (log2(length) + 1) / (length - kernel_length + 1);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = length;
+        }
+    }
+    return best;
+}
+
+Block_Convolver *Block_Convolver_Create(const double *kernel, int kernel_length,
+                                        int fft_length, Convolve_Mode mode) {
+    assert(kernel_length >= 1);
+    int minimum = 2;
+    while (minimum < 2 * kernel_length) {
+        minimum <<= 1;
+    }
+    if (fft_length == 0) {
+        fft_length = Optimal_Convolution_Length(kernel_length);
+    }
+    int length = minimum;
+    while (length < fft_length) {
+        length <<= 1;
+    }
+
+    Block_Convolver *convolver = (Block_Convolver *)calloc(1, sizeof(Block_Convolver));
+    convolver->mode = mode;
+    convolver->kernel_length = kernel_length;
+    convolver->fft_length = length;
+    convolver->block_length = length - kernel_length + 1;
+    convolver->offset = (mode == CONVOLVE_OVERLAP_SAVE) ? kernel_length - 1 : 0;
+    convolver->kernel_spectrum = (complex double *)malloc((length / 2 + 1) * sizeof(complex double));
+    convolver->block = (double *)calloc(length, sizeof(double));
+    convolver->tail = (double *)calloc(kernel_length, sizeof(double));
+    convolver->output = (double *)malloc(convolver->block_length * sizeof(double));
+    convolver->spectrum = (complex double *)malloc((length / 2 + 1) * sizeof(complex double));
+    convolver->work = (complex double *)malloc((length / 2) * sizeof(complex double));
+    convolver->result = (double *)malloc(length * sizeof(double));
+
+    // The kernel is zero padded to N and transformed once
+    memcpy(convolver->block, kernel, kernel_length * sizeof(double));
+    Real_FFT(FFT_Forward, convolver->block, length, convolver->kernel_spectrum,
+                convolver->work);
+    memset(convolver->block, 0, length * sizeof(double));
+    return convolver;
+}
+
+void Block_Convolver_Free(Block_Convolver *convolver) {
+    if (convolver == NULL) {
+        return;
+    }
+    free(convolver->kernel_spectrum);
+    free(convolver->block);
+    free(convolver->tail);
+    free(convolver->output);
+    free(convolver->spectrum);
+    free(convolver->work);
+    free(convolver->result);
+    free(convolver);
+}
+
+// Convolve the full block with the kernel and move its L outputs into the
+// empty output block
+static void Process_Block(Block_Convolver *convolver) {
+    int length = convolver->fft_length, block_length = convolver->block_length;
+    int overlap = convolver->kernel_length - 1;
+    double *block = convolver->block, *result = convolver->result;
+
+    Real_FFT(FFT_Forward, block, length, convolver->spectrum, convolver->work);
+    for (int k = 0; k <= length / 2; k++) {
+        convolver->spectrum[k] *= convolver->kernel_spectrum[k];
+    }
+    Real_IFFT(FFT_Inverse, convolver->spectrum, length, result, convolver->work);
+
+    if (convolver->mode == CONVOLVE_OVERLAP_ADD) {
+        // The block was zero padded, so the convolution has no wrap around.
+        // Outputs 0 .. L - 1 get the spill of the previous block added and
+        // outputs L .. L + M - 2 are the spill of this one
+        memcpy(convolver->output, result, block_length * sizeof(double));
+        for (int i = 0; i < overlap; i++) {
+            convolver->output[i] += convolver->tail[i];
+            convolver->tail[i] = result[block_length + i];
+        }
+        memset(block, 0, block_length * sizeof(double));
+    } else {
+        // Outputs 0 .. M - 2 wrapped around and are dropped, the last M - 1
+        // inputs become the prefix of the next block
+        memcpy(convolver->output, result + overlap, block_length * sizeof(double));
+        memmove(block, block + block_length, overlap * sizeof(double));
+    }
+    convolver->filled = 0;
+
+    // Past the end of the stream only the rest of the convolution is output
+    long long total = convolver->inputs + overlap;
+    long long count = block_length;
+    if (convolver->finished && convolver->outputs + count > total) {
+        count = total - convolver->outputs;
+    }
+    convolver->output_start = 0;
+    convolver->output_count = (int)count;
+    convolver->outputs += count;
+}
+
+int Block_Convolver_Push(Block_Convolver *convolver, const double *input, int count) {
+    assert(!convolver->finished);
+    int used = 0;
+    while (used < count) {
+        int space = convolver->block_length - convolver->filled;
+        if (space == 0) {
+            // The block is full, it can only be processed into an empty
+            // output block
+            if (convolver->output_count > 0) {
+                break;
+            }
+            Process_Block(convolver);
+            continue;
+        }
+        int take = (count - used < space) ? count - used : space;
+        memcpy(convolver->block + convolver->offset + convolver->filled, input + used,
+                take * sizeof(double));
+        convolver->filled += take;
+        convolver->inputs += take;
+        used += take;
+    }
+    return used;
+}
+
+int Block_Convolver_Pull(Block_Convolver *convolver, double *output, int capacity) {
+    int copied = 0;
+    while (copied < capacity) {
+        if (convolver->output_count == 0) {
+            bool full = convolver->filled == convolver->block_length;
+            // After the end the rest of the input and the M - 1 outputs of
+            // the tail come out of zero padded blocks
+            bool remaining = convolver->finished &&
+                    convolver->outputs < convolver->inputs + convolver->kernel_length - 1;
+            if (!full && !remaining) {
+                break;
+            }
+            if (!full) {
+                int offset = convolver->offset + convolver->filled;
+                memset(convolver->block + offset, 0,
+                        (convolver->block_length - convolver->filled) * sizeof(double));
+                convolver->filled = convolver->block_length;
+            }
+            Process_Block(convolver);
+            continue;
+        }
+        int take = (capacity - copied < convolver->output_count) ?
+                    capacity - copied : convolver->output_count;
+        memcpy(output + copied, convolver->output + convolver->output_start,
+                take * sizeof(double));
+        convolver->output_start += take;
+        convolver->output_count -= take;
+        copied += take;
+    }
+    return copied;
+}
+
+void Block_Convolver_Finish(Block_Convolver *convolver) {
+    convolver->finished = true;
+}
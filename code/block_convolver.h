@@ -0,0 +1,88 @@
+#ifndef BLOCK_CONVOLVER_H
+#define BLOCK_CONVOLVER_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "real_fft.h"
+
+// Streaming convolution with a fixed kernel
+// The multiplications need both operands in memory. To convolve a stream of
+// any length with a kernel of M coefficients the stream is cut into blocks
+// of L samples, and every block is convolved with the kernel through real
+// FFTs of length N >= L + M - 1 on FFT_Forward and FFT_Inverse. The kernel
+// is transformed once when the convolver is created. Two ways to glue the
+// blocks together:
+//     Overlap-add:  a block is zero padded to N, its last M - 1 outputs
+//                   spill into the next block and are added there
+//     Overlap-save: a block is prefixed with the last M - 1 inputs of the
+//                   stream, the first M - 1 outputs of the circular
+//                   convolution are wrong (wrapped) and thrown away
+// Both give L outputs per block. The output is the full linear convolution,
+// input length + M - 1 samples, the last M - 1 once the stream is finished.
+//
+// Memory is fixed when the convolver is created: one block of input and one
+// block of output are buffered. Push takes input until a full block is
+// waiting behind an output block that has not been pulled, so the caller
+// alternates Push and Pull:
+//     while (more input) {
+//         used = Block_Convolver_Push(convolver, input, count);
+//         input += used; count -= used;
+//         pulled = Block_Convolver_Pull(convolver, output, capacity);
+//     }
+//     Block_Convolver_Finish(convolver);
+//     while ((pulled = Block_Convolver_Pull(convolver, output, capacity)) > 0) ...
+
+// Largest FFT length Optimal_Convolution_Length picks, 2^20 doubles are 8 MB
+#define BLOCK_CONVOLVER_MAX_FFT (1 << 20)
+
+typedef enum {
+    CONVOLVE_OVERLAP_ADD,
+    CONVOLVE_OVERLAP_SAVE
+} Convolve_Mode;
+
+typedef struct {
+    Convolve_Mode mode;
+    int kernel_length;              // M
+    int fft_length;                 // N, a power of 2
+    int block_length;               // L = N - M + 1 inputs and outputs per block
+    complex double *kernel_spectrum;// Bins 0..N/2 of the kernel
+    double *block;                  // FFT input, the block is filled from offset
+    int offset;                     // 0 for overlap-add, M - 1 for overlap-save
+    int filled;                     // Inputs in the current block
+    double *tail;                   // Overlap-add: the M - 1 outputs spilling over
+    double *output;                 // Output block waiting to be pulled
+    int output_start;
+    int output_count;
+    long long inputs;               // Samples pushed so far
+    long long outputs;              // Samples moved to the output block so far
+    bool finished;
+    // FFT buffers
+    complex double *spectrum;       // N/2 + 1 bins
+    complex double *work;           // N/2 values
+    double *result;                 // N values
+} Block_Convolver;
+
+// FFT length that minimizes the cost per output sample for a kernel of
+// kernel_length coefficients. A block costs about N * (log2(N) + 1) for the
+// two transforms and the products and gives N - M + 1 outputs, so short
+// transforms waste most of their outputs on the overlap and long ones pay
+// log2(N) per sample
+int Optimal_Convolution_Length(int kernel_length);
+
+// fft_length is rounded up to a power of 2 of at least 2 * kernel_length,
+// 0 picks Optimal_Convolution_Length. The kernel is copied
+Block_Convolver *Block_Convolver_Create(const double *kernel, int kernel_length,
+                                        int fft_length, Convolve_Mode mode);
+
+void Block_Convolver_Free(Block_Convolver *convolver);
+
+// Take up to count samples, returns how many were taken. Fewer than count
+// means the output has to be pulled before more input fits
+int Block_Convolver_Push(Block_Convolver *convolver, const double *input, int count);
+
+// Copy up to capacity output samples, in order, returns how many were copied
+int Block_Convolver_Pull(Block_Convolver *convolver, double *output, int capacity);
+
+// End of the stream, Pull then returns the rest of the convolution
+void Block_Convolver_Finish(Block_Convolver *convolver);
+
+#endif
@@ -0,0 +1,176 @@
+#include "bluestein_fft.h"
+
+// Plans created by Get_Bluestein_Plan, a list searched by n as the lengths
+// can be anything
+static Chirp_Z_Plan *bluestein_plan_cache = NULL;
+static pthread_mutex_t bluestein_plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Fractional part of a number of cycles. The phases grow with t^2, so they
+// are reduced in long double before the rounding to double would lose the
+// fraction
+static double Fraction(long double cycles) {
+    return (double)(cycles - floorl(cycles));
+}
+
+// c(t) = e^{-i*pi*step*t^2}. For the DFT of length dft_length the step is
+// 1/dft_length and t^2 is reduced modulo 2 * dft_length in integers, so the
+// chirp is exact however large t^2 gets
+static complex double Chirp(long long t, double step, int dft_length) {
+    if (dft_length > 0) {
+        unsigned long long period = 2ULL * dft_length;
+        unsigned long long residue = (unsigned long long)(t < 0 ? -t : t) % period;
+        return cexp(-I * TAU * (double)(residue * residue % period) / (double)period);
+    }
+    return cexp(-I * TAU * Fraction((long double)step * t * t / 2));
+}
+
+static Chirp_Z_Plan *Chirp_Z_Plan_Build(int n, int m, double start, double step,
+                                        int dft_length) {
+    Chirp_Z_Plan *plan = (Chirp_Z_Plan *)malloc(sizeof(Chirp_Z_Plan));
+    plan->n = n;
+    plan->m = m;
+    plan->next = NULL;
+    // No wrap around of the convolution for outputs 0 .. m - 1
+    plan->length = 1;
+    while (plan->length < n + m - 1) {
+        plan->length <<= 1;
+    }
+    int length = plan->length;
+    plan->input_chirp = (complex double *)malloc(n * sizeof(complex double));
+    plan->output_chirp = (complex double *)malloc(m * sizeof(complex double));
+    plan->kernel = (complex double *)malloc(length * sizeof(complex double));
+    plan->work = (complex double *)malloc(length * sizeof(complex double));
+    plan->spectrum = (complex double *)malloc(length * sizeof(complex double));
+
+    for (int j = 0; j < n; j++) {
+        plan->input_chirp[j] = cexp(-I * TAU * Fraction((long double)start * j)) *
+                                Chirp(j, step, dft_length);
+    }
+    for (int k = 0; k < m; k++) {
+        plan->output_chirp[k] = Chirp(k, step, dft_length);
+    }
+
+    // conj(c(t)) for t = 0 .. m - 1 at the start and for t = -(n - 1) .. -1
+    // wrapped around to the end, c is even so c(-t) = c(t)
+    memset(plan->work, 0, length * sizeof(complex double));
+    for (int t = 0; t < m; t++) {
+        plan->work[t] = conj(plan->output_chirp[t]);
+    }
+    for (int t = 1; t < n; t++) {
+        plan->work[length - t] = conj(Chirp(t, step, dft_length));
+    }
+    FFT_Forward(plan->work, length, plan->kernel);
+    return plan;
+}
+
+Chirp_Z_Plan *Chirp_Z_Plan_Create(int n, int m, double start, double step) {
+    return Chirp_Z_Plan_Build(n, m, start, step, 0);
+}
+
+void Chirp_Z_Plan_Free(Chirp_Z_Plan *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->input_chirp);
+    free(plan->output_chirp);
+    free(plan->kernel);
+    free(plan->work);
+    free(plan->spectrum);
+    free(plan);
+}
+
+// The inverse DFT is conj(DFT(conj(x))) / n, so inverse conjugates on the
+// way in and out and the caller normalizes
+static void Chirp_Z_Execute(Chirp_Z_Plan *plan, complex double *input,
+                            complex double *output, bool inverse) {
+    int n = plan->n, length = plan->length;
+    complex double *work = plan->work, *spectrum = plan->spectrum;
+
+    for (int j = 0; j < n; j++) {
+        work[j] = (inverse ? conj(input[j]) : input[j]) * plan->input_chirp[j];
+    }
+    memset(work + n, 0, (length - n) * sizeof(complex double));
+
+    // Convolution with conj(c)
+    FFT_Forward(work, length, spectrum);
+    for (int i = 0; i < length; i++) {
+        spectrum[i] *= plan->kernel[i];
+    }
+    FFT_Inverse(spectrum, length, work);
+
+    for (int k = 0; k < plan->m; k++) {
+        complex double value = work[k] * plan->output_chirp[k];
+        output[k] = inverse ? conj(value) : value;
+    }
+}
+
+void Chirp_Z_Transform(Chirp_Z_Plan *plan, complex double *input, complex double *output) {
+    Chirp_Z_Execute(plan, input, output, false);
+}
+
+void Zoom_FFT(complex double *input, int n, complex double *output, int m,
+                double start_frequency, double end_frequency) {
+    Chirp_Z_Plan *plan = Chirp_Z_Plan_Create(n, m, start_frequency,
+                                                (end_frequency - start_frequency) / m);
+    Chirp_Z_Transform(plan, input, output);
+    Chirp_Z_Plan_Free(plan);
+}
+
+Chirp_Z_Plan *Get_Bluestein_Plan(int n) {
+    pthread_mutex_lock(&bluestein_plan_cache_lock);
+    Chirp_Z_Plan *plan = bluestein_plan_cache;
+    while (plan != NULL && plan->n != n) {
+        plan = plan->next;
+    }
+    if (plan == NULL) {
+        plan = Chirp_Z_Plan_Build(n, n, 0.0, 1.0 / n, n);
+        plan->next = bluestein_plan_cache;
+        bluestein_plan_cache = plan;
+    }
+    pthread_mutex_unlock(&bluestein_plan_cache_lock);
+    return plan;
+}
+
+void Free_Bluestein_Plan_Cache() {
+    pthread_mutex_lock(&bluestein_plan_cache_lock);
+    while (bluestein_plan_cache != NULL) {
+        Chirp_Z_Plan *next = bluestein_plan_cache->next;
+        Chirp_Z_Plan_Free(bluestein_plan_cache);
+        bluestein_plan_cache = next;
+    }
+    pthread_mutex_unlock(&bluestein_plan_cache_lock);
+}
+
+void Bluestein_FFT(complex double *input, int n, complex double *output) {
+    Chirp_Z_Execute(Get_Bluestein_Plan(n), input, output, false);
+}
+
+void Bluestein_IFFT(complex double *input, int n, complex double *output) {
+    Chirp_Z_Execute(Get_Bluestein_Plan(n), input, output, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < n; i++) {
+        output[i] /= n;
+    }
+}
+
+void Any_Length_FFT(complex double *input, int n, complex double *output) {
+    if ((n & (n - 1)) == 0) {
+        FFT_Forward(input, n, output);
+    } else if (Is_Smooth_Size(n)) {
+        Mixed_Radix_FFT(input, n, output);
+    } else {
+        Bluestein_FFT(input, n, output);
+    }
+}
+
+void Any_Length_IFFT(complex double *input, int n, complex double *output) {
+    if ((n & (n - 1)) == 0) {
+        FFT_Inverse(input, n, output);
+    } else if (Is_Smooth_Size(n)) {
+        Mixed_Radix_IFFT(input, n, output);
+    } else {
+        Bluestein_IFFT(input, n, output);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef BLUESTEIN_FFT_H
+#define BLUESTEIN_FFT_H
+#include <pthread.h>
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "mixed_radix_fft.h"
+
+// Bluestein's chirp-z transform
+// The DFT of any length, primes included, in O(n log n) on the power-of-two
+// FFT. The product in the exponent of the DFT can be written as
+//     j*k = (j^2 + k^2 - (k - j)^2) / 2
+// so with the chirp c(t) = e^{-i*pi*t^2/n}
+//     X[k] = c(k) * sum_j (x[j] * c(j)) * conj(c(k - j))
+// which is a convolution of x[j] * c(j) with conj(c), followed by a
+// multiplication with c(k). The convolution runs on FFT_Forward and
+// FFT_Inverse at the first power of two of at least 2n - 1, and the
+// transform of the conj(c) kernel is computed once per plan.
+//
+// Nothing in this requires the outputs to be the n roots of unity. For the
+// m points z_k = e^{i*TAU*(start + k*step)} on an arc of the unit circle
+// (frequencies in cycles per sample) the same identity with
+// c(t) = e^{-i*pi*step*t^2} gives
+//     X[k] = sum_j x[j] * e^{-i*TAU*j*(start + k*step)}
+// which is the zoom FFT: a fine grid of frequencies over a narrow band
+// without computing or padding the whole spectrum.
+
+typedef struct Chirp_Z_Plan {
+    int n;                          // Input length
+    int m;                          // Output length
+    int length;                     // Convolution length, power of two >= n + m - 1
+    complex double *input_chirp;    // e^{-i*TAU*j*start} * c(j) for j < n
+    complex double *output_chirp;   // c(k) for k < m
+    complex double *kernel;         // FFT of conj(c(t)) for t = -(n - 1) .. m - 1
+    // Buffers of the convolution, so one plan must not be executed by two
+    // threads at the same time
+    complex double *work;
+    complex double *spectrum;
+    struct Chirp_Z_Plan *next;      // Next plan in the Bluestein cache
+} Chirp_Z_Plan;
+
+// Plan for the m frequencies start + k * step, k < m, of inputs of length n
+Chirp_Z_Plan *Chirp_Z_Plan_Create(int n, int m, double start, double step);
+
+void Chirp_Z_Plan_Free(Chirp_Z_Plan *plan);
+
+// output[k] = sum_j input[j] * e^{-i*TAU*j*(start + k*step)}, input holds n
+// values and output m
+void Chirp_Z_Transform(Chirp_Z_Plan *plan, complex double *input, complex double *output);
+
+// m frequencies from start_frequency up to, but not including,
+// end_frequency, in cycles per sample. The plan is made and freed per call,
+// keep a Chirp_Z_Plan to zoom into the same band repeatedly
+void Zoom_FFT(complex double *input, int n, complex double *output, int m,
+                double start_frequency, double end_frequency);
+
+// Cached DFT plan for length n, created on first use. Its chirp is computed
+// from t^2 mod 2n, which is exact for every t
+Chirp_Z_Plan *Get_Bluestein_Plan(int n);
+
+void Free_Bluestein_Plan_Cache();
+
+// Same signature as Iterative_FFT, for any n >= 1
+void Bluestein_FFT(complex double *input, int n, complex double *output);
+
+// Inverse transform, normalized by 1/n
+void Bluestein_IFFT(complex double *input, int n, complex double *output);
+
+// The DFT of length n with the fastest transform that takes it: FFT_Forward
+// for powers of two, the mixed-radix FFT for 7-smooth lengths and Bluestein
+// for the rest
+void Any_Length_FFT(complex double *input, int n, complex double *output);
+
+void Any_Length_IFFT(complex double *input, int n, complex double *output);
+
+#endif
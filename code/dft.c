@@ -45,20 +45,31 @@ void IDFT(complex double *in, int n, complex double *out) {
 
 
 double polynomial_multiply_DFT(mpz_t a, mpz_t b, int n, int* dft_total_result) {
+    return polynomial_multiply_DFT_ctx(a, b, n, dft_total_result,
+                                        Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_DFT_ctx(mpz_t a, mpz_t b, int n, int* dft_total_result,
+                                    Multiply_Context *context) {
+    assert(n <= context->max_n);
+    size_t buffer_bytes = context->max_n * sizeof(complex double);
     
     // Pad the inputs with zeros, the polynomials are represented as arays
     // Padding ensures the data is clean
     // Arrays help structure the data into parts
-    complex double padded_a[n], padded_b[n], dft_result[n];
+    complex double *padded_a = (complex double *)Context_Buffer(context, 0, buffer_bytes);
+    complex double *padded_b = (complex double *)Context_Buffer(context, 1, buffer_bytes);
     memset(padded_a, 0, n * sizeof(complex double));
     memset(padded_b, 0, n * sizeof(complex double));
-    memset(dft_result, 0, n * sizeof(complex double));
 
     mpz_to_complex_array(a, padded_a);
     mpz_to_complex_array(b, padded_b);
 
     // // Apply DFT to both polynomials
-    complex double fa[n], fb[n];
+    complex double *fa = (complex double *)Context_Buffer(context, 2, buffer_bytes);
+    complex double *fb = (complex double *)Context_Buffer(context, 3, buffer_bytes);
+    // The IDFT writes every element, and padded_a is no longer needed
+    complex double *dft_result = padded_a;
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
     DFT(padded_a, n, fa);
@@ -2,6 +2,7 @@
 #ifndef DFT_H
 #define DFT_H
 #include "Helper_Functions.h"
+#include "multiply_context.h"
 
 // Declare the function(s) from dft.c here
 void DFT(complex double *in, int n, complex double *out);
@@ -10,4 +11,8 @@ void IDFT(complex double *in, int n, complex double *out);
 
 double polynomial_multiply_DFT(mpz_t a, mpz_t b, int n, int* result);
 
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_DFT_ctx(mpz_t a, mpz_t b, int n, int* result,
+                                    Multiply_Context *context);
+
 #endif
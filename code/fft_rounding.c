@@ -0,0 +1,109 @@
+#include "fft_rounding.h"
+#include "ntt.h"
+#include "karatsuba.h"
+
+static double rounding_margin = FFT_ROUNDING_MARGIN;
+static FFT_Rounding_Stats rounding_stats = {0, 0, 0.0, 0.0};
+static pthread_mutex_t rounding_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void Set_FFT_Rounding_Margin(double margin) {
+    rounding_margin = margin;
+}
+
+double Get_FFT_Rounding_Margin() {
+    return rounding_margin;
+}
+
+FFT_Rounding_Stats Get_FFT_Rounding_Stats() {
+    pthread_mutex_lock(&rounding_stats_lock);
+    FFT_Rounding_Stats stats = rounding_stats;
+    pthread_mutex_unlock(&rounding_stats_lock);
+    return stats;
+}
+
+void Reset_FFT_Rounding_Stats() {
+    pthread_mutex_lock(&rounding_stats_lock);
+    memset(&rounding_stats, 0, sizeof(rounding_stats));
+    pthread_mutex_unlock(&rounding_stats_lock);
+}
+
+// Record the largest distance of one product, returns whether it is within
+// the margin
+static bool Record_FFT_Rounding(double max_error) {
+    pthread_mutex_lock(&rounding_stats_lock);
+    rounding_stats.multiplications++;
+    rounding_stats.last_error = max_error;
+    if (max_error > rounding_stats.max_error) {
+        rounding_stats.max_error = max_error;
+    }
+    pthread_mutex_unlock(&rounding_stats_lock);
+    return max_error <= rounding_margin;
+}
+
+bool Round_FFT_Result_Strided(const double *fft_result, int n, int stride, int *result) {
+    double max_error = 0;
+    for (int i = 0; i < n; i++) {
+        double rounded = round(fft_result[(size_t)i * stride]);
+        double error = fabs(fft_result[(size_t)i * stride] - rounded);
+        if (error > max_error) {
+            max_error = error;
+        }
+        result[i] = (int)rounded;
+    }
+    return Record_FFT_Rounding(max_error);
+}
+
+bool Round_FFT_Result(const double *fft_result, int n, int *result) {
+    return Round_FFT_Result_Strided(fft_result, n, 1, result);
+}
+
+bool Check_FFT_Rounding(const double *fft_result, int n) {
+    double max_error = 0;
+    for (int i = 0; i < n; i++) {
+        double error = fabs(fft_result[i] - round(fft_result[i]));
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+    return Record_FFT_Rounding(max_error);
+}
+
+void Count_FFT_Fallback() {
+    pthread_mutex_lock(&rounding_stats_lock);
+    rounding_stats.fallbacks++;
+    pthread_mutex_unlock(&rounding_stats_lock);
+}
+
+Exact_Engine Exact_Fallback_Engine(int n, size_t length_a, size_t length_b) {
+    // The bound polynomial_multiply_NTT_ctx chooses its primes from. Long
+    // operands need a second prime, whose transforms are shorter than the
+    // ones of the first
+    uint64_t bound = 81 * (uint64_t)(length_a < length_b ? length_a : length_b);
+    int max_log2n = Get_NTT_Prime(NTT_Primes_Needed(bound) - 1)->max_log2n;
+    return ((n >> max_log2n) <= 1) ? EXACT_ENGINE_NTT : EXACT_ENGINE_KARATSUBA;
+}
+
+double Exact_Fallback_Multiply(mpz_t a, mpz_t b, int n, int *result,
+                                Multiply_Context *context) {
+    Count_FFT_Fallback();
+
+    // The digit counts can be one too many, which only errs towards Karatsuba
+    if (Exact_Fallback_Engine(n, mpz_sizeinbase(a, 10), mpz_sizeinbase(b, 10)) ==
+            EXACT_ENGINE_NTT) {
+        return polynomial_multiply_NTT_ctx(a, b, n, result, context);
+    }
+    memset(result, 0, n * sizeof(int));
+    return polynomial_multiply_karatsuba_ctx(a, b, n, result, context);
+}
+
+double Exact_Fallback_Square(mpz_t a, int n, int *result, Multiply_Context *context) {
+    Count_FFT_Fallback();
+
+    size_t length = mpz_sizeinbase(a, 10);
+    if (Exact_Fallback_Engine(n, length, length) == EXACT_ENGINE_NTT) {
+        return polynomial_square_NTT_ctx(a, n, result, context);
+    }
+    memset(result, 0, n * sizeof(int));
+    return polynomial_square_karatsuba_ctx(a, n, result, context);
+}
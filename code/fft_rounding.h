@@ -0,0 +1,79 @@
+#ifndef FFT_ROUNDING_H
+#define FFT_ROUNDING_H
+#include <pthread.h>
+#include "Helper_Functions.h"
+#include "multiply_context.h"
+
+// Rounding checks of the FFT multiplications
+// The FFT product comes out as doubles that are rounded to the integer
+// coefficients. While the rounding error stays below 0.5 the rounding
+// gives the exact product, past it the result is silently wrong. The
+// distance of every value to its nearest integer is the error of a correct
+// product, so its maximum over a product shows how close that product came
+// to failing. Every FFT product rounds through Round_FFT_Result (or checks
+// its values with Check_FFT_Rounding when they do not fit an int), which
+// records the distance, and when it is above the margin the product is
+// redone with an exact engine:
+//     the digit products (iterative, recursive, mixed radix, batch and
+//     squaring) with Exact_Fallback_Multiply or Exact_Fallback_Square, the
+//     NTT for every size its primes support and Karatsuba beyond that
+//     prepared operands with the product against the kept operand
+//     the integer products of integer_multiply.h with GMP, as their
+//     coefficients are too large for the NTT of decimal digits
+//
+// The statistics are shared by all threads and protected by a lock.
+
+// Default margin, a product within a factor 4 of failing is redone
+#define FFT_ROUNDING_MARGIN 0.125
+
+typedef struct {
+    long long multiplications;  // Products rounded since the last reset
+    long long fallbacks;        // Products redone with an exact engine
+    double max_error;           // Largest distance to an integer since the reset
+    double last_error;          // Largest distance in the last product
+} FFT_Rounding_Stats;
+
+// Largest distance to an integer that is accepted, 0.5 or more never falls
+// back
+void Set_FFT_Rounding_Margin(double margin);
+
+double Get_FFT_Rounding_Margin();
+
+FFT_Rounding_Stats Get_FFT_Rounding_Stats();
+
+void Reset_FFT_Rounding_Stats();
+
+// Round the n values of fft_result into result and record the largest
+// distance to the nearest integer. Returns false if it is above the margin
+bool Round_FFT_Result(const double *fft_result, int n, int *result);
+
+// Same for values stride doubles apart, as in the lanes of a batch
+bool Round_FFT_Result_Strided(const double *fft_result, int n, int stride, int *result);
+
+// Record the largest distance of values that are rounded by the caller.
+// Returns false if it is above the margin
+bool Check_FFT_Rounding(const double *fft_result, int n);
+
+// Count a product the caller redoes with its own exact engine
+void Count_FFT_Fallback();
+
+typedef enum {
+    EXACT_ENGINE_NTT,
+    EXACT_ENGINE_KARATSUBA
+} Exact_Engine;
+
+// The exact engine for a product of length n of operands with length_a and
+// length_b digits: the NTT if the primes the digits need have transforms of
+// length n, else Karatsuba
+Exact_Engine Exact_Fallback_Engine(int n, size_t length_a, size_t length_b);
+
+// The digits of a * b computed exactly, with the NTT or with Karatsuba when
+// n is too long for the NTT. Counts a fallback and returns the elapsed time
+// of the multiplication
+double Exact_Fallback_Multiply(mpz_t a, mpz_t b, int n, int *result,
+                                Multiply_Context *context);
+
+// The digits of a * a computed exactly, as Exact_Fallback_Multiply
+double Exact_Fallback_Square(mpz_t a, int n, int *result, Multiply_Context *context);
+
+#endif
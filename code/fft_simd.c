@@ -0,0 +1,339 @@
+#include "fft_simd.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FFT_SIMD_X86
+#endif
+
+// Plans created by Get_Split_FFT_Plan, indexed by log2(n)
+static Split_FFT_Plan *split_plan_cache[32];
+
+// Guards split_plan_cache, so threads can ask for plans at the same time
+static pthread_mutex_t split_plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Split arrays of the interleaved wrappers, slot 0 for the real and slot 1
+// for the imaginary parts. One context per thread, freed when the thread
+// exits, as the plans are shared between the threads
+static pthread_key_t split_work_key;
+static pthread_once_t split_work_once = PTHREAD_ONCE_INIT;
+
+// A stage kernel does every butterfly of the stage with half segment length
+// half, w_re and w_im point at the twiddles of that stage
+typedef void (*Stage_Kernel)(double *re, double *im, double *w_re,
+                                double *w_im, int n, int half);
+
+static Stage_Kernel stage_kernel = NULL;
+static int stage_kernel_width = 1; // Doubles per vector of the kernel
+static Split_FFT_Kernel selected_kernel = SPLIT_KERNEL_SCALAR;
+
+
+// Allocate n doubles aligned to the 64 byte cache line / AVX-512 vector
+static double *Aligned_Doubles(int n) {
+    void *memory = NULL;
+    if (posix_memalign(&memory, 64, n * sizeof(double)) != 0) {
+        return NULL;
+    }
+    return (double *)memory;
+}
+
+Split_FFT_Plan *Split_FFT_Plan_Create(int n) {
+    Split_FFT_Plan *split_plan = (Split_FFT_Plan *)malloc(sizeof(Split_FFT_Plan));
+    split_plan->n = n;
+    split_plan->plan = Get_FFT_Plan(n);
+    split_plan->twiddle_re = Aligned_Doubles(n);
+    split_plan->twiddle_im = Aligned_Doubles(n);
+
+    // Copy the twiddles of each stage next to each other, the stage with
+    // half segment length h uses every (n / 2h)'th twiddle of the plan
+    complex double *twiddles = split_plan->plan->twiddles;
+    for (int half = 1; half < n; half <<= 1) {
+        int stride = n / (half << 1);
+        for (int j = 0; j < half; j++) {
+            split_plan->twiddle_re[half - 1 + j] = creal(twiddles[j * stride]);
+            split_plan->twiddle_im[half - 1 + j] = cimag(twiddles[j * stride]);
+        }
+    }
+    return split_plan;
+}
+
+void Split_FFT_Plan_Free(Split_FFT_Plan *split_plan) {
+    if (split_plan == NULL) {
+        return;
+    }
+    free(split_plan->twiddle_re);
+    free(split_plan->twiddle_im);
+    free(split_plan);
+}
+
+Split_FFT_Plan *Get_Split_FFT_Plan(int n) {
+    int log2n = log2(n);
+    pthread_mutex_lock(&split_plan_cache_lock);
+    if (split_plan_cache[log2n] == NULL) {
+        split_plan_cache[log2n] = Split_FFT_Plan_Create(n);
+    }
+    Split_FFT_Plan *split_plan = split_plan_cache[log2n];
+    pthread_mutex_unlock(&split_plan_cache_lock);
+    return split_plan;
+}
+
+
+// Reference kernel, also used for the first stages where the half segment
+// is shorter than a vector
+static void Stage_Scalar(double *re, double *im, double *w_re, double *w_im,
+                            int n, int half) {
+    double t_re, t_im, u_re, u_im;
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            int top = k + j, bottom = k + j + half;
+            // t = w * v
+            t_re = w_re[j] * re[bottom] - w_im[j] * im[bottom];
+            t_im = w_re[j] * im[bottom] + w_im[j] * re[bottom];
+            u_re = re[top];
+            u_im = im[top];
+            re[top] = u_re + t_re;
+            im[top] = u_im + t_im;
+            re[bottom] = u_re - t_re;
+            im[bottom] = u_im - t_im;
+        }
+    }
+}
+
+#ifdef FFT_SIMD_X86
+// The target attributes let gcc emit the instructions for these functions
+// only, they are never called unless the cpu reports support for them
+
+__attribute__((target("sse2")))
+static void Stage_SSE2(double *re, double *im, double *w_re, double *w_im,
+                        int n, int half) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j += 2) {
+            double *top_re = re + k + j, *top_im = im + k + j;
+            double *bottom_re = top_re + half, *bottom_im = top_im + half;
+            __m128d wr = _mm_loadu_pd(w_re + j), wi = _mm_loadu_pd(w_im + j);
+            __m128d vr = _mm_loadu_pd(bottom_re), vi = _mm_loadu_pd(bottom_im);
+            __m128d ur = _mm_loadu_pd(top_re), ui = _mm_loadu_pd(top_im);
+            // t = w * v
+            __m128d tr = _mm_sub_pd(_mm_mul_pd(wr, vr), _mm_mul_pd(wi, vi));
+            __m128d ti = _mm_add_pd(_mm_mul_pd(wr, vi), _mm_mul_pd(wi, vr));
+            _mm_storeu_pd(top_re, _mm_add_pd(ur, tr));
+            _mm_storeu_pd(top_im, _mm_add_pd(ui, ti));
+            _mm_storeu_pd(bottom_re, _mm_sub_pd(ur, tr));
+            _mm_storeu_pd(bottom_im, _mm_sub_pd(ui, ti));
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void Stage_AVX2(double *re, double *im, double *w_re, double *w_im,
+                        int n, int half) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j += 4) {
+            double *top_re = re + k + j, *top_im = im + k + j;
+            double *bottom_re = top_re + half, *bottom_im = top_im + half;
+            __m256d wr = _mm256_loadu_pd(w_re + j), wi = _mm256_loadu_pd(w_im + j);
+            __m256d vr = _mm256_loadu_pd(bottom_re), vi = _mm256_loadu_pd(bottom_im);
+            __m256d ur = _mm256_loadu_pd(top_re), ui = _mm256_loadu_pd(top_im);
+            // t = w * v with fused multiply add/subtract
+            __m256d tr = _mm256_fmsub_pd(wr, vr, _mm256_mul_pd(wi, vi));
+            __m256d ti = _mm256_fmadd_pd(wr, vi, _mm256_mul_pd(wi, vr));
+            _mm256_storeu_pd(top_re, _mm256_add_pd(ur, tr));
+            _mm256_storeu_pd(top_im, _mm256_add_pd(ui, ti));
+            _mm256_storeu_pd(bottom_re, _mm256_sub_pd(ur, tr));
+            _mm256_storeu_pd(bottom_im, _mm256_sub_pd(ui, ti));
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void Stage_AVX512(double *re, double *im, double *w_re, double *w_im,
+                            int n, int half) {
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j += 8) {
+            double *top_re = re + k + j, *top_im = im + k + j;
+            double *bottom_re = top_re + half, *bottom_im = top_im + half;
+            __m512d wr = _mm512_loadu_pd(w_re + j), wi = _mm512_loadu_pd(w_im + j);
+            __m512d vr = _mm512_loadu_pd(bottom_re), vi = _mm512_loadu_pd(bottom_im);
+            __m512d ur = _mm512_loadu_pd(top_re), ui = _mm512_loadu_pd(top_im);
+            __m512d tr = _mm512_fmsub_pd(wr, vr, _mm512_mul_pd(wi, vi));
+            __m512d ti = _mm512_fmadd_pd(wr, vi, _mm512_mul_pd(wi, vr));
+            _mm512_storeu_pd(top_re, _mm512_add_pd(ur, tr));
+            _mm512_storeu_pd(top_im, _mm512_add_pd(ui, ti));
+            _mm512_storeu_pd(bottom_re, _mm512_sub_pd(ur, tr));
+            _mm512_storeu_pd(bottom_im, _mm512_sub_pd(ui, ti));
+        }
+    }
+}
+#endif
+
+// Check if the cpu can run the kernel
+static bool Kernel_Supported(Split_FFT_Kernel kernel) {
+#ifdef FFT_SIMD_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+    case SPLIT_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case SPLIT_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SPLIT_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return kernel == SPLIT_KERNEL_SCALAR;
+    }
+#else
+    return kernel == SPLIT_KERNEL_SCALAR;
+#endif
+}
+
+void Set_Split_FFT_Kernel(Split_FFT_Kernel kernel) {
+    if (!Kernel_Supported(kernel)) {
+        kernel = SPLIT_KERNEL_SCALAR;
+    }
+    selected_kernel = kernel;
+    switch (kernel) {
+#ifdef FFT_SIMD_X86
+    case SPLIT_KERNEL_SSE2:
+        stage_kernel = Stage_SSE2;
+        stage_kernel_width = 2;
+        break;
+    case SPLIT_KERNEL_AVX2:
+        stage_kernel = Stage_AVX2;
+        stage_kernel_width = 4;
+        break;
+    case SPLIT_KERNEL_AVX512:
+        stage_kernel = Stage_AVX512;
+        stage_kernel_width = 8;
+        break;
+#endif
+    default:
+        stage_kernel = Stage_Scalar;
+        stage_kernel_width = 1;
+        break;
+    }
+}
+
+Split_FFT_Kernel Select_Split_FFT_Kernel() {
+    // Try the widest vectors first
+    Split_FFT_Kernel kernels[] = {SPLIT_KERNEL_AVX512, SPLIT_KERNEL_AVX2,
+                                    SPLIT_KERNEL_SSE2};
+    Split_FFT_Kernel best = SPLIT_KERNEL_SCALAR;
+    for (int i = 0; i < 3; i++) {
+        if (Kernel_Supported(kernels[i])) {
+            best = kernels[i];
+            break;
+        }
+    }
+    Set_Split_FFT_Kernel(best);
+    return best;
+}
+
+Split_FFT_Kernel Get_Split_FFT_Kernel() {
+    if (stage_kernel == NULL) {
+        Select_Split_FFT_Kernel();
+    }
+    return selected_kernel;
+}
+
+const char *Split_FFT_Kernel_Name(Split_FFT_Kernel kernel) {
+    switch (kernel) {
+    case SPLIT_KERNEL_SSE2:
+        return "SSE2";
+    case SPLIT_KERNEL_AVX2:
+        return "AVX2";
+    case SPLIT_KERNEL_AVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+
+// Run every stage on bit reversed split arrays
+static void Split_Stages(Split_FFT_Plan *split_plan, double *re, double *im) {
+    if (stage_kernel == NULL) {
+        Select_Split_FFT_Kernel();
+    }
+    int n = split_plan->n;
+    for (int half = 1; half < n; half <<= 1) {
+        double *w_re = split_plan->twiddle_re + half - 1;
+        double *w_im = split_plan->twiddle_im + half - 1;
+        // The vector kernels need at least one full vector per half segment
+        if (half < stage_kernel_width) {
+            Stage_Scalar(re, im, w_re, w_im, n, half);
+        } else {
+            stage_kernel(re, im, w_re, w_im, n, half);
+        }
+    }
+}
+
+void Split_FFT(Split_FFT_Plan *split_plan, double *in_re, double *in_im,
+                double *out_re, double *out_im) {
+    unsigned int *bit_reverse = split_plan->plan->bit_reverse;
+    for (int i = 0; i < split_plan->n; i++) {
+        out_re[i] = in_re[bit_reverse[i]];
+        out_im[i] = in_im[bit_reverse[i]];
+    }
+    Split_Stages(split_plan, out_re, out_im);
+}
+
+void Split_IFFT(Split_FFT_Plan *split_plan, double *in_re, double *in_im,
+                double *out_re, double *out_im) {
+    // Swapping the real and imaginary parts conjugates and multiplies by i,
+    // so IFFT(x) = swap(FFT(swap(x))) / n and the forward kernels are reused
+    Split_FFT(split_plan, in_im, in_re, out_im, out_re);
+
+    double scale = 1.0 / split_plan->n;
+    for (int i = 0; i < split_plan->n; i++) {
+        out_re[i] *= scale;
+        out_im[i] *= scale;
+    }
+}
+
+static void Split_Work_Key_Create() {
+    pthread_key_create(&split_work_key, (void (*)(void *))Multiply_Context_Free);
+}
+
+// Split arrays of n doubles for the calling thread
+static void Split_Work(int n, double **re, double **im) {
+    pthread_once(&split_work_once, Split_Work_Key_Create);
+    Multiply_Context *work = (Multiply_Context *)pthread_getspecific(split_work_key);
+    if (work == NULL) {
+        work = Multiply_Context_Create(0);
+        pthread_setspecific(split_work_key, work);
+    }
+    *re = (double *)Context_Buffer(work, 0, n * sizeof(double));
+    *im = (double *)Context_Buffer(work, 1, n * sizeof(double));
+}
+
+void Iterative_FFT_Split(complex double *input, int n, complex double *output) {
+    Split_FFT_Plan *split_plan = Get_Split_FFT_Plan(n);
+    unsigned int *bit_reverse = split_plan->plan->bit_reverse;
+    double *re, *im;
+    Split_Work(n, &re, &im);
+
+    // The bit reversal and the change of layout are done in the same pass
+    for (int i = 0; i < n; i++) {
+        re[i] = creal(input[bit_reverse[i]]);
+        im[i] = cimag(input[bit_reverse[i]]);
+    }
+    Split_Stages(split_plan, re, im);
+    for (int i = 0; i < n; i++) {
+        output[i] = re[i] + im[i] * I;
+    }
+}
+
+void Iterative_IFFT_Split(complex double *input, int n, complex double *output) {
+    Split_FFT_Plan *split_plan = Get_Split_FFT_Plan(n);
+    unsigned int *bit_reverse = split_plan->plan->bit_reverse;
+    double *re, *im;
+    Split_Work(n, &re, &im);
+
+    // Same swap trick as Split_IFFT
+    for (int i = 0; i < n; i++) {
+        im[i] = creal(input[bit_reverse[i]]);
+        re[i] = cimag(input[bit_reverse[i]]);
+    }
+    Split_Stages(split_plan, re, im);
+    double scale = 1.0 / n;
+    for (int i = 0; i < n; i++) {
+        output[i] = (im[i] + re[i] * I) * scale;
+    }
+}
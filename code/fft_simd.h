@@ -0,0 +1,66 @@
+#ifndef FFT_SIMD_H
+#define FFT_SIMD_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "multiply_context.h"
+
+// Radix-2 FFT on a split complex layout
+// Instead of an array of complex doubles (re, im, re, im, ...) the real and
+// imaginary parts are kept in two separate arrays (re, re, ..., im, im, ...).
+// A butterfly then loads W, u and v for 2, 4 or 8 consecutive j at once into
+// SSE2, AVX2 or AVX-512 registers and does the complex multiply with plain
+// vector multiplies and adds, no shuffling of real and imaginary parts needed.
+// The kernel is picked at runtime from the cpuid flags, so the program can be
+// built without -march and still use the widest vectors of the machine.
+
+typedef enum {
+    SPLIT_KERNEL_SCALAR,
+    SPLIT_KERNEL_SSE2,
+    SPLIT_KERNEL_AVX2,
+    SPLIT_KERNEL_AVX512
+} Split_FFT_Kernel;
+
+typedef struct {
+    int n;
+    FFT_Plan *plan;         // Shared bit reversal table
+    // Twiddles stored stage by stage, the stage with half segment length h
+    // uses e^{-i*TAU*j/(2h)} for j < h, stored contiguously from index h - 1
+    double *twiddle_re;
+    double *twiddle_im;
+} Split_FFT_Plan;
+
+Split_FFT_Plan *Split_FFT_Plan_Create(int n);
+
+void Split_FFT_Plan_Free(Split_FFT_Plan *plan);
+
+// Cached plan for size n, created on first use
+Split_FFT_Plan *Get_Split_FFT_Plan(int n);
+
+// Select the widest kernel supported by the cpu, called automatically on
+// the first transform
+Split_FFT_Kernel Select_Split_FFT_Kernel();
+
+// Force a kernel, e.g. SPLIT_KERNEL_SCALAR to verify the vector kernels.
+// Kernels the cpu does not support are ignored and the scalar one is used
+void Set_Split_FFT_Kernel(Split_FFT_Kernel kernel);
+
+// The kernel in use, selecting one first if none has been chosen yet
+Split_FFT_Kernel Get_Split_FFT_Kernel();
+
+const char *Split_FFT_Kernel_Name(Split_FFT_Kernel kernel);
+
+// Out of place transforms on split arrays of length n
+void Split_FFT(Split_FFT_Plan *plan, double *in_re, double *in_im,
+                double *out_re, double *out_im);
+
+void Split_IFFT(Split_FFT_Plan *plan, double *in_re, double *in_im,
+                double *out_re, double *out_im);
+
+// Same interface as Iterative_FFT, converts to the split layout internally.
+// The split arrays are scratch buffers of the calling thread, so threads can
+// run transforms of the same size at the same time
+void Iterative_FFT_Split(complex double *input, int n, complex double *output);
+
+void Iterative_IFFT_Split(complex double *input, int n, complex double *output);
+
+#endif
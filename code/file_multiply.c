@@ -0,0 +1,239 @@
+#include "file_multiply.h"
+
+// A file mapped into memory, data is NULL for an empty file as a mapping
+// can not have length 0
+typedef struct {
+    int fd;
+    void *data;
+    size_t size;
+    struct stat status;
+} Mapped_File;
+
+
+static bool Map_Input(const char *path, Mapped_File *file) {
+    file->data = NULL;
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0) {
+        perror(path);
+        return false;
+    }
+    if (fstat(file->fd, &file->status) != 0) {
+        perror(path);
+        close(file->fd);
+        return false;
+    }
+    file->size = file->status.st_size;
+    if (file->size == 0) {
+        return true;
+    }
+    file->data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    if (file->data == MAP_FAILED) {
+        perror(path);
+        close(file->fd);
+        return false;
+    }
+    // The conversion reads the operand once from start to end
+    madvise(file->data, file->size, MADV_SEQUENTIAL);
+    return true;
+}
+
+static void Unmap_File(Mapped_File *file) {
+    if (file->data != NULL) {
+        munmap(file->data, file->size);
+    }
+    close(file->fd);
+}
+
+// Create the result file with room for size bytes and map it. The product
+// is written into the mapping and the file is cut to its final size in
+// Finish_Output
+static bool Map_Output(const char *path, size_t size, Mapped_File *file) {
+    file->data = NULL;
+    file->size = size;
+    file->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file->fd < 0) {
+        perror(path);
+        return false;
+    }
+    if (size == 0) {
+        return true;
+    }
+    if (ftruncate(file->fd, size) != 0) {
+        perror(path);
+        close(file->fd);
+        return false;
+    }
+    file->data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    if (file->data == MAP_FAILED) {
+        perror(path);
+        file->data = NULL;
+        close(file->fd);
+        return false;
+    }
+    return true;
+}
+
+static bool Finish_Output(const char *path, Mapped_File *file, size_t size) {
+    bool success = true;
+    if (file->data != NULL) {
+        munmap(file->data, file->size);
+    }
+    if (ftruncate(file->fd, size) != 0) {
+        perror(path);
+        success = false;
+    }
+    if (close(file->fd) != 0) {
+        perror(path);
+        success = false;
+    }
+    return success;
+}
+
+static bool Check_Size(const char *path, Mapped_File *file, size_t element) {
+    if (file->size % element != 0) {
+        fprintf(stderr, "%s: the size %zu is not a multiple of %zu bytes\n",
+                path, file->size, element);
+        return false;
+    }
+    return true;
+}
+
+static bool Multiply_Limbs(Mapped_File *a, Mapped_File *b, const char *path_result) {
+    size_t a_count = a->size / sizeof(mp_limb_t), b_count = b->size / sizeof(mp_limb_t);
+    Mapped_File result;
+    if (!Map_Output(path_result, (a_count + b_count) * sizeof(mp_limb_t), &result)) {
+        return false;
+    }
+    size_t count = 0;
+    if (a_count > 0 && b_count > 0) {
+        count = Limbs_Multiply_FFT((const mp_limb_t *)a->data, a_count,
+                                    (const mp_limb_t *)b->data, b_count,
+                                    (mp_limb_t *)result.data);
+    }
+    return Finish_Output(path_result, &result, count * sizeof(mp_limb_t));
+}
+
+// The largest coefficient of a coefficient file, read from the mapping
+static uint32_t Largest_Coefficient(Mapped_File *file) {
+    const uint32_t *input = (const uint32_t *)file->data;
+    size_t count = file->size / sizeof(uint32_t);
+    uint32_t largest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (input[i] > largest) {
+            largest = input[i];
+        }
+    }
+    return largest;
+}
+
+static bool Multiply_Coefficients(Mapped_File *a, Mapped_File *b, const char *path_result) {
+    size_t a_count = a->size / sizeof(uint32_t), b_count = b->size / sizeof(uint32_t);
+    if (a_count == 0 || b_count == 0) {
+        Mapped_File result;
+        return Map_Output(path_result, 0, &result) && Finish_Output(path_result, &result, 0);
+    }
+    size_t length = a_count + b_count - 1;
+    // The first prime has the longest transforms, the coefficient sizes
+    // decide below whether the other primes are needed
+    if (length > ((size_t)1 << Get_NTT_Prime(0)->max_log2n)) {
+        fprintf(stderr, "The product has %zu coefficients, at most %d are supported\n",
+                length, 1 << Get_NTT_Prime(0)->max_log2n);
+        return false;
+    }
+    int n = 2;
+    while (n < length) {
+        n <<= 1;
+    }
+
+    uint64_t largest_a = Largest_Coefficient(a);
+    uint64_t largest_b = Largest_Coefficient(b);
+
+    // A coefficient of the product is a sum of at most min(la, lb) terms,
+    // each below 2^64 as the coefficients are below 2^32
+    uint64_t terms = (a_count < b_count) ? a_count : b_count;
+    uint64_t largest_term = largest_a * largest_b;
+    bool overflow = largest_term != 0 && terms > UINT64_MAX / largest_term;
+    uint64_t bound = terms * largest_term;
+    bool success = false;
+    if (overflow) {
+        fprintf(stderr, "The product coefficients can be larger than 64 bits\n");
+    } else if (n > (1 << Get_NTT_Prime(NTT_Primes_Needed(bound) - 1)->max_log2n)) {
+        fprintf(stderr, "The product has %zu coefficients, at most %d are supported "
+                "for coefficients of this size\n", length,
+                1 << Get_NTT_Prime(NTT_Primes_Needed(bound) - 1)->max_log2n);
+    } else {
+        // The reduction pass of every prime reads the mapped operands and
+        // pads them, and the convolution of length n goes straight into the
+        // result file, the padding past la + lb - 1 is cut off. The scratch
+        // only needs the residues of the primes in use
+        Mapped_File result;
+        if (Map_Output(path_result, n * sizeof(uint64_t), &result)) {
+            size_t arrays = 3 + NTT_Primes_Needed(bound);
+            uint32_t *scratch = (uint32_t *)malloc(arrays * n * sizeof(uint32_t));
+            NTT_Convolution_Padded_ext((const uint32_t *)a->data, a_count,
+                                        (const uint32_t *)b->data, b_count, n, bound,
+                                        (uint64_t *)result.data, scratch);
+            free(scratch);
+            success = Finish_Output(path_result, &result, length * sizeof(uint64_t));
+        }
+    }
+    return success;
+}
+
+bool File_Multiply(const char *path_a, const char *path_b, const char *path_result,
+                    File_Format format) {
+    Mapped_File a, b;
+    if (!Map_Input(path_a, &a)) {
+        return false;
+    }
+    if (!Map_Input(path_b, &b)) {
+        Unmap_File(&a);
+        return false;
+    }
+
+    bool success = false;
+    size_t element = (format == FILE_FORMAT_LIMBS) ? sizeof(mp_limb_t) : sizeof(uint32_t);
+    // Opening the result truncates it, which would pull the pages of an
+    // input that is the same file from under its mapping
+    struct stat status;
+    if (stat(path_result, &status) == 0 &&
+            ((status.st_dev == a.status.st_dev && status.st_ino == a.status.st_ino) ||
+             (status.st_dev == b.status.st_dev && status.st_ino == b.status.st_ino))) {
+        fprintf(stderr, "%s: the result can not overwrite an operand\n", path_result);
+    } else if (Check_Size(path_a, &a, element) && Check_Size(path_b, &b, element)) {
+        if (format == FILE_FORMAT_LIMBS) {
+            success = Multiply_Limbs(&a, &b, path_result);
+        } else {
+            success = Multiply_Coefficients(&a, &b, path_result);
+        }
+    }
+    Unmap_File(&a);
+    Unmap_File(&b);
+    return success;
+}
+
+int File_Multiply_Command(int argc, char **argv) {
+    File_Format format;
+    if (argc != 6 || strcmp(argv[1], "multiply") != 0) {
+        fprintf(stderr, "Usage: %s multiply <limbs|coefficients> a b result\n", argv[0]);
+        return 1;
+    }
+    if (strcmp(argv[2], "limbs") == 0) {
+        format = FILE_FORMAT_LIMBS;
+    } else if (strcmp(argv[2], "coefficients") == 0) {
+        format = FILE_FORMAT_COEFFICIENTS;
+    } else {
+        fprintf(stderr, "Unknown format %s, use limbs or coefficients\n", argv[2]);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!File_Multiply(argv[3], argv[4], argv[5], format)) {
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Multiplied in %f seconds\n",
+            end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0);
+    return 0;
+}
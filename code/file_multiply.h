@@ -0,0 +1,49 @@
+#ifndef FILE_MULTIPLY_H
+#define FILE_MULTIPLY_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Helper_Functions.h"
+#include "integer_multiply.h"
+#include "ntt.h"
+
+// Multiplication of operands stored in files
+// Numbers with hundreds of millions of digits are too big to type in or to
+// pass through decimal strings. The operands are instead read from binary
+// files that are mapped into memory with mmap, so the conversion into
+// coefficients reads the pages of the file directly into the transform
+// buffers, with no copy into a read buffer or an mpz first. The result file
+// is sized with ftruncate and mapped as well, and the carry pass of the
+// product writes into it. Two formats:
+//     FILE_FORMAT_LIMBS           an integer as 64 bit limbs, least
+//                                 significant limb first, in the byte order
+//                                 of the machine (the limbs of an mpz, or
+//                                 mpz_export(data, NULL, -1, 8, 0, 0, x)).
+//                                 The product is written the same way,
+//                                 without zero limbs at the top. The
+//                                 multiplication is Limbs_Multiply_FFT
+//     FILE_FORMAT_COEFFICIENTS    a polynomial as uint32_t coefficients,
+//                                 lowest degree first. The product is
+//                                 written as la + lb - 1 uint64_t
+//                                 coefficients, computed exactly with
+//                                 NTT_Convolution_Padded_ext, reading the
+//                                 mapped coefficients directly
+// Empty files are the number 0 or the empty polynomial.
+
+typedef enum {
+    FILE_FORMAT_LIMBS,
+    FILE_FORMAT_COEFFICIENTS
+} File_Format;
+
+// path_result = path_a * path_b in format. Returns false and prints the
+// reason to stderr if a file can not be read or written or the product is
+// out of range for the format
+bool File_Multiply(const char *path_a, const char *path_b, const char *path_result,
+                    File_Format format);
+
+// The command line mode of the program:
+//     program multiply <limbs|coefficients> a b result
+// Returns the exit status
+int File_Multiply_Command(int argc, char **argv);
+
+#endif
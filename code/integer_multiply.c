@@ -0,0 +1,315 @@
+#include "integer_multiply.h"
+
+
+double FFT_Error_Bound(int n, double norm_a, double norm_b) {
+    double epsilon = DBL_EPSILON / 2;
+    double beta = FFT_TWIDDLE_ERROR * epsilon;
+    // One more level for the twiddle multiplication between the column and
+    // row transforms of the six-step FFT
+    int levels = __builtin_ctz(n) + 1;
+    int rounds = 3 * levels + 3;
+    // (1 + e)^r is computed as exp(r * log1p(e)) so the tiny terms are not
+    // lost next to the 1
+    double growth = expm1(rounds * log1p(epsilon) +
+                            (rounds + 1) * log1p(epsilon * sqrt(5)) +
+                            rounds * log1p(beta));
+    return (norm_a * norm_a + norm_b * norm_b) * growth;
+}
+
+// Whether coefficients up to largest, count_a of them for a and count_b
+// for b, multiply exactly, transform_size gets the FFT length. The product
+// coefficients have to be integers a double can hold, and the error bound
+// has to keep them within 0.5 of the right value
+static bool FFT_Exact(size_t count_a, size_t count_b, double largest, int *transform_size) {
+    int n = 2;
+    while (n < count_a + count_b) {
+        n <<= 1;
+    }
+    *transform_size = n;
+    size_t terms = (count_a < count_b) ? count_a : count_b;
+    if (terms * largest * largest >= 9007199254740992.0) {  // 2^53
+        return false;
+    }
+    return FFT_Error_Bound(n, sqrt(count_a) * largest, sqrt(count_b) * largest) < 0.5;
+}
+
+int FFT_Coefficient_Bits(size_t bits_a, size_t bits_b, int *transform_size) {
+    for (int bits = FFT_MAX_COEFFICIENT_BITS; bits > 1; bits--) {
+        if (FFT_Exact((bits_a + bits - 1) / bits, (bits_b + bits - 1) / bits,
+                        ldexp(1, bits) - 1, transform_size)) {
+            return bits;
+        }
+    }
+    FFT_Exact(bits_a, bits_b, 1, transform_size);
+    return 1;
+}
+
+int FFT_Decimal_Digits(size_t digits_a, size_t digits_b, int *transform_size) {
+    double largest = 999999999;
+    for (int digits = 9; digits > 1; digits--, largest = (largest - 9) / 10) {
+        if (FFT_Exact((digits_a + digits - 1) / digits, (digits_b + digits - 1) / digits,
+                        largest, transform_size)) {
+            return digits;
+        }
+    }
+    FFT_Exact(digits_a, digits_b, 9, transform_size);
+    return 1;
+}
+
+size_t Limbs_Multiply_FFT(const mp_limb_t *a, size_t a_count,
+                            const mp_limb_t *b, size_t b_count, mp_limb_t *result) {
+    while (a_count > 0 && a[a_count - 1] == 0) {
+        a_count--;
+    }
+    while (b_count > 0 && b[b_count - 1] == 0) {
+        b_count--;
+    }
+    if (a_count == 0 || b_count == 0) {
+        return 0;
+    }
+
+    size_t bits_a = mpn_sizeinbase(a, a_count, 2);
+    size_t bits_b = mpn_sizeinbase(b, b_count, 2);
+    int n;
+    int bits = FFT_Coefficient_Bits(bits_a, bits_b, &n);
+
+    // Multi-million bit operands do not fit on the stack
+    complex double *packed = (complex double *)calloc(n, sizeof(complex double));
+    complex double *spectrum = (complex double *)malloc(n * sizeof(complex double));
+    complex double *work = (complex double *)malloc((n / 2) * sizeof(complex double));
+    double *product = (double *)malloc(n * sizeof(double));
+
+    // a in the real parts and b in the imaginary parts, read from the limbs
+    limbs_to_coefficients(a, a_count, bits, (double *)packed, 2);
+    limbs_to_coefficients(b, b_count, bits, (double *)packed + 1, 2);
+
+    // Same transforms as polynomial_multiply_iterative_FFT
+    FFT_Forward(packed, n, spectrum);
+    Packed_Real_Product(spectrum, n);
+    Real_IFFT(FFT_Inverse, spectrum, n, product, work);
+
+    // The bound makes the rounding exact, the check catches a transform
+    // engine that is less accurate than it assumes. GMP redoes such a product
+    size_t count;
+    if (Check_FFT_Rounding(product, n)) {
+        count = coefficients_to_limbs(product, n, bits, result, a_count + b_count);
+    } else {
+        Count_FFT_Fallback();
+        if (a_count >= b_count) {
+            mpn_mul(result, a, a_count, b, b_count);
+        } else {
+            mpn_mul(result, b, b_count, a, a_count);
+        }
+        count = a_count + b_count - (result[a_count + b_count - 1] == 0);
+    }
+
+    free(packed);
+    free(spectrum);
+    free(work);
+    free(product);
+    return count;
+}
+
+double mpz_multiply_FFT(mpz_t result, mpz_t a, mpz_t b) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int sign = mpz_sgn(a) * mpz_sgn(b);
+    // result may be a or b, the product is written to its own limbs
+    mpz_t product;
+    mpz_init(product);
+    size_t a_count = mpz_size(a), b_count = mpz_size(b);
+    if (sign != 0) {
+        mp_limb_t *limbs = mpz_limbs_write(product, a_count + b_count);
+        size_t count = Limbs_Multiply_FFT(mpz_limbs_read(a), a_count,
+                                            mpz_limbs_read(b), b_count, limbs);
+        mpz_limbs_finish(product, count);
+        if (sign < 0) {
+            mpz_neg(product, product);
+        }
+    }
+    mpz_swap(result, product);
+    mpz_clear(product);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+
+// Real FFT of length n of the bits bit coefficients of a number,
+// spectrum gets the bins 0..n/2
+static void Limbs_Spectrum(const mp_limb_t *limbs, size_t count, int bits, int n,
+                            complex double *spectrum, Multiply_Context *context) {
+    double *coefficients = (double *)Context_Buffer(context, 0, n * sizeof(double));
+    complex double *work = (complex double *)Context_Buffer(context, 1,
+                            (n / 2) * sizeof(complex double));
+    memset(coefficients, 0, n * sizeof(double));
+    limbs_to_coefficients(limbs, count, bits, coefficients, 1);
+    Real_FFT(FFT_Forward, coefficients, n, spectrum, work);
+}
+
+// result = a * b from their spectra spectrum_a and spectrum_b, result may
+// be a or b
+static void Spectrum_Product(const complex double *spectrum_a,
+                                const complex double *spectrum_b, mpz_t a, mpz_t b,
+                                int bits, int n, mpz_t result, Multiply_Context *context) {
+    double *coefficients = (double *)Context_Buffer(context, 0, n * sizeof(double));
+    complex double *work = (complex double *)Context_Buffer(context, 1,
+                            (n / 2) * sizeof(complex double));
+    complex double *product = (complex double *)Context_Buffer(context, 2,
+                                (n / 2 + 1) * sizeof(complex double));
+    for (int k = 0; k <= n / 2; k++) {
+        product[k] = spectrum_a[k] * spectrum_b[k];
+    }
+    Real_IFFT(FFT_Inverse, product, n, coefficients, work);
+    if (Check_FFT_Rounding(coefficients, n)) {
+        coefficients_to_mpz(coefficients, n, bits, result);
+    } else {
+        Count_FFT_Fallback();
+        mpz_mul(result, a, b);
+    }
+}
+
+double mpz_multiply_FFT_decimal(mpz_t result, mpz_t a, mpz_t b) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int sign = mpz_sgn(a) * mpz_sgn(b);
+    if (sign == 0) {
+        mpz_set_ui(result, 0);
+    } else {
+        int n;
+        // mpz_sizeinbase can be one digit too large, which only costs a
+        // safety margin
+        int digits = FFT_Decimal_Digits(mpz_sizeinbase(a, 10), mpz_sizeinbase(b, 10), &n);
+
+        complex double *packed = (complex double *)calloc(n, sizeof(complex double));
+        complex double *spectrum = (complex double *)malloc(n * sizeof(complex double));
+        complex double *work = (complex double *)malloc((n / 2) * sizeof(complex double));
+        double *product = (double *)malloc(n * sizeof(double));
+
+        // digits decimal digits per coefficient instead of one
+        mpz_to_decimal_coefficients(a, digits, (double *)packed, 2);
+        mpz_to_decimal_coefficients(b, digits, (double *)packed + 1, 2);
+
+        FFT_Forward(packed, n, spectrum);
+        Packed_Real_Product(spectrum, n);
+        Real_IFFT(FFT_Inverse, spectrum, n, product, work);
+
+        if (Check_FFT_Rounding(product, n)) {
+            decimal_coefficients_to_mpz(product, n, digits, result);
+            if (sign < 0) {
+                mpz_neg(result, result);
+            }
+        } else {
+            Count_FFT_Fallback();
+            mpz_mul(result, a, b);
+        }
+
+        free(packed);
+        free(spectrum);
+        free(work);
+        free(product);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+double mpz_square_FFT(mpz_t result, mpz_t a) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (mpz_sgn(a) == 0) {
+        mpz_set_ui(result, 0);
+    } else {
+        int n;
+        size_t bits_a = mpz_sizeinbase(a, 2);
+        int bits = FFT_Coefficient_Bits(bits_a, bits_a, &n);
+        Multiply_Context *context = Multiply_Context_Create(n);
+        complex double *spectrum = (complex double *)Context_Buffer(context, 3,
+                                    (n / 2 + 1) * sizeof(complex double));
+
+        // One real forward and one real inverse transform of length n/2,
+        // where the product of two numbers needs a complex one of length n
+        // and a real inverse
+        Limbs_Spectrum(mpz_limbs_read(a), mpz_size(a), bits, n, spectrum, context);
+        Spectrum_Product(spectrum, spectrum, a, a, bits, n, result, context);
+        Multiply_Context_Free(context);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+double mpz_power_FFT(mpz_t result, mpz_t x, unsigned long exponent) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    bool negative = mpz_sgn(x) < 0 && (exponent & 1);
+    if (exponent == 0 || mpz_cmpabs_ui(x, 1) <= 0) {
+        // x^0 = 1, and 0, 1 and -1 stay as they are
+        if (exponent == 0) {
+            mpz_set_ui(result, 1);
+        } else {
+            mpz_abs(result, x);
+        }
+    } else {
+        // Right to left: base runs through |x|^(2^i) and the powers of the
+        // set bits are multiplied into power. power < base at every step,
+        // so the transform that fits base^2 also fits power * base with the
+        // same coefficient size, and one forward transform of base serves
+        // both products
+        mpz_t base, power;
+        mpz_inits(base, power, NULL);
+        mpz_abs(base, x);
+        bool have_power = false;
+        Multiply_Context *context = Multiply_Context_Create(0);
+
+        while (true) {
+            bool bit = exponent & 1;
+            exponent >>= 1;
+            if (exponent == 0) {
+                // The top bit, base is not squared again
+                if (have_power) {
+                    mpz_multiply_FFT(power, power, base);
+                } else {
+                    mpz_swap(power, base);
+                }
+                break;
+            }
+            if (bit && !have_power) {
+                mpz_set(power, base);
+                have_power = true;
+                bit = false;
+            }
+
+            int n;
+            size_t bits_base = mpz_sizeinbase(base, 2);
+            int bits = FFT_Coefficient_Bits(bits_base, bits_base, &n);
+            complex double *spectrum_base = (complex double *)Context_Buffer(context, 3,
+                                            (n / 2 + 1) * sizeof(complex double));
+            Limbs_Spectrum(mpz_limbs_read(base), mpz_size(base), bits, n, spectrum_base,
+                            context);
+            if (bit) {
+                complex double *spectrum_power = (complex double *)Context_Buffer(context, 4,
+                                                    (n / 2 + 1) * sizeof(complex double));
+                Limbs_Spectrum(mpz_limbs_read(power), mpz_size(power), bits, n,
+                                spectrum_power, context);
+                Spectrum_Product(spectrum_power, spectrum_base, power, base, bits, n, power,
+                                    context);
+            }
+            Spectrum_Product(spectrum_base, spectrum_base, base, base, bits, n, base, context);
+        }
+
+        mpz_swap(result, power);
+        Multiply_Context_Free(context);
+        mpz_clears(base, power, NULL);
+    }
+    if (negative) {
+        mpz_neg(result, result);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
@@ -0,0 +1,89 @@
+#ifndef INTEGER_MULTIPLY_H
+#define INTEGER_MULTIPLY_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include <float.h>
+#include "real_fft.h"
+#include "multiply_context.h"
+#include "fft_rounding.h"
+
+// Integer multiplication with the FFT on binary coefficients
+// The polynomial_multiply_* functions work on decimal digits so their
+// results can be checked digit by digit, which needs a radix conversion of
+// both operands. Here the operands are cut into coefficients of bits bits
+// straight from their limbs (mpz_to_coefficients), multiplied as
+// polynomials with one packed real FFT, and the product coefficients are
+// carried back into limbs (coefficients_to_mpz). Evaluating the product
+// polynomial at x = 2^bits gives the product of the numbers. For numbers
+// that are at hand in decimal, mpz_multiply_FFT_decimal does the same with
+// coefficients of several decimal digits, x = 10^digits, instead of the
+// single digit per coefficient of the polynomial_multiply_* functions.
+
+// Error bound
+// A coefficient of the product comes out of the transforms with a rounding
+// error, and rounding it to the nearest integer is only right while the
+// error is below 0.5. For a convolution of length n = 2^k done with three
+// FFTs Percival (2003) bounds the error of every coefficient by
+//     ||a|| * ||b|| * ((1 + e)^3k * (1 + e*sqrt(5))^(3k + 1) * (1 + beta)^3k - 1)
+// with e = 2^-53 the rounding of a double, beta the error of the twiddles
+// and ||.|| the Euclidean norm of the coefficients. The packed product
+// sends a + i*b through one transform and splits the spectra, which is
+// covered by counting 3 more rounds and taking ||a + i*b||^2 for
+// ||a|| * ||b||. The six-step FFT multiplies by twiddles between its column
+// and row transforms, one level more than the radix-2 FFT, so the bound is
+// taken for k + 1 levels whatever engine FFT_Forward runs. The coefficient size is the largest one for which this
+// bound, with every coefficient at its largest value, stays below 0.5, so
+// the rounding is exact by construction rather than by a safety margin.
+// The distance to the integers is still recorded with Check_FFT_Rounding,
+// and a product past the margin of fft_rounding.h is redone with GMP.
+
+// Bound on |twiddle - e^{-i*TAU*k/n}| in units of 2^-53 for every engine
+// FFT_Forward can run. The twiddles of Get_FFT_Plan are cos and sin of an
+// angle below pi/4 with three roundings, measured at most 1.45 units up to
+// n = 2^24 against long double. The radix-2, SIMD, radix-4, split-radix,
+// Stockham and parallel FFTs read their twiddles from that table (with
+// exact sign changes and conjugates), and the real FFT splits use it too.
+// The six-step FFT multiplies a twiddle of the plan of size n2 with one
+// of its fine table, measured at most 2.46 units up to n = 2^24
+#define FFT_TWIDDLE_ERROR 4
+
+// limbs_to_coefficients cuts coefficients of at most 32 bits
+#define FFT_MAX_COEFFICIENT_BITS 32
+
+// Bound on the error of any coefficient of the packed FFT product of length
+// n of two polynomials with the Euclidean norms norm_a and norm_b
+double FFT_Error_Bound(int n, double norm_a, double norm_b);
+
+// Largest coefficient size in bits for which a product of a bits_a bit and
+// a bits_b bit number is exact by FFT_Error_Bound, transform_size gets the
+// FFT length for that size
+int FFT_Coefficient_Bits(size_t bits_a, size_t bits_b, int *transform_size);
+
+// Same for base 10^digits coefficients of decimal numbers, at most 9 digits
+int FFT_Decimal_Digits(size_t digits_a, size_t digits_b, int *transform_size);
+
+// The product of the limb arrays a and b (least significant limb first) into
+// result, which holds a_count + b_count limbs and must not overlap a or b.
+// Returns the number of limbs of the product up to the highest non-zero one
+size_t Limbs_Multiply_FFT(const mp_limb_t *a, size_t a_count,
+                            const mp_limb_t *b, size_t b_count, mp_limb_t *result);
+
+// result = a * b, returns the elapsed time of the whole multiplication
+// including the conversions
+double mpz_multiply_FFT(mpz_t result, mpz_t a, mpz_t b);
+
+// result = a * b through coefficients of several decimal digits, the
+// base 10^digits chosen by FFT_Decimal_Digits
+double mpz_multiply_FFT_decimal(mpz_t result, mpz_t a, mpz_t b);
+
+// result = a * a with one real forward and one real inverse transform, both
+// of half the length of the packed transform of mpz_multiply_FFT
+double mpz_square_FFT(mpz_t result, mpz_t a);
+
+// result = x^exponent by repeated squaring. The square of the running power
+// of x and the product with the result so far share the forward transform
+// of that power, so a set bit of the exponent costs one more forward and
+// one more inverse transform instead of a whole multiplication
+double mpz_power_FFT(mpz_t result, mpz_t x, unsigned long exponent);
+
+#endif
@@ -1,36 +1,126 @@
 #include "iterative_fft.h"
+#include "real_fft.h"
+#include "fft_simd.h"
+#include "radix4_fft.h"
+#include "split_radix_fft.h"
+#include "stockham_fft.h"
+#include "parallel_fft.h"
+#include "six_step_fft.h"
+#include "fft_rounding.h"
 
 
 
-void Iterative_FFT(complex double* input, int n, complex double* output) {
-    int reverse_bit;
+// Plans created by Get_FFT_Plan, indexed by log2(n)
+static FFT_Plan *plan_cache[32];
+// Guards plan_cache, so threads can ask for plans at the same time
+static pthread_mutex_t plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+FFT_Plan *FFT_Plan_Create(int n) {
+    FFT_Plan *plan = (FFT_Plan *)malloc(sizeof(FFT_Plan));
+    plan->n = n;
+    plan->log2n = log2(n);
+    plan->bit_reverse = (unsigned int *)malloc(n * sizeof(unsigned int));
+    // Always keep at least one twiddle so n = 1 is a valid plan
+    plan->twiddles = (complex double *)malloc((n / 2 + 1) *
+                                                sizeof(complex double));
+
+    // Bit reversal is done once here instead of log2(n) shifts per element
+    // on every transform
+    for (unsigned int i = 0; i < n; i++) {
+        plan->bit_reverse[i] = Bit_Reverse(i, plan->log2n);
+    }
+
+    // Every twiddle is computed directly from cos and sin instead of the
+    // w *= w_n recurrence, which gathers rounding errors for every multiply.
+    // Only the first octant is computed, the rest are exact reflections of it
+    // since e^{-i*x} for x in [0, pi] is symmetric around pi/4 and pi/2
+    if (n < 8) {
+        for (int k = 0; k < n / 2; k++) {
+            plan->twiddles[k] = cexp(-I * TAU * k / n);
+        }
+    } else {
+        int quarter = n >> 2, eighth = n >> 3;
+        for (int k = 0; k <= eighth; k++) {
+            double c = cos(TAU * k / n), s = sin(TAU * k / n);
+            plan->twiddles[k] = c - s * I;                // e^{-i*x}
+            plan->twiddles[quarter - k] = s - c * I;      // e^{-i*(pi/2 - x)}
+            plan->twiddles[quarter + k] = -s - c * I;     // e^{-i*(pi/2 + x)}
+            if (k > 0) {
+                plan->twiddles[2 * quarter - k] = -c - s * I; // e^{-i*(pi - x)}
+            }
+        }
+    }
+    return plan;
+}
+
+void FFT_Plan_Free(FFT_Plan *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->bit_reverse);
+    free(plan->twiddles);
+    free(plan);
+}
+
+FFT_Plan *Get_FFT_Plan(int n) {
+    int log2n = log2(n);
+    pthread_mutex_lock(&plan_cache_lock);
+    if (plan_cache[log2n] == NULL) {
+        plan_cache[log2n] = FFT_Plan_Create(n);
+    }
+    FFT_Plan *plan = plan_cache[log2n];
+    pthread_mutex_unlock(&plan_cache_lock);
+    return plan;
+}
+
+void Free_FFT_Plan_Cache() {
+    for (int i = 0; i < 32; i++) {
+        FFT_Plan_Free(plan_cache[i]);
+        plan_cache[i] = NULL;
+    }
+}
+
+void Plan_Bit_Reverse(FFT_Plan *plan, complex double *input,
+                        complex double *output) {
+    if (plan->log2n >= COBRA_MIN_LOG2N) {
+        COBRA_Bit_Reverse(input, output, plan->log2n);
+        return;
+    }
+    for (int i = 0; i < plan->n; i++) {
+        output[i] = input[plan->bit_reverse[i]];
+    }
+}
+
+// Shared radix-2 loop for the forward and inverse transform, the inverse
+// transform only differs by using the conjugate twiddle factors
+static void Iterative_Transform(FFT_Plan *plan, complex double *input,
+                                complex double *output, bool inverse) {
+    int n = plan->n;
     // bit reversal of the given array, this step from pseudocode: bit-reverse-copy(a, A)
     // Example: Index 3: 011 (binary) → Bit-reversed: 110 → Reverse index 6
     // so instead of working with index 3, we are now working with index 6
     // This reorders the array elements and allows them to be merged more efficiently
-    int log2n = log2(n);
-
-    for (unsigned int i = 0; i < n; i++) {
-        reverse_bit = Bit_Reverse(i, log2n);
-        output[i] = input[reverse_bit];
-    }
+    Plan_Bit_Reverse(plan, input, output);
 
-    int fft_segment_length, fft_half_segment_length;
-    complex double unity_root_factor, segment_root_of_unity,
-                    twiddle_factor, tmp;
+    int fft_segment_length, fft_half_segment_length, twiddle_stride;
+    complex double unity_root_factor, twiddle_factor, tmp;
     // FFT computation
     // The outer loop runs log_2(n) times, but within the loops it will cover all n
     // elements, therefore the runtime is O(n log n) times.
-    for (int s = 1; s <= log2n; s++) {
+    for (int s = 1; s <= plan->log2n; s++) {
         fft_segment_length = 1 << s; // pow(2, s)
-         // Principal root of unity for the current segment
-        segment_root_of_unity = cexp(-I * TAU / fft_segment_length);
+        fft_half_segment_length = fft_segment_length >> 1; // /2
+        // The segment root of unity is e^{-i*TAU/fft_segment_length}, which is
+        // twiddles[n / fft_segment_length], so its powers are every
+        // twiddle_stride'th entry of the table
+        twiddle_stride = n >> s;
 
         for (int k = 0; k < n; k += fft_segment_length) {
-            // Initialize unity root factor (ω) to 1, use 0*I to create complex number
-            unity_root_factor = 1 + 0 * I;
-            fft_half_segment_length = fft_segment_length >> 1; // /2
             for (int j = 0; j < fft_half_segment_length; j++) {
+                unity_root_factor = plan->twiddles[j * twiddle_stride];
+                if (inverse) {
+                    unity_root_factor = conj(unity_root_factor);
+                }
                 // Twiddle factor application: https://en.wikipedia.org/wiki/Twiddle_factor
                 twiddle_factor = unity_root_factor *
                                 output[k + j + fft_half_segment_length];
@@ -39,100 +129,222 @@ void Iterative_FFT(complex double* input, int n, complex double* output) {
                 // Applying FFT butterfly updates
                 output[k + j] = tmp + twiddle_factor;
                 output[k + j + fft_half_segment_length] = tmp - twiddle_factor;
-
-                // Update the unity root factor
-                unity_root_factor *= segment_root_of_unity;
             }
         }
     }
 }
 
-void Iterative_IFFT(complex double* input, int n, complex double* output) {
-    int reverse_bit;
-    // bit reversal of the given array, this step from pseudocode: bit-reverse-copy(a, A)
-    // Example: Index 3: 011 (binary) → Bit-reversed: 110 → Reverse index 6
-    //          so instead of working with index 3, we are now working with index 6
-    // This reorders the array elements and allows them to be merged more efficiently
-    int log2n = log2(n);
-    for (unsigned int i = 0; i < n; i++) {
-        reverse_bit = Bit_Reverse(i, log2n);
-        output[i] = input[reverse_bit];
+void Iterative_FFT_Plan(FFT_Plan *plan, complex double *input,
+                        complex double *output) {
+    Iterative_Transform(plan, input, output, false);
+}
+
+void Iterative_IFFT_Plan(FFT_Plan *plan, complex double *input,
+                            complex double *output) {
+    Iterative_Transform(plan, input, output, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < plan->n; i++) {
+        output[i] /= plan->n;
     }
+}
 
-    int fft_segment_length, fft_half_segment_length;
-    complex double unity_root_factor, segment_root_of_unity, twiddle_factor, tmp;
-    // IFFT computation
-    for (int s = 1; s <= log2n; s++) {
-        fft_segment_length = pow(2, s);
-         // Principal root of unity for the current segment
-        segment_root_of_unity = cexp(I * TAU / fft_segment_length);
+void Iterative_FFT(complex double* input, int n, complex double* output) {
+    Iterative_FFT_Plan(Get_FFT_Plan(n), input, output);
+}
 
-        for (int k = 0; k < n; k += fft_segment_length) {
-            // Initialize unity root factor (ω) to 1, use 0*I to create complex number
-            unity_root_factor = 1 + 0 * I;
-            fft_half_segment_length = fft_segment_length >> 1;
-            for (int j = 0; j < fft_half_segment_length; j++) {
-                // Twiddle factor application: https://en.wikipedia.org/wiki/Twiddle_factor
-                twiddle_factor = unity_root_factor *
-                                output[k + j + fft_half_segment_length];
-                tmp = output[k + j];
+void Iterative_IFFT(complex double* input, int n, complex double* output) {
+    Iterative_IFFT_Plan(Get_FFT_Plan(n), input, output);
+}
 
-                // Applying FFT butterfly updates
-                output[k + j] = tmp + twiddle_factor;
-                output[k + j + fft_half_segment_length] = tmp - twiddle_factor;
 
-                // Update the unity root factor
-                unity_root_factor *= segment_root_of_unity;
-            }
-        }
+// Engine used by FFT_Forward and FFT_Inverse. The default is the SIMD
+// engine, the only one whose butterflies use the vector units, and also the
+// only one that can transform in place
+static FFT_Engine fft_engine = FFT_ENGINE_SIMD;
+
+void Set_FFT_Engine(FFT_Engine engine) {
+    fft_engine = engine;
+}
+
+FFT_Engine Get_FFT_Engine() {
+    return fft_engine;
+}
+
+const char *FFT_Engine_Name(FFT_Engine engine) {
+    switch (engine) {
+    case FFT_ENGINE_SIMD:
+        return "Radix-2 SIMD";
+    case FFT_ENGINE_RADIX4:
+        return "Radix-4";
+    case FFT_ENGINE_SPLIT_RADIX:
+        return "Split-radix";
+    case FFT_ENGINE_STOCKHAM:
+        return "Stockham";
+    default:
+        return "Radix-2";
     }
+}
 
-    // Normalize the output by dividing by n
-    for (int i = 0; i < n; i++) {
-        output[i] /= n;
+void FFT_Forward(complex double *input, int n, complex double *output) {
+    // With more than one thread large transforms use the parallel radix-2
+    // FFT whatever engine is selected
+    if (Use_Parallel_FFT(n)) {
+        Parallel_Iterative_FFT(input, n, output);
+        return;
+    }
+    // Transforms that do not fit in the cache are split into row transforms
+    // of about sqrt(n) values, which run on the selected engine
+    if (n >= Six_Step_Threshold()) {
+        Six_Step_FFT(input, n, output);
+        return;
+    }
+    switch (fft_engine) {
+    case FFT_ENGINE_SIMD:
+        Iterative_FFT_Split(input, n, output);
+        break;
+    case FFT_ENGINE_RADIX4:
+        Radix4_FFT(input, n, output);
+        break;
+    case FFT_ENGINE_SPLIT_RADIX:
+        Split_Radix_FFT(input, n, output);
+        break;
+    case FFT_ENGINE_STOCKHAM:
+        Stockham_FFT(input, n, output);
+        break;
+    default:
+        Iterative_FFT(input, n, output);
+        break;
     }
 }
 
+void FFT_Inverse(complex double *input, int n, complex double *output) {
+    if (Use_Parallel_FFT(n)) {
+        Parallel_Iterative_IFFT(input, n, output);
+        return;
+    }
+    if (n >= Six_Step_Threshold()) {
+        Six_Step_IFFT(input, n, output);
+        return;
+    }
+    switch (fft_engine) {
+    case FFT_ENGINE_SIMD:
+        Iterative_IFFT_Split(input, n, output);
+        break;
+    case FFT_ENGINE_RADIX4:
+        Radix4_IFFT(input, n, output);
+        break;
+    case FFT_ENGINE_SPLIT_RADIX:
+        Split_Radix_IFFT(input, n, output);
+        break;
+    case FFT_ENGINE_STOCKHAM:
+        Stockham_IFFT(input, n, output);
+        break;
+    default:
+        Iterative_IFFT(input, n, output);
+        break;
+    }
+}
 
 
 double polynomial_multiply_iterative_FFT(mpz_t a, mpz_t b, int n,
                                         int* iterative_fft_total_result) {
-    
+    return polynomial_multiply_iterative_FFT_ctx(a, b, n, iterative_fft_total_result,
+                                                    Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_iterative_FFT_ctx(mpz_t a, mpz_t b, int n,
+                                            int* iterative_fft_total_result,
+                                            Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int max_n = context->max_n;
 
     // Pad the inputs with zeros, the polynomials are represented as arays
     // Padding ensures the data is clean
-    // Arrays help structure the data into parts
-    complex double padded_a[n], padded_b[n], fft_result[n];
-    memset(padded_a, 0, n * sizeof(complex double));
-    memset(padded_b, 0, n * sizeof(complex double));
-    memset(fft_result, 0, n * sizeof(complex double));
+    // Both polynomials are real, so they share one complex array with
+    // a in the real part and b in the imaginary part
+    // The arrays are the context buffers, sized for max_n so every call
+    // reuses the same memory
+    complex double *packed = (complex double *)Context_Buffer(context, 0,
+                                max_n * sizeof(complex double));
+    complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                max_n * sizeof(complex double));
+    complex double *work = (complex double *)Context_Buffer(context, 2,
+                            max_n * sizeof(complex double));
+    double *fft_result = (double *)Context_Buffer(context, 3, max_n * sizeof(double));
+    memset(packed, 0, n * sizeof(complex double));
 
-    mpz_to_complex_array(a, padded_a);
-    mpz_to_complex_array(b, padded_b);
+    mpz_to_double_array(a, (double *)packed, 2);
+    mpz_to_double_array(b, (double *)packed + 1, 2);
 
-    // // Apply FFT to both polynomials
-    complex double fa[n], fb[n];
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
 
-    Iterative_FFT(padded_a, n, fa);
-    Iterative_FFT(padded_b, n, fb);
+    // // Apply one FFT to both polynomials
+    // The selected engine runs on the plan of size n, which is shared by
+    // every multiplication of that size
+    FFT_Forward(packed, n, spectrum);
+
+    // // Point-wise multiply the FFTs, only the bins 0..n/2 are needed since
+    // the product is real
+    Packed_Real_Product(spectrum, n);
+
+    // // Apply the real IFFT, which only needs a transform of length n/2
+    Real_IFFT(FFT_Inverse, spectrum, n, fft_result, work);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
 
-    // // Point-wise multiply the FFTs
-    for (int i = 0; i < n; i++) {
-        fa[i] *= fb[i];
+    // Perform the conversion from double to int by rounding, a product that
+    // came too close to a rounding error is redone exactly
+    if (!Round_FFT_Result(fft_result, n, iterative_fft_total_result)) {
+        elapsed_time += Exact_Fallback_Multiply(a, b, n, iterative_fft_total_result, context);
     }
 
-    // // Apply IFFT to get the product polynomial
-    Iterative_IFFT(fa, n, fft_result);
+    return elapsed_time;
+}
+
+
+double polynomial_square_iterative_FFT(mpz_t a, int n, int* iterative_fft_total_result) {
+    return polynomial_square_iterative_FFT_ctx(a, n, iterative_fft_total_result,
+                                                Get_Default_Multiply_Context(n));
+}
+
+double polynomial_square_iterative_FFT_ctx(mpz_t a, int n, int* iterative_fft_total_result,
+                                            Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int max_n = context->max_n;
+
+    // Only one real polynomial, so nothing to pack with it. Its real FFT
+    // is a complex FFT of length n/2 instead of the length n transform of
+    // the packed a + i*b
+    double *padded = (double *)Context_Buffer(context, 0, max_n * sizeof(double));
+    complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                (max_n / 2 + 1) * sizeof(complex double));
+    complex double *work = (complex double *)Context_Buffer(context, 2,
+                            (max_n / 2) * sizeof(complex double));
+    double *fft_result = (double *)Context_Buffer(context, 3, max_n * sizeof(double));
+    memset(padded, 0, n * sizeof(double));
+
+    mpz_to_double_array(a, padded, 1);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // One forward and one inverse real transform, both of length n/2
+    Real_FFT(FFT_Forward, padded, n, spectrum, work);
+    for (int k = 0; k <= n / 2; k++) {
+        spectrum[k] *= spectrum[k];
+    }
+    Real_IFFT(FFT_Inverse, spectrum, n, fft_result, work);
     clock_gettime(CLOCK_MONOTONIC, &end);
 
     double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
-    
-    // Perform the conversion from complex double to int by extracting the real part and rounding
-    for (int i = 0; i < n; i++) {
-        iterative_fft_total_result[i] = (int)round(creal(fft_result[i]));
+
+    // Rounded and checked the same way as the multiplication
+    if (!Round_FFT_Result(fft_result, n, iterative_fft_total_result)) {
+        elapsed_time += Exact_Fallback_Square(a, n, iterative_fft_total_result, context);
     }
 
     return elapsed_time;
-}
\ No newline at end of file
+}
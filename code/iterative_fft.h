@@ -1,4 +1,8 @@
+#ifndef ITERATIVE_FFT_H
+#define ITERATIVE_FFT_H
+#include <pthread.h>
 #include "Helper_Functions.h"
+#include "multiply_context.h"
 
 
 
@@ -24,8 +28,84 @@
 //     return y # y is assumed to be a column vector
 
 
+// FFT plan, created once per size n and executed many times.
+// Everything that only depends on n is computed when the plan is created,
+// so executing the plan does no cexp calls and no twiddle recurrences
+typedef struct {
+    int n;                      // Transform size, must be a power of 2
+    int log2n;                  // log2(n)
+    unsigned int *bit_reverse;  // bit_reverse[i] = Bit_Reverse(i, log2n)
+    complex double *twiddles;   // twiddles[k] = e^{-i*TAU*k/n} for 0 <= k < n/2
+} FFT_Plan;
+
+// Twiddle e^{-i*TAU*k/n} for any 0 <= k < n, the upper half of the circle
+// is the lower half negated since e^{-i*pi} = -1
+static inline complex double Plan_Twiddle(FFT_Plan *plan, int k) {
+    int half = plan->n >> 1;
+    return (k < half) ? plan->twiddles[k] : -plan->twiddles[k - half];
+}
+
+// The engines that can run the transforms of polynomial_multiply_iterative_FFT,
+// they all take the same (input, n, output) arguments
+typedef enum {
+    FFT_ENGINE_RADIX2,      // Iterative_FFT, radix-2 on interleaved complex values
+    FFT_ENGINE_SIMD,        // Iterative_FFT_Split, radix-2 with SIMD kernels
+    FFT_ENGINE_RADIX4,      // Radix4_FFT, two radix-2 stages per pass
+    FFT_ENGINE_SPLIT_RADIX, // Split_Radix_FFT, fewest multiplications
+    FFT_ENGINE_STOCKHAM     // Stockham_FFT, no bit reversal pass
+} FFT_Engine;
+
+void Set_FFT_Engine(FFT_Engine engine);
+
+FFT_Engine Get_FFT_Engine();
+
+const char *FFT_Engine_Name(FFT_Engine engine);
+
+// Forward and inverse transform with the selected engine
+void FFT_Forward(complex double *input, int n, complex double *output);
+
+void FFT_Inverse(complex double *input, int n, complex double *output);
+
+// Allocate a plan for size n and precompute the permutation and twiddle table
+FFT_Plan *FFT_Plan_Create(int n);
+
+void FFT_Plan_Free(FFT_Plan *plan);
+
+// Return the plan for size n, creating it on first use. Plans are kept for
+// the lifetime of the program so repeated calls of the same size are free
+FFT_Plan *Get_FFT_Plan(int n);
+
+// Free every plan created by Get_FFT_Plan
+void Free_FFT_Plan_Cache();
+
+// From this size on the arrays no longer fit in the L2 cache and the cache
+// blocked COBRA permutation beats the table lookup, 2^17 values are 2 MB
+#define COBRA_MIN_LOG2N 17
+
+// output[i] = input[bit_reverse[i]], using COBRA for large n
+void Plan_Bit_Reverse(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Iterative_FFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Iterative_IFFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
 void Iterative_FFT(complex double* input, int n, complex double* output);
 
 void Iterative_IFFT(complex double* input, int n, complex double* output);
 
 double polynomial_multiply_iterative_FFT(mpz_t a, mpz_t b, int n, int* iterative_fft_total_result);
+
+// Same multiplication with the scratch buffers of context, n must be at most
+// context->max_n. The version above uses the default context
+double polynomial_multiply_iterative_FFT_ctx(mpz_t a, mpz_t b, int n,
+                                            int* iterative_fft_total_result,
+                                            Multiply_Context *context);
+
+// The digits of a * a. Both operands are the same, so the product takes one
+// real forward and one real inverse transform
+double polynomial_square_iterative_FFT(mpz_t a, int n, int* iterative_fft_total_result);
+
+double polynomial_square_iterative_FFT_ctx(mpz_t a, int n, int* iterative_fft_total_result,
+                                            Multiply_Context *context);
+
+#endif
@@ -1,4 +1,7 @@
 #include "karatsuba.h"
+#include "parallel_karatsuba.h"
+
+static int karatsuba_cutoff = KARATSUBA_CUTOFF;
 
 
 // Recursive Karatsuba multiplication for numbers
@@ -62,12 +65,43 @@ void karatsuba(mpz_t num1, mpz_t num2, mpz_t karatsuba_result) {
 }
 
 
-// Karatsuba multiplication for polynomials
-void Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
-                            int length_input2, int *result) {
-    // Check if either number is 2 digits, if yes then multiply.
-    // C is really fast for small number multiplication, so it doesn't need to check for 1 digit
-    if (length_input1 <= 250 || length_input2 <= 250) { // Base case for the smallest size
+void Set_Karatsuba_Cutoff(int cutoff) {
+    // The recursion needs at least 1 value per half
+    karatsuba_cutoff = (cutoff > 0) ? cutoff : KARATSUBA_CUTOFF;
+}
+
+int Get_Karatsuba_Cutoff() {
+    return karatsuba_cutoff;
+}
+
+int Karatsuba_Scratch_Size(int length_input1, int length_input2, int cutoff) {
+    // Every level keeps 4 * half_length values (the two sums and the middle
+    // product) while it recurses, the largest recursion is the middle one on
+    // two half_length inputs, so the levels stack up along that path
+    int size = 0;
+    while (length_input1 > cutoff && length_input2 > cutoff) {
+        int half_length1 = (length_input1 + 1) >> 1;
+        int half_length2 = (length_input2 + 1) >> 1;
+        int half_length = (half_length1 > half_length2) ? half_length1 : half_length2;
+        size += 4 * half_length;
+        length_input1 = half_length;
+        length_input2 = half_length;
+    }
+    return size;
+}
+
+// Karatsuba multiplication for polynomials with the scratch memory passed in
+// scratch must hold Karatsuba_Scratch_Size(length_input1, length_input2, cutoff)
+// values. The halves of the inputs are used in place as pointers into the
+// inputs, the low and high products are written straight into result, only the
+// sums and the middle product need scratch memory, and the recursion uses the
+// scratch after them
+void Karatsuba_Polynomial_ext(int *input1, int *input2, int length_input1,
+                                int length_input2, int *result, int *scratch,
+                                int cutoff) {
+    // Below the cutoff the schoolbook multiplication is faster, the loops are
+    // simple and there are no recursive calls
+    if (length_input1 <= cutoff || length_input2 <= cutoff) { // Base case for the smallest size
         Array_Multiplication(input1, input2, length_input1,
                                 length_input2, result);
         return;
@@ -78,87 +112,194 @@ void Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
 
     // Find the longest half length
     int half_length = (half_length1 > half_length2) ? half_length1 : half_length2;
+    int max_length = length_input1 + length_input2 - 1;
+
+    // Lengths of the halves, the low half of the shorter input can be shorter
+    // than half_length and its high half can be empty
+    int low_length1 = (length_input1 < half_length) ? length_input1 : half_length;
+    int low_length2 = (length_input2 < half_length) ? length_input2 : half_length;
+    int high_length1 = length_input1 - low_length1;
+    int high_length2 = length_input2 - low_length2;
 
-    // Allocate memory
-    int *low1 = calloc(half_length, sizeof(int));
-    int *low2 = calloc(half_length, sizeof(int));
-    int *high1 = calloc(half_length, sizeof(int));
-    int *high2 = calloc(half_length, sizeof(int));
-    int *result_low = calloc(length_input1 + length_input2 - 1, sizeof(int));
-    int *result_high = calloc(length_input1 + length_input2 - 1, sizeof(int));
-    int *result_middle = calloc(length_input1 + length_input2 - 1, sizeof(int));
-
-    // Seperate the polynomials into highs and lows
-    memcpy(low1, input1, half_length * sizeof(int));
-    memcpy(low2, input2, half_length * sizeof(int));
-    memcpy(high1, input1 + half_length,
-            (length_input1 - half_length1) * sizeof(int));
-    memcpy(high2, input2 + half_length,
-            (length_input2 - half_length2) * sizeof(int));
-    
-    // First 2 recursive calls
-    Karatsuba_Polynomial(low1, low2, half_length, half_length, result_low);
-    Karatsuba_Polynomial(high1, high2, half_length, half_length, result_high);
+    // Views into the scratch memory
+    int *sum1 = scratch;
+    int *sum2 = sum1 + half_length;
+    int *result_middle = sum2 + half_length;  // 2 * half_length - 1 values
+    int *next_scratch = result_middle + 2 * half_length;
+
+    // result_low = low1 * low2 goes to the bottom of result and
+    // result_high = high1 * high2 from 2 * half_length, everything between
+    // and above them is cleared first
+    memset(result, 0, max_length * sizeof(int));
+    Karatsuba_Polynomial_ext(input1, input2, low_length1, low_length2, result,
+                                next_scratch, cutoff);
+    int low_result_length = low_length1 + low_length2 - 1;
+    int high_result_length = 0;
+    if (high_length1 > 0 && high_length2 > 0) {
+        high_result_length = high_length1 + high_length2 - 1;
+        Karatsuba_Polynomial_ext(input1 + half_length, input2 + half_length,
+                                    high_length1, high_length2,
+                                    result + 2 * half_length, next_scratch, cutoff);
+    }
 
     // Third recursive call
     // long long product_middle  = karatsuba(low1 + high1, low2 + high2);
-    int *temp1 = calloc(half_length, sizeof(int));
-    int *temp2 = calloc(half_length, sizeof(int));
-    Array_Addition(low1, high1, half_length, temp1);
-    Array_Addition(low2, high2, half_length, temp2);
-    Karatsuba_Polynomial(temp1, temp2, half_length, half_length, result_middle);
+    // The missing values of short halves count as zero
+    for (int i = 0; i < half_length; i++) {
+        sum1[i] = ((i < low_length1) ? input1[i] : 0) +
+                    ((i < high_length1) ? input1[half_length + i] : 0);
+        sum2[i] = ((i < low_length2) ? input2[i] : 0) +
+                    ((i < high_length2) ? input2[half_length + i] : 0);
+    }
+    Karatsuba_Polynomial_ext(sum1, sum2, half_length, half_length,
+                                result_middle, next_scratch, cutoff);
 
     // Calculate middle coefficients (result_middle = result_middle - result_low - result_high)
-    Array_Subtraction(result_middle, result_low, length_input1 + length_input2
-                        - 1, result_middle);
-    Array_Subtraction(result_middle, result_high, length_input1 + length_input2
-                        - 1, result_middle);
+    Array_Subtraction(result_middle, result, low_result_length, result_middle);
+    Array_Subtraction(result_middle, result + 2 * half_length,
+                        high_result_length, result_middle);
 
     // Assemble final result
-    // result = result_low + (result_middle << half_length1) + (result_high << (half_length1 * 2))
-    int max_length = length_input1 + length_input2 - 1;
+    // result = result_low + (result_middle << half_length) + (result_high << (half_length * 2))
+    // The low and high parts are already in place, and the middle part is zero
+    // beyond the length of the product
+    int middle_length = 2 * half_length - 1;
+    if (middle_length > max_length - half_length) {
+        middle_length = max_length - half_length;
+    }
+    for (int i = 0; i < middle_length; i++) {
+        result[half_length + i] += result_middle[i];
+    }
+}
+
+// Karatsuba multiplication for polynomials
+void Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
+                            int length_input2, int *result) {
+    // Allocate the scratch memory of the whole recursion once
+    int cutoff = karatsuba_cutoff;
+    // Fork the top levels over several threads for long inputs
+    if (Use_Parallel_Karatsuba(length_input1, length_input2)) {
+        Parallel_Karatsuba_Polynomial(input1, input2, length_input1, length_input2,
+                                        result, cutoff);
+        return;
+    }
+    int *scratch = (int *)malloc(Karatsuba_Scratch_Size(length_input1, length_input2,
+                                    cutoff) * sizeof(int) + sizeof(int));
+    Karatsuba_Polynomial_ext(input1, input2, length_input1, length_input2, result,
+                                scratch, cutoff);
+    free(scratch);
+}
+
 
-    for (int i = 0; i < max_length; i++) {
-        result[i] = result_low[i];  // Set result to low part
+// Karatsuba squaring, the three products of a square are squares too:
+//     (low + high * x)^2 = low^2 + ((low + high)^2 - low^2 - high^2) * x + high^2 * x^2
+// so the recursion only ever has one input and the base case is
+// Array_Square. Same layout of result and scratch as Karatsuba_Polynomial_ext
+void Karatsuba_Square_ext(int *input, int length, int *result, int *scratch, int cutoff) {
+    if (length <= cutoff) {
+        Array_Square(input, length, result);
+        return;
+    }
+    int half_length = (length + 1) >> 1;
+    int high_length = length - half_length;
+    int max_length = 2 * length - 1;
 
-        // Add middle part if within its valid range
-        if (i >= half_length) {
-            result[i] += result_middle[i - half_length];
-        }
+    int *sum = scratch;
+    int *result_middle = sum + half_length;  // 2 * half_length - 1 values
+    int *next_scratch = result_middle + 2 * half_length;
 
-        // Add high part if within its valid range
-        if (i >= 2 * half_length) {
-            result[i] += result_high[i - 2 * half_length];
-        }
+    memset(result, 0, max_length * sizeof(int));
+    Karatsuba_Square_ext(input, half_length, result, next_scratch, cutoff);
+    Karatsuba_Square_ext(input + half_length, high_length, result + 2 * half_length,
+                            next_scratch, cutoff);
+
+    for (int i = 0; i < half_length; i++) {
+        sum[i] = input[i] + ((i < high_length) ? input[half_length + i] : 0);
     }
-    free(low1);
-    free(low2);
-    free(high1);
-    free(high2);
-    free(result_low);
-    free(result_middle);
-    free(result_high);
-    free(temp1);
-    free(temp2);
-}
+    Karatsuba_Square_ext(sum, half_length, result_middle, next_scratch, cutoff);
 
+    Array_Subtraction(result_middle, result, 2 * half_length - 1, result_middle);
+    Array_Subtraction(result_middle, result + 2 * half_length, 2 * high_length - 1,
+                        result_middle);
+
+    int middle_length = 2 * half_length - 1;
+    if (middle_length > max_length - half_length) {
+        middle_length = max_length - half_length;
+    }
+    for (int i = 0; i < middle_length; i++) {
+        result[half_length + i] += result_middle[i];
+    }
+}
 
 double polynomial_multiply_karatsuba(mpz_t a, mpz_t b, int n, int* karatsuba_total_result) {
-    
+    return polynomial_multiply_karatsuba_ctx(a, b, n, karatsuba_total_result,
+                                                Get_Default_Multiply_Context(n));
+}
 
-    int padded_a[n], padded_b[n], karatsuba_result[n];
+double polynomial_multiply_karatsuba_ctx(mpz_t a, mpz_t b, int n,
+                                            int* karatsuba_total_result,
+                                            Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int *padded_a = (int *)Context_Buffer(context, 0, context->max_n * sizeof(int));
+    int *padded_b = (int *)Context_Buffer(context, 1, context->max_n * sizeof(int));
 
     memset(padded_a, 0, n * sizeof(int));
     memset(padded_b, 0, n * sizeof(int));
-    memset(karatsuba_result, 0, n * sizeof(int));
 
     int length_input1 = mpz_to_int_array(a, padded_a); // Assume correct implementation
     int length_input2 = mpz_to_int_array(b, padded_b);
+    // Scratch memory for the recursion, sized for the largest inputs so the
+    // slot is allocated only once per cutoff
+    int cutoff = karatsuba_cutoff;
+    int *scratch = (int *)Context_Buffer(context, 2,
+                        (Karatsuba_Scratch_Size(context->max_n, context->max_n,
+                                                cutoff) + 1) * sizeof(int));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (Use_Parallel_Karatsuba(length_input1, length_input2)) {
+        // The threads need their own scratch, Parallel_Karatsuba_Polynomial
+        // allocates it
+        Parallel_Karatsuba_Polynomial(padded_a, padded_b, length_input1, length_input2,
+                                        karatsuba_total_result, cutoff);
+    } else {
+        Karatsuba_Polynomial_ext(padded_a, padded_b, length_input1, length_input2,
+                                    karatsuba_total_result, scratch, cutoff);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    return elapsed_time;
+}
+
+
+double polynomial_square_karatsuba(mpz_t a, int n, int* karatsuba_total_result) {
+    return polynomial_square_karatsuba_ctx(a, n, karatsuba_total_result,
+                                            Get_Default_Multiply_Context(n));
+}
+
+double polynomial_square_karatsuba_ctx(mpz_t a, int n, int* karatsuba_total_result,
+                                        Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int *padded = (int *)Context_Buffer(context, 0, context->max_n * sizeof(int));
+    memset(padded, 0, n * sizeof(int));
+
+    int length = mpz_to_int_array(a, padded);
+    int cutoff = karatsuba_cutoff;
+    int *scratch = (int *)Context_Buffer(context, 2,
+                        (Karatsuba_Scratch_Size(context->max_n, context->max_n,
+                                                cutoff) + 1) * sizeof(int));
 
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
-    Karatsuba_Polynomial(padded_a, padded_b, length_input1, length_input2,
-                        karatsuba_total_result);
+    if (Use_Parallel_Karatsuba(length, length)) {
+        // Spreading the recursion over the threads gains more than the
+        // squares save
+        Parallel_Karatsuba_Polynomial(padded, padded, length, length,
+                                        karatsuba_total_result, cutoff);
+    } else {
+        Karatsuba_Square_ext(padded, length, karatsuba_total_result, scratch, cutoff);
+    }
     clock_gettime(CLOCK_MONOTONIC, &end);
     double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
 
@@ -2,6 +2,7 @@
 #define karatsuba_H
 #include "Helper_Functions.h"
 #include "Naive_Polynomial_Multiplication.h"
+#include "multiply_context.h"
 
 //PseudoCode from Wiki
 
@@ -28,6 +29,34 @@
 
 void karatsuba(mpz_t num1, mpz_t num2, mpz_t karatsuba_result);
 
+// Default length at or below which Karatsuba_Polynomial multiplies with the
+// schoolbook method, see test/karatsuba_optimisation.c for how it was found.
+// test/threshold_tuning.c measures it for the host
+#define KARATSUBA_CUTOFF 250
+
+// Cutoff used by Karatsuba_Polynomial and polynomial_multiply_karatsuba,
+// 0 sets it back to KARATSUBA_CUTOFF
+void Set_Karatsuba_Cutoff(int cutoff);
+
+int Get_Karatsuba_Cutoff();
+
+// Number of int values of scratch memory Karatsuba_Polynomial_ext needs
+int Karatsuba_Scratch_Size(int length_input1, int length_input2, int cutoff);
+
+// Karatsuba multiplication of two polynomials into result
+// (length_input1 + length_input2 - 1 values) with scratch memory of
+// Karatsuba_Scratch_Size values instead of allocations in the recursion
+void Karatsuba_Polynomial_ext(int *input1, int *input2, int length_input1,
+                                int length_input2, int *result, int *scratch,
+                                int cutoff);
+
+// Same, allocates the scratch memory
+void Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
+                            int length_input2, int *result);
+
+// Karatsuba_Polynomial_ext of input with itself, result holds 2 * length - 1
+// values and scratch Karatsuba_Scratch_Size(length, length, cutoff) values
+void Karatsuba_Square_ext(int *input, int length, int *result, int *scratch, int cutoff);
 
 // void Karatsuba_Recursive(int *input1, int *input2, int degree, int *result, int *temp_storage) ;
 
@@ -35,4 +64,15 @@ void Karatsuba_Multiply(int *input1, int *input2, int degree, int *result);
 
 double polynomial_multiply_karatsuba(mpz_t a, mpz_t b, int n,
                                     int* karatsuba_total_result) ;
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_karatsuba_ctx(mpz_t a, mpz_t b, int n,
+                                            int* karatsuba_total_result,
+                                            Multiply_Context *context);
+
+// The digits of a * a with Karatsuba_Square_ext
+double polynomial_square_karatsuba(mpz_t a, int n, int* karatsuba_total_result);
+
+double polynomial_square_karatsuba_ctx(mpz_t a, int n, int* karatsuba_total_result,
+                                        Multiply_Context *context);
 #endif
\ No newline at end of file
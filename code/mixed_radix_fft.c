@@ -0,0 +1,321 @@
+#include "mixed_radix_fft.h"
+
+// Plans created by Get_Mixed_Radix_Plan. The sizes are not powers of two,
+// so the cache is a list searched by n instead of an array indexed by log2(n)
+static Mixed_Radix_Plan *mixed_radix_plan_cache = NULL;
+static pthread_mutex_t mixed_radix_plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+bool Is_Smooth_Size(int n) {
+    if (n <= 0) {
+        return false;
+    }
+    int primes[4] = {2, 3, 5, 7};
+    for (int i = 0; i < 4; i++) {
+        while (n % primes[i] == 0) {
+            n /= primes[i];
+        }
+    }
+    return n == 1;
+}
+
+int Next_Smooth_Size(int length) {
+    if (length <= 1) {
+        return 1;
+    }
+    // Every 7-smooth number is 2^a times an odd 7-smooth number, so for each
+    // odd one the smallest power of two that reaches length is enough. There
+    // are only a few thousand odd 7-smooth numbers below INT_MAX
+    long long best = 1LL << 31;
+    for (long long p7 = 1; p7 < best; p7 *= 7) {
+        for (long long p5 = p7; p5 < best; p5 *= 5) {
+            for (long long p3 = p5; p3 < best; p3 *= 3) {
+                long long size = p3;
+                while (size < length) {
+                    size <<= 1;
+                }
+                if (size < best) {
+                    best = size;
+                }
+            }
+        }
+    }
+    return (int)best;
+}
+
+Mixed_Radix_Plan *Mixed_Radix_Plan_Create(int n) {
+    assert(Is_Smooth_Size(n));
+    Mixed_Radix_Plan *plan = (Mixed_Radix_Plan *)malloc(sizeof(Mixed_Radix_Plan));
+    plan->n = n;
+    plan->next = NULL;
+    plan->twiddles = (complex double *)malloc(n * sizeof(complex double));
+    plan->work = (complex double *)malloc(n * sizeof(complex double));
+
+    // Pairs of 2 become radix 4 stages, a single 2 is left for radix 2
+    plan->factor_count = 0;
+    int rest = n;
+    while (rest % 4 == 0) {
+        plan->factors[plan->factor_count++] = 4;
+        rest /= 4;
+    }
+    int primes[4] = {2, 3, 5, 7};
+    for (int i = 0; i < 4; i++) {
+        while (rest % primes[i] == 0) {
+            plan->factors[plan->factor_count++] = primes[i];
+            rest /= primes[i];
+        }
+    }
+
+    // Every twiddle is computed directly, see FFT_Plan_Create
+    for (int k = 0; k < n; k++) {
+        plan->twiddles[k] = cexp(-I * TAU * k / n);
+    }
+    return plan;
+}
+
+void Mixed_Radix_Plan_Free(Mixed_Radix_Plan *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->twiddles);
+    free(plan->work);
+    free(plan);
+}
+
+Mixed_Radix_Plan *Get_Mixed_Radix_Plan(int n) {
+    pthread_mutex_lock(&mixed_radix_plan_cache_lock);
+    Mixed_Radix_Plan *plan = mixed_radix_plan_cache;
+    while (plan != NULL && plan->n != n) {
+        plan = plan->next;
+    }
+    if (plan == NULL) {
+        plan = Mixed_Radix_Plan_Create(n);
+        plan->next = mixed_radix_plan_cache;
+        mixed_radix_plan_cache = plan;
+    }
+    pthread_mutex_unlock(&mixed_radix_plan_cache_lock);
+    return plan;
+}
+
+void Free_Mixed_Radix_Plan_Cache() {
+    pthread_mutex_lock(&mixed_radix_plan_cache_lock);
+    while (mixed_radix_plan_cache != NULL) {
+        Mixed_Radix_Plan *next = mixed_radix_plan_cache->next;
+        Mixed_Radix_Plan_Free(mixed_radix_plan_cache);
+        mixed_radix_plan_cache = next;
+    }
+    pthread_mutex_unlock(&mixed_radix_plan_cache_lock);
+}
+
+// z * -i for the forward transform and z * i for the inverse, without a
+// complex multiplication
+static inline complex double Rotate(complex double z, bool inverse) {
+    return inverse ? -cimag(z) + creal(z) * I : cimag(z) - creal(z) * I;
+}
+
+// a * b without the NaN and infinity checks of the C complex multiplication,
+// which cost a branch and keep the compiler from vectorising the butterflies
+static inline complex double Multiply(complex double a, complex double b) {
+    return (creal(a) * creal(b) - cimag(a) * cimag(b)) +
+            (creal(a) * cimag(b) + cimag(a) * creal(b)) * I;
+}
+
+// The butterflies of one p of a stage for every q < count. Input t of
+// butterfly q is x[q + t * x_step], output r goes to y[q + r * count] after
+// the multiplication with twiddle w[r]
+
+static void Butterfly_2(const complex double *x, int x_step, complex double *y,
+                        const complex double *w, int count) {
+    complex double a, b;
+    for (int q = 0; q < count; q++) {
+        a = x[q];
+        b = x[q + x_step];
+        y[q] = a + b;
+        y[q + count] = Multiply(a - b, w[1]);
+    }
+}
+
+static void Butterfly_4(const complex double *x, int x_step, complex double *y,
+                        const complex double *w, int count, bool inverse) {
+    complex double sum02, difference02, sum13, difference13;
+    for (int q = 0; q < count; q++) {
+        sum02 = x[q] + x[q + 2 * x_step];
+        difference02 = x[q] - x[q + 2 * x_step];
+        sum13 = x[q + x_step] + x[q + 3 * x_step];
+        difference13 = Rotate(x[q + x_step] - x[q + 3 * x_step], inverse);
+        y[q] = sum02 + sum13;
+        y[q + count] = Multiply(difference02 + difference13, w[1]);
+        y[q + 2 * count] = Multiply(sum02 - sum13, w[2]);
+        y[q + 3 * count] = Multiply(difference02 - difference13, w[3]);
+    }
+}
+
+// Radix 3, 5 and 7. With c_k = cos(TAU*k/radix) and s_k = sin(TAU*k/radix)
+// the inputs t and radix - t only appear as
+//     x_t * e^{-i*TAU*r*t/radix} + x_{radix-t} * e^{i*TAU*r*t/radix}
+//         = c_rt * (x_t + x_{radix-t}) - i * s_rt * (x_t - x_{radix-t})
+// and the outputs r and radix - r only differ in the sign of the second term
+static void Butterfly_Odd(const complex double *x, int x_step, complex double *y,
+                            const complex double *w, int count, int radix,
+                            const double *cosine, const double *sine, bool inverse) {
+    int half = radix >> 1;
+    complex double sum[4], difference[4], real_part, imaginary_part, first;
+    for (int q = 0; q < count; q++) {
+        first = x[q];
+        complex double total = first;
+        for (int t = 1; t <= half; t++) {
+            complex double a = x[q + t * x_step];
+            complex double b = x[q + (radix - t) * x_step];
+            sum[t] = a + b;
+            difference[t] = a - b;
+            total += sum[t];
+        }
+        y[q] = total;
+        for (int r = 1; r <= half; r++) {
+            real_part = first;
+            imaginary_part = 0;
+            for (int t = 1; t <= half; t++) {
+                int k = (r * t) % radix;
+                real_part += cosine[k] * sum[t];
+                imaginary_part += sine[k] * difference[t];
+            }
+            imaginary_part = Rotate(imaginary_part, inverse);
+            y[q + r * count] = Multiply(real_part + imaginary_part, w[r]);
+            y[q + (radix - r) * count] = Multiply(real_part - imaginary_part, w[radix - r]);
+        }
+    }
+}
+
+static void Mixed_Radix_Transform(Mixed_Radix_Plan *plan, complex double *input,
+                                    complex double *output, bool inverse) {
+    int n = plan->n;
+    if (n == 1) {
+        output[0] = input[0];
+        return;
+    }
+
+    // As in Stockham_Transform the last stage has to write into output. An
+    // odd number of stages starts by writing into output, which would
+    // overwrite an in place input before it is read, so it is moved to the
+    // work buffer first
+    complex double *x = input;
+    if (input == output && (plan->factor_count & 1)) {
+        memcpy(plan->work, input, n * sizeof(complex double));
+        x = plan->work;
+    }
+    complex double *y = (plan->factor_count & 1) ? output : plan->work;
+    complex double *other = (y == output) ? plan->work : output;
+
+    complex double w[7];
+    double cosine[7], sine[7];
+    int stride = 1;
+    for (int stage = 0; stage < plan->factor_count; stage++) {
+        int radix = plan->factors[stage];
+        int m = n / (stride * radix);
+        for (int k = 0; k < radix; k++) {
+            cosine[k] = cos(TAU * k / radix);
+            sine[k] = sin(TAU * k / radix);
+        }
+        for (int p = 0; p < m; p++) {
+            // e^{-i*TAU*r*p/(radix*m)} is plan twiddle r * p * stride, which
+            // is below n since r < radix and p < m
+            for (int r = 1; r < radix; r++) {
+                w[r] = plan->twiddles[r * p * stride];
+                if (inverse) {
+                    w[r] = conj(w[r]);
+                }
+            }
+            const complex double *x_p = x + stride * p;
+            complex double *y_p = y + stride * radix * p;
+            switch (radix) {
+            case 2:
+                Butterfly_2(x_p, stride * m, y_p, w, stride);
+                break;
+            case 4:
+                Butterfly_4(x_p, stride * m, y_p, w, stride, inverse);
+                break;
+            default:
+                Butterfly_Odd(x_p, stride * m, y_p, w, stride, radix, cosine, sine,
+                                inverse);
+                break;
+            }
+        }
+        // The output of this stage is the input of the next one
+        x = y;
+        y = other;
+        other = x;
+        stride *= radix;
+    }
+}
+
+void Mixed_Radix_FFT(complex double *input, int n, complex double *output) {
+    Mixed_Radix_Transform(Get_Mixed_Radix_Plan(n), input, output, false);
+}
+
+void Mixed_Radix_IFFT(complex double *input, int n, complex double *output) {
+    Mixed_Radix_Transform(Get_Mixed_Radix_Plan(n), input, output, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < n; i++) {
+        output[i] /= n;
+    }
+}
+
+
+double polynomial_multiply_mixed_radix(mpz_t a, mpz_t b, int n,
+                                        int* mixed_radix_total_result) {
+    return polynomial_multiply_mixed_radix_ctx(a, b, n, mixed_radix_total_result,
+                                                Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_mixed_radix_ctx(mpz_t a, mpz_t b, int n,
+                                            int* mixed_radix_total_result,
+                                            Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int max_n = context->max_n;
+
+    // a in the real part and b in the imaginary part, as in
+    // polynomial_multiply_iterative_FFT_ctx
+    complex double *packed = (complex double *)Context_Buffer(context, 0,
+                                max_n * sizeof(complex double));
+    complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                max_n * sizeof(complex double));
+    complex double *work = (complex double *)Context_Buffer(context, 2,
+                            max_n * sizeof(complex double));
+    double *fft_result = (double *)Context_Buffer(context, 3, max_n * sizeof(double));
+    memset(packed, 0, n * sizeof(complex double));
+
+    int length_input1 = mpz_to_double_array(a, (double *)packed, 2);
+    int length_input2 = mpz_to_double_array(b, (double *)packed + 1, 2);
+
+    // The product has length_input1 + length_input2 - 1 coefficients, a
+    // transform of at least that length has no wrap around. The size is kept
+    // even so the inverse can be the real IFFT of half the length. n / 2 is
+    // a power of two above half the product, so size never exceeds n
+    int size = 2 * Next_Smooth_Size((length_input1 + length_input2) >> 1);
+    if (size > n) {
+        size = n;
+    }
+    Mixed_Radix_Plan *plan = Get_Mixed_Radix_Plan(size);
+    Get_Mixed_Radix_Plan(size >> 1);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Mixed_Radix_FFT(packed, size, spectrum);
+    Packed_Real_Product(spectrum, size);
+    // The twiddles of the real IFFT come from the plan of the full size
+    Real_IFFT_ext(Mixed_Radix_IFFT, spectrum, size, fft_result, work, plan->twiddles);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    // The coefficients past size are zero. A product that came too close
+    // to a rounding error is redone exactly
+    memset(mixed_radix_total_result + size, 0, (n - size) * sizeof(int));
+    if (!Round_FFT_Result(fft_result, size, mixed_radix_total_result)) {
+        elapsed_time += Exact_Fallback_Multiply(a, b, n, mixed_radix_total_result, context);
+    }
+
+    return elapsed_time;
+}
@@ -0,0 +1,76 @@
+#ifndef MIXED_RADIX_FFT_H
+#define MIXED_RADIX_FFT_H
+#include <pthread.h>
+#include "Helper_Functions.h"
+#include "multiply_context.h"
+#include "fft_rounding.h"
+#include "real_fft.h"
+
+// Mixed-radix FFT for lengths n = 2^a * 3^b * 5^c * 7^d
+// The other transforms only take n = 2^m, so a product of 2^k + 1
+// coefficients is padded to 2^(k+1), almost twice the work it needs. The
+// 7-smooth numbers are much denser: the smallest one above a length is on
+// average only a few percent larger, e.g. 1025 -> 1029 = 3 * 7^3.
+//
+// The transform is the Stockham autosort FFT of stockham_fft.h with one
+// stage per prime factor instead of per factor 2. With n = radix * m * stride
+// for the stage of radix p, stride the product of the earlier radices and
+// w = e^{-i*TAU/n}:
+//     y[q + stride*(radix*p + r)] = w^{r*p*stride} *
+//                     sum_t x[q + stride*(p + t*m)] * e^{-i*TAU*r*t/radix}
+// for p < m, q < stride and r, t < radix. The result ends up in natural
+// order without a permutation pass. Factors of 2 are paired into radix 4
+// butterflies, which need no multiplications, and the odd radices 3, 5 and
+// 7 use the symmetry of the roots of unity to compute the outputs r and
+// radix - r together from the sums and differences of the inputs t and
+// radix - t, which halves their multiplications.
+
+// Most stages of a plan, enough for every int n
+#define MIXED_RADIX_MAX_FACTORS 32
+
+typedef struct Mixed_Radix_Plan {
+    int n;
+    int factor_count;
+    int factors[MIXED_RADIX_MAX_FACTORS];   // Radix of every stage, 2, 3, 4, 5 or 7
+    complex double *twiddles;               // e^{-i*TAU*k/n} for k = 0 .. n - 1
+    // Second buffer of the ping-pong, so one plan must not be executed by
+    // two threads at the same time
+    complex double *work;
+    struct Mixed_Radix_Plan *next;          // Next plan in the cache
+} Mixed_Radix_Plan;
+
+// True if n is a positive number without prime factors above 7
+bool Is_Smooth_Size(int n);
+
+// The smallest 2^a * 3^b * 5^c * 7^d that is at least length
+int Next_Smooth_Size(int length);
+
+// n must satisfy Is_Smooth_Size
+Mixed_Radix_Plan *Mixed_Radix_Plan_Create(int n);
+
+void Mixed_Radix_Plan_Free(Mixed_Radix_Plan *plan);
+
+// Cached plan for size n, created on first use
+Mixed_Radix_Plan *Get_Mixed_Radix_Plan(int n);
+
+void Free_Mixed_Radix_Plan_Cache();
+
+// Same signature as Iterative_FFT, for any n with Is_Smooth_Size.
+// input and output may be the same array
+void Mixed_Radix_FFT(complex double *input, int n, complex double *output);
+
+// Inverse transform, normalized by 1/n
+void Mixed_Radix_IFFT(complex double *input, int n, complex double *output);
+
+// Polynomial multiplication with a transform of the smallest even 7-smooth
+// size of at least len1 + len2 - 1 instead of n, where len1 and len2 are the
+// digit counts of a and b. As in polynomial_multiply_iterative_FFT both
+// operands share one complex transform and the inverse is a real IFFT
+double polynomial_multiply_mixed_radix(mpz_t a, mpz_t b, int n, int* mixed_radix_total_result);
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_mixed_radix_ctx(mpz_t a, mpz_t b, int n,
+                                            int* mixed_radix_total_result,
+                                            Multiply_Context *context);
+
+#endif
@@ -0,0 +1,52 @@
+#include "multiply_context.h"
+
+static Multiply_Context *default_context = NULL;
+
+
+Multiply_Context *Multiply_Context_Create(int max_n) {
+    Multiply_Context *context = (Multiply_Context *)calloc(1, sizeof(Multiply_Context));
+    context->max_n = max_n;
+    return context;
+}
+
+void Multiply_Context_Free(Multiply_Context *context) {
+    if (context == NULL) {
+        return;
+    }
+    for (int i = 0; i < CONTEXT_SLOTS; i++) {
+        free(context->slots[i]);
+    }
+    free(context);
+}
+
+void *Context_Buffer(Multiply_Context *context, int slot, size_t bytes) {
+    if (context->slot_bytes[slot] < bytes) {
+        // The old content does not have to be kept, so free and allocate
+        // instead of a realloc that would copy it
+        free(context->slots[slot]);
+        void *memory = NULL;
+        if (posix_memalign(&memory, 64, bytes) != 0) {
+            // The callers use the buffer without a check, like every malloc
+            // of the program, so stop here with a message instead of a
+            // segfault further on
+            fprintf(stderr, "Out of memory for a buffer of %zu bytes\n", bytes);
+            exit(1);
+        }
+        context->slots[slot] = memory;
+        context->slot_bytes[slot] = bytes;
+    }
+    return context->slots[slot];
+}
+
+Multiply_Context *Get_Default_Multiply_Context(int n) {
+    if (default_context == NULL || default_context->max_n < n) {
+        Multiply_Context_Free(default_context);
+        default_context = Multiply_Context_Create(n);
+    }
+    return default_context;
+}
+
+void Free_Default_Multiply_Context() {
+    Multiply_Context_Free(default_context);
+    default_context = NULL;
+}
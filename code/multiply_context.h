@@ -0,0 +1,40 @@
+#ifndef MULTIPLY_CONTEXT_H
+#define MULTIPLY_CONTEXT_H
+#include "Helper_Functions.h"
+
+// Scratch memory for the polynomial_multiply_* functions
+// Each multiplication needs a handful of arrays of n values. As variable
+// length arrays on the stack they overflow the stack from about n = 2^17,
+// and allocating them on every call costs a malloc and page faults per
+// call. A context owns a few heap buffers (slots) that are sized for a
+// maximum n on first use and then reused by every call, so repeated
+// multiplications allocate nothing. Every engine picks the slots it needs,
+// one engine call never runs at the same time as another on the same
+// context, so a context must not be shared between threads.
+
+#define CONTEXT_SLOTS 8
+
+typedef struct {
+    int max_n;                      // Largest n the context is used for
+    void *slots[CONTEXT_SLOTS];     // Buffers, NULL until first used
+    size_t slot_bytes[CONTEXT_SLOTS];
+} Multiply_Context;
+
+Multiply_Context *Multiply_Context_Create(int max_n);
+
+void Multiply_Context_Free(Multiply_Context *context);
+
+// Slot slot as a buffer of at least bytes bytes, aligned to a 64 byte
+// cache line. The engines ask for sizes based on max_n, so the buffer is
+// allocated on the first call and returned as it is afterwards. The content
+// is not kept between calls. Exits the program if the memory can not be
+// allocated, so the result is never NULL
+void *Context_Buffer(Multiply_Context *context, int slot, size_t bytes);
+
+// The context used by the polynomial_multiply_* functions without a context
+// argument. It is replaced by a larger one when n is above its max_n
+Multiply_Context *Get_Default_Multiply_Context(int n);
+
+void Free_Default_Multiply_Context();
+
+#endif
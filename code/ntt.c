@@ -0,0 +1,467 @@
+#include "ntt.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NTT_SIMD_X86
+#endif
+
+// 15 * 2^27 + 1, 7 * 2^26 + 1 and 5 * 2^25 + 1, the Montgomery constants
+// are filled in on first use
+static NTT_Prime ntt_primes[NTT_MAX_PRIMES] = {
+    {2013265921u, 31, 27, 0, 0},
+    {469762049u, 3, 26, 0, 0},
+    {167772161u, 3, 25, 0, 0}
+};
+static pthread_once_t ntt_primes_once = PTHREAD_ONCE_INIT;
+
+// Plans created by Get_NTT_Plan, indexed by prime and log2(n)
+static NTT_Plan *ntt_plan_cache[NTT_MAX_PRIMES][32];
+
+// Guards ntt_plan_cache, so threads can ask for plans at the same time
+static pthread_mutex_t ntt_plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// A stage kernel does every butterfly of the stage with half segment length
+// half, roots points at the roots of that stage
+typedef void (*NTT_Stage_Kernel)(uint32_t *values, const uint32_t *roots, int n,
+                                    int half, const NTT_Prime *prime);
+
+static NTT_Stage_Kernel ntt_stage_kernel = NULL;
+static int ntt_stage_kernel_width = 1; // Values per vector of the kernel
+// The default kernel is selected once, before the first transform or the
+// first Set_NTT_Vector_Kernel
+static pthread_once_t ntt_kernel_once = PTHREAD_ONCE_INIT;
+
+
+static uint32_t Power_Mod(uint32_t base, uint64_t exponent, uint32_t p) {
+    uint64_t result = 1, square = base % p;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = result * square % p;
+        }
+        square = square * square % p;
+        exponent >>= 1;
+    }
+    return (uint32_t)result;
+}
+
+static void Init_NTT_Primes() {
+    for (int i = 0; i < NTT_MAX_PRIMES; i++) {
+        uint32_t p = ntt_primes[i].p;
+        // Newton iteration for p^{-1} mod 2^32, every step doubles the
+        // number of correct low bits and p * p = 1 mod 8 gives 3 to start
+        uint32_t inverse = p;
+        for (int step = 0; step < 4; step++) {
+            inverse *= 2 - p * inverse;
+        }
+        ntt_primes[i].p_inv = -inverse;
+        uint64_t r = ((uint64_t)1 << 32) % p;
+        ntt_primes[i].r2 = (uint32_t)(r * r % p);
+    }
+}
+
+const NTT_Prime *Get_NTT_Prime(int index) {
+    pthread_once(&ntt_primes_once, Init_NTT_Primes);
+    return &ntt_primes[index];
+}
+
+// a * b * R^{-1} mod p for a * b < p * R, the sum a*b + q*p stays below 2^63
+// since p < 2^31
+static inline uint32_t Montgomery_Multiply(uint32_t a, uint32_t b,
+                                            const NTT_Prime *prime) {
+    uint64_t product = (uint64_t)a * b;
+    uint32_t q = (uint32_t)product * prime->p_inv;
+    uint32_t result = (uint32_t)((product + (uint64_t)q * prime->p) >> 32);
+    return (result >= prime->p) ? result - prime->p : result;
+}
+
+static inline uint32_t To_Montgomery(uint32_t a, const NTT_Prime *prime) {
+    return Montgomery_Multiply(a, prime->r2, prime);
+}
+
+static inline uint32_t Add_Mod(uint32_t a, uint32_t b, uint32_t p) {
+    uint32_t sum = a + b;
+    return (sum >= p) ? sum - p : sum;
+}
+
+static inline uint32_t Sub_Mod(uint32_t a, uint32_t b, uint32_t p) {
+    return (a >= b) ? a - b : a + p - b;
+}
+
+
+NTT_Plan *NTT_Plan_Create(int n, int prime_index) {
+    const NTT_Prime *prime = Get_NTT_Prime(prime_index);
+    assert((n >> prime->max_log2n) <= 1);
+
+    NTT_Plan *plan = (NTT_Plan *)malloc(sizeof(NTT_Plan));
+    plan->n = n;
+    plan->prime = prime;
+    plan->plan = Get_FFT_Plan(n);
+    plan->roots = (uint32_t *)malloc(n * sizeof(uint32_t));
+    plan->inverse_roots = (uint32_t *)malloc(n * sizeof(uint32_t));
+
+    // The stage with half segment length h needs a primitive 2h'th root of
+    // unity, g^((p-1)/2h). Its powers are exact so the running product
+    // has no rounding error to gather, unlike the complex twiddles
+    uint32_t p = prime->p;
+    for (int half = 1; half < n; half <<= 1) {
+        uint32_t w = Power_Mod(prime->generator, (p - 1) / (2 * half), p);
+        uint32_t w_inverse = Power_Mod(w, p - 2, p);
+        uint64_t power = 1, inverse_power = 1;
+        for (int j = 0; j < half; j++) {
+            plan->roots[half - 1 + j] = To_Montgomery((uint32_t)power, prime);
+            plan->inverse_roots[half - 1 + j] = To_Montgomery((uint32_t)inverse_power,
+                                                                prime);
+            power = power * w % p;
+            inverse_power = inverse_power * w_inverse % p;
+        }
+    }
+    plan->n_inverse = To_Montgomery(Power_Mod(n, p - 2, p), prime);
+    return plan;
+}
+
+void NTT_Plan_Free(NTT_Plan *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->roots);
+    free(plan->inverse_roots);
+    free(plan);
+}
+
+NTT_Plan *Get_NTT_Plan(int n, int prime_index) {
+    int log2n = log2(n);
+    pthread_mutex_lock(&ntt_plan_cache_lock);
+    if (ntt_plan_cache[prime_index][log2n] == NULL) {
+        ntt_plan_cache[prime_index][log2n] = NTT_Plan_Create(n, prime_index);
+    }
+    NTT_Plan *plan = ntt_plan_cache[prime_index][log2n];
+    pthread_mutex_unlock(&ntt_plan_cache_lock);
+    return plan;
+}
+
+
+// Reference kernel, also used for the first stages where the half segment
+// is shorter than a vector
+static void NTT_Stage_Scalar(uint32_t *values, const uint32_t *roots, int n,
+                                int half, const NTT_Prime *prime) {
+    uint32_t p = prime->p, t, u;
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j++) {
+            int top = k + j, bottom = k + j + half;
+            t = Montgomery_Multiply(roots[j], values[bottom], prime);
+            u = values[top];
+            values[top] = Add_Mod(u, t, p);
+            values[bottom] = Sub_Mod(u, t, p);
+        }
+    }
+}
+
+#ifdef NTT_SIMD_X86
+// _mm256_mul_epu32 multiplies the even 32 bit lanes into 64 bit products, so
+// the even and the odd lanes are reduced separately and blended together.
+// The conditional subtractions are unsigned minimums: if x < p then x - p
+// wraps around to a larger value and min(x, x - p) = x
+__attribute__((target("avx2")))
+static inline __m256i Montgomery_Multiply_AVX2(__m256i a, __m256i b, __m256i p,
+                                                __m256i p_inv) {
+    __m256i product_even = _mm256_mul_epu32(a, b);
+    __m256i product_odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32),
+                                            _mm256_srli_epi64(b, 32));
+    __m256i q_even = _mm256_mul_epu32(product_even, p_inv);
+    __m256i q_odd = _mm256_mul_epu32(product_odd, p_inv);
+    __m256i sum_even = _mm256_add_epi64(product_even, _mm256_mul_epu32(q_even, p));
+    __m256i sum_odd = _mm256_add_epi64(product_odd, _mm256_mul_epu32(q_odd, p));
+    // The results are the high halves of the 64 bit sums, which is already
+    // the odd lane for the odd sums
+    __m256i result = _mm256_blend_epi32(_mm256_srli_epi64(sum_even, 32),
+                                        sum_odd, 0xAA);
+    return _mm256_min_epu32(result, _mm256_sub_epi32(result, p));
+}
+
+__attribute__((target("avx2")))
+static void NTT_Stage_AVX2(uint32_t *values, const uint32_t *roots, int n,
+                            int half, const NTT_Prime *prime) {
+    __m256i p = _mm256_set1_epi32(prime->p);
+    __m256i p_inv = _mm256_set1_epi32(prime->p_inv);
+    for (int k = 0; k < n; k += half << 1) {
+        for (int j = 0; j < half; j += 8) {
+            __m256i *top = (__m256i *)(values + k + j);
+            __m256i *bottom = (__m256i *)(values + k + j + half);
+            __m256i w = _mm256_loadu_si256((const __m256i *)(roots + j));
+            __m256i t = Montgomery_Multiply_AVX2(w, _mm256_loadu_si256(bottom),
+                                                    p, p_inv);
+            __m256i u = _mm256_loadu_si256(top);
+            __m256i sum = _mm256_add_epi32(u, t);
+            __m256i difference = _mm256_sub_epi32(u, t);
+            _mm256_storeu_si256(top, _mm256_min_epu32(sum, _mm256_sub_epi32(sum, p)));
+            // u - t wrapped around if u < t, then adding p gives the smaller value
+            _mm256_storeu_si256(bottom, _mm256_min_epu32(difference,
+                                        _mm256_add_epi32(difference, p)));
+        }
+    }
+}
+#endif
+
+// Pick the kernel before storing it, so a transform never sees the vector
+// kernel with the width of the scalar one
+static void Use_NTT_Vector_Kernel(bool enable) {
+    NTT_Stage_Kernel kernel = NTT_Stage_Scalar;
+    int width = 1;
+#ifdef NTT_SIMD_X86
+    __builtin_cpu_init();
+    if (enable && __builtin_cpu_supports("avx2")) {
+        kernel = NTT_Stage_AVX2;
+        width = 8;
+    }
+#endif
+    ntt_stage_kernel_width = width;
+    ntt_stage_kernel = kernel;
+}
+
+static void Select_NTT_Vector_Kernel() {
+    Use_NTT_Vector_Kernel(true);
+}
+
+void Set_NTT_Vector_Kernel(bool enable) {
+    pthread_once(&ntt_kernel_once, Select_NTT_Vector_Kernel);
+    Use_NTT_Vector_Kernel(enable);
+}
+
+bool Get_NTT_Vector_Kernel() {
+    pthread_once(&ntt_kernel_once, Select_NTT_Vector_Kernel);
+    return ntt_stage_kernel != NTT_Stage_Scalar;
+}
+
+// Bit reverse the input into output and run every stage
+static void NTT_Transform(NTT_Plan *plan, const uint32_t *input, uint32_t *output,
+                            const uint32_t *roots) {
+    pthread_once(&ntt_kernel_once, Select_NTT_Vector_Kernel);
+    int n = plan->n;
+    unsigned int *bit_reverse = plan->plan->bit_reverse;
+    for (int i = 0; i < n; i++) {
+        output[i] = input[bit_reverse[i]];
+    }
+    for (int half = 1; half < n; half <<= 1) {
+        // The vector kernel needs at least one full vector per half segment
+        if (half < ntt_stage_kernel_width) {
+            NTT_Stage_Scalar(output, roots + half - 1, n, half, plan->prime);
+        } else {
+            ntt_stage_kernel(output, roots + half - 1, n, half, plan->prime);
+        }
+    }
+}
+
+void NTT_Forward(NTT_Plan *plan, const uint32_t *input, uint32_t *output) {
+    NTT_Transform(plan, input, output, plan->roots);
+}
+
+void NTT_Inverse(NTT_Plan *plan, const uint32_t *input, uint32_t *output) {
+    NTT_Transform(plan, input, output, plan->inverse_roots);
+
+    // Normalize the output by multiplying with n^{-1}
+    for (int i = 0; i < plan->n; i++) {
+        output[i] = Montgomery_Multiply(output[i], plan->n_inverse, plan->prime);
+    }
+}
+
+
+int NTT_Primes_Needed(uint64_t bound) {
+    pthread_once(&ntt_primes_once, Init_NTT_Primes);
+    // The coefficients are 0..bound, so the product of the primes must be
+    // at least bound + 1. Stop before the product overflows, three primes
+    // are above 2^64
+    uint64_t product = 1;
+    int count = 0;
+    while (count < NTT_MAX_PRIMES) {
+        if (product > bound / ntt_primes[count].p) {
+            return count + 1;
+        }
+        product *= ntt_primes[count].p;
+        count++;
+    }
+    return NTT_MAX_PRIMES;
+}
+
+void NTT_Convolution(const uint32_t *a, const uint32_t *b, int n, uint64_t bound,
+                        uint64_t *result) {
+    uint32_t *scratch = (uint32_t *)malloc(NTT_SCRATCH_ARRAYS * (size_t)n *
+                                            sizeof(uint32_t));
+    NTT_Convolution_ext(a, b, n, bound, result, scratch);
+    free(scratch);
+}
+
+// NTT_Reduced_Forward of length values of input, zero padded to n in the
+// same pass
+static void NTT_Padded_Forward(const uint32_t *input, int length, int n, int prime_index,
+                                uint32_t *output, uint32_t *scratch) {
+    NTT_Plan *plan = Get_NTT_Plan(n, prime_index);
+    for (int j = 0; j < length; j++) {
+        scratch[j] = input[j] % plan->prime->p;
+    }
+    memset(scratch + length, 0, (n - length) * sizeof(uint32_t));
+    NTT_Forward(plan, scratch, output);
+}
+
+void NTT_Reduced_Forward(const uint32_t *input, int n, int prime_index, uint32_t *output,
+                            uint32_t *scratch) {
+    NTT_Padded_Forward(input, n, n, prime_index, output, scratch);
+}
+
+// Point-wise product of the spectra into spectrum_a and its inverse
+// transform, the second Montgomery multiply with R^2 cancels the R^{-1} of
+// the first one
+static void NTT_Product_Inverse(NTT_Plan *plan, uint32_t *spectrum_a,
+                                const uint32_t *spectrum_b, uint32_t *residues) {
+    const NTT_Prime *prime = plan->prime;
+    for (int j = 0; j < plan->n; j++) {
+        spectrum_a[j] = Montgomery_Multiply(Montgomery_Multiply(spectrum_a[j],
+                                            spectrum_b[j], prime), prime->r2, prime);
+    }
+    NTT_Inverse(plan, spectrum_a, residues);
+}
+
+// Garner's algorithm, the result is written in mixed radix form
+//     x = y0 + p0 * y1 + p0 * p1 * y2
+// with y_i < p_i, solving one residue at a time. x is at most the bound the
+// number of primes was chosen for, so the uint64_t arithmetic never loses
+// anything even when it wraps around on the way
+static void Garner_Combine(uint32_t **residues, int primes, int n, uint64_t *result) {
+    uint64_t p0 = ntt_primes[0].p, p1 = ntt_primes[1].p, p2 = ntt_primes[2].p;
+    uint64_t p0_inverse_1 = Power_Mod(p0 % p1, p1 - 2, p1);
+    uint64_t p01_inverse_2 = Power_Mod(p0 * p1 % p2, p2 - 2, p2);
+    for (int j = 0; j < n; j++) {
+        uint64_t y0 = residues[0][j];
+        result[j] = y0;
+        if (primes > 1) {
+            uint64_t y1 = (residues[1][j] + p1 - y0 % p1) % p1 * p0_inverse_1 % p1;
+            result[j] += p0 * y1;
+            if (primes > 2) {
+                uint64_t x01 = (y0 + p0 % p2 * y1) % p2;
+                uint64_t y2 = (residues[2][j] + p2 - x01) % p2 * p01_inverse_2 % p2;
+                result[j] += p0 * p1 * y2;
+            }
+        }
+    }
+}
+
+void NTT_Convolution_ext(const uint32_t *a, const uint32_t *b, int n, uint64_t bound,
+                            uint64_t *result, uint32_t *scratch) {
+    NTT_Convolution_Padded_ext(a, n, b, n, n, bound, result, scratch);
+}
+
+void NTT_Convolution_Padded_ext(const uint32_t *a, int length_a, const uint32_t *b,
+                                int length_b, int n, uint64_t bound, uint64_t *result,
+                                uint32_t *scratch) {
+    int primes = NTT_Primes_Needed(bound);
+    uint32_t *residues[NTT_MAX_PRIMES];
+    uint32_t *reduced = scratch;
+    uint32_t *spectrum_a = scratch + n;
+    uint32_t *spectrum_b = scratch + 2 * n;
+
+    // One exact convolution modulo every prime
+    for (int i = 0; i < primes; i++) {
+        NTT_Plan *plan = Get_NTT_Plan(n, i);
+        residues[i] = scratch + (3 + i) * n;
+
+        NTT_Padded_Forward(a, length_a, n, i, spectrum_a, reduced);
+        if (b == a && length_b == length_a) {
+            // A square, the spectrum of b is the one of a
+            spectrum_b = spectrum_a;
+        } else {
+            NTT_Padded_Forward(b, length_b, n, i, spectrum_b, reduced);
+        }
+        NTT_Product_Inverse(plan, spectrum_a, spectrum_b, residues[i]);
+    }
+    Garner_Combine(residues, primes, n, result);
+}
+
+void NTT_Convolution_Prepared_ext(const uint32_t *a, uint32_t *const *spectra_b, int primes,
+                                    int n, uint64_t *result, uint32_t *scratch) {
+    uint32_t *residues[NTT_MAX_PRIMES];
+    uint32_t *reduced = scratch;
+    uint32_t *spectrum_a = scratch + n;
+    for (int i = 0; i < primes; i++) {
+        residues[i] = scratch + (3 + i) * n;
+        NTT_Reduced_Forward(a, n, i, spectrum_a, reduced);
+        NTT_Product_Inverse(Get_NTT_Plan(n, i), spectrum_a, spectra_b[i], residues[i]);
+    }
+    Garner_Combine(residues, primes, n, result);
+}
+
+
+double polynomial_multiply_NTT(mpz_t a, mpz_t b, int n, int* ntt_total_result) {
+    return polynomial_multiply_NTT_ctx(a, b, n, ntt_total_result,
+                                        Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_NTT_ctx(mpz_t a, mpz_t b, int n, int* ntt_total_result,
+                                    Multiply_Context *context) {
+    assert(n <= context->max_n);
+    size_t max_n = context->max_n;
+    int *padded_a = (int *)Context_Buffer(context, 0, max_n * sizeof(int));
+    int *padded_b = (int *)Context_Buffer(context, 1, max_n * sizeof(int));
+    uint64_t *ntt_result = (uint64_t *)Context_Buffer(context, 2, max_n * sizeof(uint64_t));
+    // Room for every prime, so the buffer never has to grow
+    uint32_t *scratch = (uint32_t *)Context_Buffer(context, 3, NTT_SCRATCH_ARRAYS *
+                                                    max_n * sizeof(uint32_t));
+    memset(padded_a, 0, n * sizeof(int));
+    memset(padded_b, 0, n * sizeof(int));
+
+    int length_a = mpz_to_int_array(a, padded_a);
+    int length_b = mpz_to_int_array(b, padded_b);
+
+    // A coefficient of the product is a sum of at most min(length_a, length_b)
+    // digit products of at most 9 * 9, which decides how many primes are used
+    uint64_t bound = 81 * (uint64_t)(length_a < length_b ? length_a : length_b);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // The digits are non-negative, so they can be used as uint32_t directly
+    NTT_Convolution_ext((uint32_t *)padded_a, (uint32_t *)padded_b, n, bound,
+                        ntt_result, scratch);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    // Exact, no rounding needed
+    for (int i = 0; i < n; i++) {
+        ntt_total_result[i] = (int)ntt_result[i];
+    }
+
+    return elapsed_time;
+}
+
+
+double polynomial_square_NTT(mpz_t a, int n, int* ntt_total_result) {
+    return polynomial_square_NTT_ctx(a, n, ntt_total_result, Get_Default_Multiply_Context(n));
+}
+
+double polynomial_square_NTT_ctx(mpz_t a, int n, int* ntt_total_result,
+                                    Multiply_Context *context) {
+    assert(n <= context->max_n);
+    size_t max_n = context->max_n;
+    int *padded = (int *)Context_Buffer(context, 0, max_n * sizeof(int));
+    uint64_t *ntt_result = (uint64_t *)Context_Buffer(context, 2, max_n * sizeof(uint64_t));
+    uint32_t *scratch = (uint32_t *)Context_Buffer(context, 3, NTT_SCRATCH_ARRAYS *
+                                                    max_n * sizeof(uint32_t));
+    memset(padded, 0, n * sizeof(int));
+
+    int length = mpz_to_int_array(a, padded);
+    uint64_t bound = 81 * (uint64_t)length;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // The same array twice, NTT_Convolution_ext transforms it once per prime
+    NTT_Convolution_ext((uint32_t *)padded, (uint32_t *)padded, n, bound, ntt_result,
+                        scratch);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    for (int i = 0; i < n; i++) {
+        ntt_total_result[i] = (int)ntt_result[i];
+    }
+
+    return elapsed_time;
+}
@@ -0,0 +1,126 @@
+#ifndef NTT_H
+#define NTT_H
+#include <stdint.h>
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "multiply_context.h"
+
+// Number theoretic transform (NTT)
+// The FFT works with the complex roots of unity e^{-i*TAU/n} and rounds its
+// result back to integers, so it is only exact while the rounding errors
+// stay below 0.5. The NTT is the same transform over the integers modulo a
+// prime p = c * 2^k + 1. For such a prime g^((p-1)/n) is a primitive n'th
+// root of unity for every n = 2^s <= 2^k (g a generator of the group), so the
+// radix-2 butterflies work unchanged, but every value is an exact integer.
+// The cyclic convolution is then exact modulo p. When the coefficients of
+// the product can be larger than p the convolution is done modulo several
+// primes and the result is put together with the Chinese remainder theorem
+// (Garner's algorithm).
+//
+// Montgomery multiplication
+// a * b mod p needs a division. With R = 2^32 the Montgomery product
+//     Montgomery(a, b) = a * b * R^{-1} mod p
+// only needs multiplies and shifts: q = (a*b mod R) * (-p^{-1}) mod R makes
+// a*b + q*p divisible by R, and (a*b + q*p) / R < 2p. The twiddles are
+// stored as w * R mod p (Montgomery form), so Montgomery(w * R, x) = w * x
+// and the transform itself never leaves the normal representation.
+
+#define NTT_MAX_PRIMES 3
+
+typedef struct {
+    // The prime c * 2^k + 1, below 2^31 so the sum of two values fits in
+    // 32 bits
+    uint32_t p;
+    uint32_t generator;     // Generator of the multiplicative group mod p
+    int max_log2n;          // k, the longest transform is 2^k
+    uint32_t p_inv;         // -p^{-1} mod 2^32
+    uint32_t r2;            // R^2 mod p, Montgomery(x, r2) = x * R mod p
+} NTT_Prime;
+
+typedef struct {
+    int n;
+    const NTT_Prime *prime;
+    FFT_Plan *plan;         // Shared bit reversal table
+    // Roots of unity in Montgomery form, stored stage by stage like the
+    // split FFT twiddles: the stage with half segment length h uses w_2h^j
+    // for j < h, stored contiguously from index h - 1
+    uint32_t *roots;
+    uint32_t *inverse_roots;
+    uint32_t n_inverse;     // n^{-1} in Montgomery form
+} NTT_Plan;
+
+// The primes in the order they are used, with 2^27, 2^26 and 2^25 as the
+// longest transforms
+const NTT_Prime *Get_NTT_Prime(int index);
+
+NTT_Plan *NTT_Plan_Create(int n, int prime_index);
+
+void NTT_Plan_Free(NTT_Plan *plan);
+
+// Cached plan for size n and prime prime_index, created on first use
+NTT_Plan *Get_NTT_Plan(int n, int prime_index);
+
+// Use the AVX2 butterflies when the cpu has them (the default), false forces
+// the scalar ones
+void Set_NTT_Vector_Kernel(bool enable);
+
+// True while the AVX2 butterflies are in use
+bool Get_NTT_Vector_Kernel();
+
+// Transforms of n values below p. The output is in natural order, the
+// inverse transform includes the division by n
+void NTT_Forward(NTT_Plan *plan, const uint32_t *input, uint32_t *output);
+
+void NTT_Inverse(NTT_Plan *plan, const uint32_t *input, uint32_t *output);
+
+// Number of primes needed for coefficients up to bound, their product has
+// to be larger than bound
+int NTT_Primes_Needed(uint64_t bound);
+
+// Cyclic convolution of a and b of length n (a power of 2). The result is
+// exact if no coefficient of the result is larger than bound. With b == a
+// the square is computed with one forward transform per prime
+void NTT_Convolution(const uint32_t *a, const uint32_t *b, int n, uint64_t bound,
+                        uint64_t *result);
+
+// Arrays of n values used by NTT_Convolution_ext: the reduced input, two
+// spectra and one residue array per prime
+#define NTT_SCRATCH_ARRAYS (3 + NTT_MAX_PRIMES)
+
+// NTT_Convolution with NTT_SCRATCH_ARRAYS * n values of scratch memory from
+// the caller instead of allocating it
+void NTT_Convolution_ext(const uint32_t *a, const uint32_t *b, int n, uint64_t bound,
+                            uint64_t *result, uint32_t *scratch);
+
+// NTT_Convolution_ext of the length_a values of a and the length_b values of
+// b, which are zero padded to n while they are reduced. The operands are
+// read once per prime and never copied, so they can be shorter arrays such
+// as the pages of a mapped file
+void NTT_Convolution_Padded_ext(const uint32_t *a, int length_a, const uint32_t *b,
+                                int length_b, int n, uint64_t bound, uint64_t *result,
+                                uint32_t *scratch);
+
+// Forward transform of input (n values) modulo prime prime_index into
+// output, scratch holds n values for the reduced input
+void NTT_Reduced_Forward(const uint32_t *input, int n, int prime_index, uint32_t *output,
+                            uint32_t *scratch);
+
+// NTT_Convolution_ext with the spectra of b already computed by
+// NTT_Reduced_Forward for the first primes primes, so only a is transformed.
+// primes must be NTT_Primes_Needed of the bound of the product
+void NTT_Convolution_Prepared_ext(const uint32_t *a, uint32_t *const *spectra_b, int primes,
+                                    int n, uint64_t *result, uint32_t *scratch);
+
+double polynomial_multiply_NTT(mpz_t a, mpz_t b, int n, int* ntt_total_result);
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_NTT_ctx(mpz_t a, mpz_t b, int n, int* ntt_total_result,
+                                    Multiply_Context *context);
+
+// The digits of a * a, one forward and one inverse transform per prime
+double polynomial_square_NTT(mpz_t a, int n, int* ntt_total_result);
+
+double polynomial_square_NTT_ctx(mpz_t a, int n, int* ntt_total_result,
+                                    Multiply_Context *context);
+
+#endif
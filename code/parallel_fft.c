@@ -0,0 +1,319 @@
+#include "parallel_fft.h"
+
+static int fft_threads = 1;
+
+
+void Set_FFT_Threads(int threads) {
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    fft_threads = (threads > 0) ? threads : 1;
+}
+
+int Get_FFT_Threads() {
+    return fft_threads;
+}
+
+bool Use_Parallel_FFT(int n) {
+    return fft_threads > 1 && n >= PARALLEL_FFT_MIN_N;
+}
+
+// The work is split in powers of 2, so use the largest power of 2 that is
+// not above the thread count
+static int Power_Of_Two_Threads(int n) {
+    int threads = 1;
+    while ((threads << 1) <= fft_threads && (threads << 1) <= n / 2) {
+        threads <<= 1;
+    }
+    return threads;
+}
+
+
+// Iterative FFT
+
+typedef struct {
+    FFT_Plan *plan;
+    complex double *input;
+    complex double *output;
+    bool inverse;
+    int thread_id;
+    int thread_count;
+    int stage;              // Stage of Stage_Worker
+} Iterative_Task;
+
+// Do the butterflies first..last-1 of stage s, butterfly t of the stage is
+// butterfly j = t % half of segment t / half
+static void Butterfly_Range(FFT_Plan *plan, complex double *output, int s,
+                            int first, int last, bool inverse) {
+    int half = 1 << (s - 1);
+    int twiddle_stride = plan->n >> s;
+    complex double unity_root_factor, twiddle_factor, tmp;
+
+    int t = first;
+    while (t < last) {
+        int segment = t >> (s - 1);
+        int j = t & (half - 1);
+        int last_j = (half < j + last - t) ? half : j + last - t;
+        complex double *top = output + (segment << s);
+        for (; j < last_j; j++, t++) {
+            unity_root_factor = plan->twiddles[j * twiddle_stride];
+            if (inverse) {
+                unity_root_factor = conj(unity_root_factor);
+            }
+            twiddle_factor = unity_root_factor * top[j + half];
+            tmp = top[j];
+            top[j] = tmp + twiddle_factor;
+            top[j + half] = tmp - twiddle_factor;
+        }
+    }
+}
+
+// Largest stage whose segments fit inside the part of one thread
+static int Local_Stages(Iterative_Task *task) {
+    int part = task->plan->n / task->thread_count;
+    int s = 0;
+    while (s < task->plan->log2n && (2 << s) <= part) {
+        s++;
+    }
+    return s;
+}
+
+// Bit reversal of the own part and the stages that stay inside it, they
+// only touch values this thread wrote
+static void Local_Worker(void *argument) {
+    Iterative_Task *task = (Iterative_Task *)argument;
+    FFT_Plan *plan = task->plan;
+    int part = plan->n / task->thread_count;
+    int begin = task->thread_id * part;
+
+    for (int i = begin; i < begin + part; i++) {
+        task->output[i] = task->input[plan->bit_reverse[i]];
+    }
+    // The butterflies of the own part are begin/2..(begin + part)/2 in every
+    // stage
+    for (int s = 1; s <= Local_Stages(task); s++) {
+        Butterfly_Range(plan, task->output, s, begin >> 1, (begin + part) >> 1,
+                        task->inverse);
+    }
+}
+
+// The own share of the butterflies of a stage whose segments span several
+// parts, every thread must have finished the previous stage
+static void Stage_Worker(void *argument) {
+    Iterative_Task *task = (Iterative_Task *)argument;
+    int part = task->plan->n / task->thread_count;
+    int begin = task->thread_id * part;
+    Butterfly_Range(task->plan, task->output, task->stage, begin >> 1,
+                    (begin + part) >> 1, task->inverse);
+}
+
+// Normalize the own part of the output by dividing by n
+static void Normalize_Worker(void *argument) {
+    Iterative_Task *task = (Iterative_Task *)argument;
+    int part = task->plan->n / task->thread_count;
+    int begin = task->thread_id * part;
+    for (int i = begin; i < begin + part; i++) {
+        task->output[i] /= task->plan->n;
+    }
+}
+
+// Run function on every task in the pool, the calling thread does task 0.
+// Returning is the barrier between the steps of the transform
+static void Run_Tasks(Thread_Pool *pool, Task_Function function, Iterative_Task *tasks,
+                        int thread_count) {
+    Task_Group group;
+    Task_Group_Init(&group);
+    for (int i = 1; i < thread_count; i++) {
+        Thread_Pool_Spawn(pool, &group, function, &tasks[i]);
+    }
+    function(&tasks[0]);
+    Thread_Pool_Wait(pool, &group);
+}
+
+static void Parallel_Iterative_Transform(complex double *input, int n,
+                                            complex double *output, bool inverse) {
+    FFT_Plan *plan = Get_FFT_Plan(n);
+    int thread_count = Power_Of_Two_Threads(n);
+    Thread_Pool *pool = Get_Thread_Pool(fft_threads);
+    Iterative_Task tasks[thread_count];
+    for (int i = 0; i < thread_count; i++) {
+        tasks[i] = (Iterative_Task){plan, input, output, inverse, i, thread_count, 0};
+    }
+
+    Run_Tasks(pool, Local_Worker, tasks, thread_count);
+    // The last log2(thread_count) stages, one round of tasks each
+    for (int s = Local_Stages(&tasks[0]) + 1; s <= plan->log2n; s++) {
+        for (int i = 0; i < thread_count; i++) {
+            tasks[i].stage = s;
+        }
+        Run_Tasks(pool, Stage_Worker, tasks, thread_count);
+    }
+    if (inverse) {
+        Run_Tasks(pool, Normalize_Worker, tasks, thread_count);
+    }
+}
+
+void Parallel_Iterative_FFT(complex double *input, int n, complex double *output) {
+    Parallel_Iterative_Transform(input, n, output, false);
+}
+
+void Parallel_Iterative_IFFT(complex double *input, int n, complex double *output) {
+    Parallel_Iterative_Transform(input, n, output, true);
+}
+
+
+// Recursive FFT
+
+// One level of the recursion, the arrays have the same layout as in
+// Recursive_FFT_ext
+typedef struct {
+    FFT_Plan *plan;         // Plan of the full size, for the twiddles
+    complex double *input;
+    int n;
+    complex double *even_values;
+    complex double *odd_values;
+    complex double *out_even_values;
+    complex double *out_odd_values;
+    complex double *out;
+    bool inverse;
+} Recursive_Level;
+
+typedef struct {
+    void (*function)(Recursive_Level *level, int begin, int end);
+    Recursive_Level *level;
+    int begin;
+    int end;
+} Range_Task;
+
+static void Range_Worker(void *argument) {
+    Range_Task *task = (Range_Task *)argument;
+    task->function(task->level, task->begin, task->end);
+}
+
+// Split the loop 0..count-1 into equal ranges for thread_count tasks
+static void Parallel_For(void (*function)(Recursive_Level *, int, int),
+                            Recursive_Level *level, int count, int thread_count) {
+    Thread_Pool *pool = Get_Thread_Pool(fft_threads);
+    Range_Task tasks[thread_count];
+    int range = count / thread_count;
+    Task_Group group;
+    Task_Group_Init(&group);
+    for (int i = 0; i < thread_count; i++) {
+        tasks[i] = (Range_Task){function, level, i * range, (i + 1) * range};
+    }
+    for (int i = 1; i < thread_count; i++) {
+        Thread_Pool_Spawn(pool, &group, Range_Worker, &tasks[i]);
+    }
+    Range_Worker(&tasks[0]);
+    Thread_Pool_Wait(pool, &group);
+}
+
+// Seperate into odd and even numbers
+static void Split_Range(Recursive_Level *level, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        level->even_values[i] = level->input[i << 1];
+        level->odd_values[i] = level->input[(i << 1) + 1];
+    }
+}
+
+// Compute the FFT output for k in begin..end-1
+static void Combine_Range(Recursive_Level *level, int begin, int end) {
+    int n_half = level->n >> 1;
+    // e^{-i*TAU*k/n} is every (plan size / n)'th twiddle of the full plan
+    int twiddle_stride = level->plan->n / level->n;
+    complex double w, tmp;
+    for (int k = begin; k < end; k++) {
+        w = level->plan->twiddles[k * twiddle_stride];
+        if (level->inverse) {
+            w = conj(w);
+        }
+        tmp = w * level->out_odd_values[k];
+        level->out[k] = level->out_even_values[k] + tmp;
+        level->out[k + n_half] = level->out_even_values[k] - tmp;
+    }
+}
+
+typedef struct {
+    FFT_Plan *plan;
+    complex double *input;
+    int n;
+    complex double *out;
+    complex double *allocated_memory;
+    int depth;
+    bool inverse;
+} Recursive_Task;
+
+static void Recursive_Worker(void *argument);
+
+// depth is the number of levels that still fork, 2^depth threads work on
+// this part of the recursion
+static void Parallel_Recursive(FFT_Plan *plan, complex double *input, int n,
+                                complex double *out,
+                                complex double *allocated_memory, int depth,
+                                bool inverse) {
+    if (depth == 0 || n < PARALLEL_FFT_MIN_N) {
+        if (inverse) {
+            Recursive_IFFT_ext(input, n, out, allocated_memory, n);
+        } else {
+            Recursive_FFT_ext(input, n, out, allocated_memory, n);
+        }
+        return;
+    }
+
+    int n_half = n >> 1;
+    Recursive_Level level = {plan, input, n, allocated_memory,
+                                allocated_memory + n_half,
+                                allocated_memory + 2 * n_half,
+                                allocated_memory + 3 * n_half, out, inverse};
+    Parallel_For(Split_Range, &level, n_half, 1 << depth);
+
+    // Fork the even half, it gets its own memory since both halves now run
+    // at the same time. The odd half runs in this thread on the memory after
+    // the four arrays of this level, like in Recursive_FFT_ext
+    complex double *even_memory = (complex double *)malloc((n_half << 2) *
+                                    sizeof(complex double));
+    Recursive_Task even_task = {plan, level.even_values, n_half,
+                                level.out_even_values, even_memory,
+                                depth - 1, inverse};
+    Thread_Pool *pool = Get_Thread_Pool(fft_threads);
+    Task_Group group;
+    Task_Group_Init(&group);
+    Thread_Pool_Spawn(pool, &group, Recursive_Worker, &even_task);
+    Parallel_Recursive(plan, level.odd_values, n_half, level.out_odd_values,
+                        level.out_odd_values + n_half, depth - 1, inverse);
+    Thread_Pool_Wait(pool, &group);
+    free(even_memory);
+
+    // Join: both halves are done, combine them
+    Parallel_For(Combine_Range, &level, n_half, 1 << depth);
+}
+
+static void Recursive_Worker(void *argument) {
+    Recursive_Task *task = (Recursive_Task *)argument;
+    Parallel_Recursive(task->plan, task->input, task->n, task->out,
+                        task->allocated_memory, task->depth, task->inverse);
+}
+
+static void Parallel_Recursive_Transform(complex double *input, int n,
+                                            complex double *out, bool inverse) {
+    // Same 4 * n memory as Recursive_FFT, the forked halves allocate their own
+    FFT_Plan *plan = Get_FFT_Plan(n);
+    complex double *allocated_memory = (complex double *)malloc((n << 2) *
+                                        sizeof(complex double));
+    int depth = log2(Power_Of_Two_Threads(n));
+    Parallel_Recursive(plan, input, n, out, allocated_memory, depth, inverse);
+    free(allocated_memory);
+}
+
+void Parallel_Recursive_FFT(complex double *input, int n, complex double *out) {
+    Parallel_Recursive_Transform(input, n, out, false);
+}
+
+void Parallel_Recursive_IFFT(complex double *input, int n, complex double *out) {
+    Parallel_Recursive_Transform(input, n, out, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < n; i++) {
+        out[i] /= n;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef PARALLEL_FFT_H
+#define PARALLEL_FFT_H
+#include <pthread.h>
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "recursive_fft.h"
+#include "thread_pool.h"
+
+// Multi-threaded FFT
+// The work runs as tasks on the shared thread pool (thread_pool.h), so the
+// threads are started once and not on every transform.
+// Iterative: every task owns n/threads consecutive values. The first
+// stages only combine values inside a segment of at most n/threads values,
+// so each task runs them on its own part without synchronising. The last
+// log2(threads) stages have segments spanning several parts, there the n/2
+// butterflies of the stage are split evenly between the tasks and every
+// stage is one round of tasks that is waited for before the next.
+// Recursive: the two half length transforms of Recursive_FFT_ext are forked
+// to two threads for the top log2(threads) levels of the recursion, and the
+// splitting and combining loops of those levels are shared the same way.
+
+// Transforms smaller than this run single-threaded, handing out the tasks
+// would cost more than the transform
+#define PARALLEL_FFT_MIN_N (1 << 14)
+
+// Number of threads used by the FFT, 0 uses every online cpu. The default
+// is 1, which keeps every transform single-threaded
+void Set_FFT_Threads(int threads);
+
+int Get_FFT_Threads();
+
+// True if a transform of size n should use the parallel versions
+bool Use_Parallel_FFT(int n);
+
+void Parallel_Iterative_FFT(complex double *input, int n, complex double *output);
+
+void Parallel_Iterative_IFFT(complex double *input, int n, complex double *output);
+
+void Parallel_Recursive_FFT(complex double *input, int n, complex double *out);
+
+void Parallel_Recursive_IFFT(complex double *input, int n, complex double *out);
+
+#endif
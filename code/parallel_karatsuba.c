@@ -0,0 +1,196 @@
+#include "parallel_karatsuba.h"
+
+static int karatsuba_threads = 1;
+
+// The parts of one Karatsuba level, as in Karatsuba_Polynomial_ext
+typedef struct {
+    int half_length;
+    int low_length1, low_length2;
+    int high_length1, high_length2;
+} Karatsuba_Split;
+
+// Everything the tasks of one multiplication share
+typedef struct {
+    int cutoff;
+    int depth;                  // Levels that are forked
+    int **thread_scratch;       // Serial scratch arena of every thread
+} Parallel_Karatsuba;
+
+// One product, forked or serial
+typedef struct {
+    Parallel_Karatsuba *shared;
+    int *input1, *input2;
+    int length_input1, length_input2;
+    int *result;
+    int *scratch;               // This task's view of the forked arena
+    int depth;
+} Karatsuba_Task;
+
+
+void Set_Karatsuba_Threads(int threads) {
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    karatsuba_threads = (threads > 0) ? threads : 1;
+}
+
+int Get_Karatsuba_Threads() {
+    return karatsuba_threads;
+}
+
+bool Use_Parallel_Karatsuba(int length_input1, int length_input2) {
+    return karatsuba_threads > 1 && length_input1 >= PARALLEL_KARATSUBA_GRAIN &&
+            length_input2 >= PARALLEL_KARATSUBA_GRAIN;
+}
+
+static Karatsuba_Split Split(int length_input1, int length_input2) {
+    Karatsuba_Split split;
+    int half_length1 = (length_input1 + 1) >> 1;
+    int half_length2 = (length_input2 + 1) >> 1;
+    split.half_length = (half_length1 > half_length2) ? half_length1 : half_length2;
+    split.low_length1 = (length_input1 < split.half_length) ? length_input1 : split.half_length;
+    split.low_length2 = (length_input2 < split.half_length) ? length_input2 : split.half_length;
+    split.high_length1 = length_input1 - split.low_length1;
+    split.high_length2 = length_input2 - split.low_length2;
+    return split;
+}
+
+static bool Forked_Level(Parallel_Karatsuba *shared, int length_input1,
+                            int length_input2, int depth) {
+    return depth < shared->depth && length_input1 > shared->cutoff &&
+            length_input2 > shared->cutoff &&
+            length_input1 >= PARALLEL_KARATSUBA_GRAIN &&
+            length_input2 >= PARALLEL_KARATSUBA_GRAIN;
+}
+
+// Size of the forked arena of a product (its sums and middle product, then
+// the arenas of its three children one after the other) and the largest
+// serial scratch of any task below it
+static int Forked_Scratch(Parallel_Karatsuba *shared, int length_input1,
+                            int length_input2, int depth, int *serial_scratch) {
+    if (!Forked_Level(shared, length_input1, length_input2, depth)) {
+        int size = Karatsuba_Scratch_Size(length_input1, length_input2, shared->cutoff);
+        if (size > *serial_scratch) {
+            *serial_scratch = size;
+        }
+        return 0;
+    }
+    Karatsuba_Split split = Split(length_input1, length_input2);
+    int size = 4 * split.half_length;
+    size += Forked_Scratch(shared, split.low_length1, split.low_length2, depth + 1,
+                            serial_scratch);
+    if (split.high_length1 > 0 && split.high_length2 > 0) {
+        size += Forked_Scratch(shared, split.high_length1, split.high_length2,
+                                depth + 1, serial_scratch);
+    }
+    size += Forked_Scratch(shared, split.half_length, split.half_length, depth + 1,
+                            serial_scratch);
+    return size;
+}
+
+static void Karatsuba_Task_Run(void *argument) {
+    Karatsuba_Task *task = (Karatsuba_Task *)argument;
+    Parallel_Karatsuba *shared = task->shared;
+    int length_input1 = task->length_input1, length_input2 = task->length_input2;
+    int *input1 = task->input1, *input2 = task->input2, *result = task->result;
+
+    if (!Forked_Level(shared, length_input1, length_input2, task->depth)) {
+        Karatsuba_Polynomial_ext(input1, input2, length_input1, length_input2, result,
+                                    shared->thread_scratch[Thread_Pool_Thread_Index()],
+                                    shared->cutoff);
+        return;
+    }
+
+    Karatsuba_Split split = Split(length_input1, length_input2);
+    int half_length = split.half_length;
+    int max_length = length_input1 + length_input2 - 1;
+    bool has_high = split.high_length1 > 0 && split.high_length2 > 0;
+
+    // Views into the forked arena, the children's arenas follow in the
+    // order of Forked_Scratch
+    int *sum1 = task->scratch;
+    int *sum2 = sum1 + half_length;
+    int *result_middle = sum2 + half_length;
+    int *child_scratch = result_middle + 2 * half_length;
+    int serial_scratch = 0;
+
+    memset(result, 0, max_length * sizeof(int));
+    for (int i = 0; i < half_length; i++) {
+        sum1[i] = ((i < split.low_length1) ? input1[i] : 0) +
+                    ((i < split.high_length1) ? input1[half_length + i] : 0);
+        sum2[i] = ((i < split.low_length2) ? input2[i] : 0) +
+                    ((i < split.high_length2) ? input2[half_length + i] : 0);
+    }
+
+    // The low product is written to the bottom of result and the high
+    // product from 2 * half_length, the two ranges do not overlap
+    Karatsuba_Task low = {shared, input1, input2, split.low_length1, split.low_length2,
+                            result, child_scratch, task->depth + 1};
+    child_scratch += Forked_Scratch(shared, split.low_length1, split.low_length2,
+                                    task->depth + 1, &serial_scratch);
+    Karatsuba_Task high = {shared, input1 + half_length, input2 + half_length,
+                            split.high_length1, split.high_length2,
+                            result + 2 * half_length, child_scratch, task->depth + 1};
+    if (has_high) {
+        child_scratch += Forked_Scratch(shared, split.high_length1, split.high_length2,
+                                        task->depth + 1, &serial_scratch);
+    }
+    Karatsuba_Task middle = {shared, sum1, sum2, half_length, half_length,
+                                result_middle, child_scratch, task->depth + 1};
+
+    Thread_Pool *pool = Get_Thread_Pool(karatsuba_threads);
+    Task_Group group;
+    Task_Group_Init(&group);
+    Thread_Pool_Spawn(pool, &group, Karatsuba_Task_Run, &middle);
+    if (has_high) {
+        Thread_Pool_Spawn(pool, &group, Karatsuba_Task_Run, &high);
+    }
+    Karatsuba_Task_Run(&low);
+    Thread_Pool_Wait(pool, &group);
+
+    // Same assembly as Karatsuba_Polynomial_ext
+    int low_result_length = split.low_length1 + split.low_length2 - 1;
+    int high_result_length = has_high ? split.high_length1 + split.high_length2 - 1 : 0;
+    Array_Subtraction(result_middle, result, low_result_length, result_middle);
+    Array_Subtraction(result_middle, result + 2 * half_length, high_result_length,
+                        result_middle);
+    int middle_length = 2 * half_length - 1;
+    if (middle_length > max_length - half_length) {
+        middle_length = max_length - half_length;
+    }
+    for (int i = 0; i < middle_length; i++) {
+        result[half_length + i] += result_middle[i];
+    }
+}
+
+void Parallel_Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
+                                    int length_input2, int *result, int cutoff) {
+    Thread_Pool *pool = Get_Thread_Pool(karatsuba_threads);
+    Parallel_Karatsuba shared;
+    shared.cutoff = cutoff;
+    // Fork until there are at least 4 tasks per thread, so a thread that
+    // finishes early can steal
+    shared.depth = 0;
+    for (int tasks = 1; tasks < 4 * pool->threads; tasks *= 3) {
+        shared.depth++;
+    }
+
+    // One allocation for the forked arena and the serial arena of every
+    // thread
+    int serial_scratch = 0;
+    int forked_scratch = Forked_Scratch(&shared, length_input1, length_input2, 0,
+                                        &serial_scratch);
+    serial_scratch++;
+    int *arena = (int *)malloc(((size_t)forked_scratch + (size_t)pool->threads *
+                                serial_scratch) * sizeof(int));
+    int *thread_scratch[pool->threads];
+    for (int i = 0; i < pool->threads; i++) {
+        thread_scratch[i] = arena + forked_scratch + (size_t)i * serial_scratch;
+    }
+    shared.thread_scratch = thread_scratch;
+
+    Karatsuba_Task root = {&shared, input1, input2, length_input1, length_input2,
+                            result, arena, 0};
+    Karatsuba_Task_Run(&root);
+    free(arena);
+}
@@ -0,0 +1,38 @@
+#ifndef PARALLEL_KARATSUBA_H
+#define PARALLEL_KARATSUBA_H
+#include "Helper_Functions.h"
+#include "karatsuba.h"
+#include "thread_pool.h"
+
+// Multi-threaded Karatsuba
+// The three products of a Karatsuba level (low, high and middle) do not
+// depend on each other. For the top levels of the recursion the high and
+// middle products are spawned as tasks on the work-stealing pool while the
+// thread runs the low product itself, and the result is assembled after
+// the wait. The levels are forked until there are enough tasks to keep
+// every thread busy (3^depth >= 4 * threads) or the inputs are shorter than
+// PARALLEL_KARATSUBA_GRAIN, below that a task runs the serial
+// Karatsuba_Polynomial_ext.
+//
+// Memory: a forked level needs its sums and its middle product while its
+// children run, so every forked task gets its own disjoint view of one
+// arena. The serial tasks never wait, so a thread runs one at a time and
+// every thread has one scratch arena of its own for them.
+
+// Inputs shorter than this are multiplied serially
+#define PARALLEL_KARATSUBA_GRAIN 1024
+
+// Number of threads used by Karatsuba, 0 uses every online cpu. The default
+// is 1, which keeps every multiplication single-threaded
+void Set_Karatsuba_Threads(int threads);
+
+int Get_Karatsuba_Threads();
+
+// True if inputs of these lengths should use the parallel version
+bool Use_Parallel_Karatsuba(int length_input1, int length_input2);
+
+// Same result as Karatsuba_Polynomial_ext, on Get_Karatsuba_Threads threads
+void Parallel_Karatsuba_Polynomial(int *input1, int *input2, int length_input1,
+                                    int length_input2, int *result, int cutoff);
+
+#endif
@@ -0,0 +1,188 @@
+#include "polynomial_multiply.h"
+
+static Multiply_Thresholds thresholds;
+static bool thresholds_loaded = false;
+
+// Names of the thresholds in the file, in the order of Multiply_Thresholds
+static const char *threshold_keys[] = {"karatsuba_cutoff", "karatsuba", "toom", "fft",
+                                        "mixed_radix", "ntt"};
+#define THRESHOLD_KEYS 6
+
+
+Multiply_Thresholds Default_Multiply_Thresholds() {
+    // Rounded from a few runs of test/threshold_tuning.c on the development
+    // machine, the FFT with the packed real transform overtakes Toom-Cook
+    // early and the NTT only pays off where the FFT runs out of cache. The
+    // cutoff is the one Karatsuba_Polynomial starts with, so using the
+    // defaults does not change the direct Karatsuba multiplications. The
+    // mixed-radix FFT only beat the power-of-two FFT just above the powers
+    // of two there, never over a whole range of sizes, so it is off unless
+    // the tuning on the host finds a range where it wins
+    Multiply_Thresholds defaults = {
+        .karatsuba_cutoff = KARATSUBA_CUTOFF,
+        .karatsuba = 48,
+        .toom = 96,
+        .fft = 192,
+        .mixed_radix = INT_MAX,
+        .ntt = 65536,
+    };
+    return defaults;
+}
+
+static int *Threshold_Field(Multiply_Thresholds *values, int key) {
+    int *fields[THRESHOLD_KEYS] = {&values->karatsuba_cutoff, &values->karatsuba,
+                                    &values->toom, &values->fft,
+                                    &values->mixed_radix, &values->ntt};
+    return fields[key];
+}
+
+Multiply_Thresholds Get_Multiply_Thresholds() {
+    if (!thresholds_loaded) {
+        // The defaults, replaced by the measured values if there are any.
+        // The Karatsuba cutoff is left as it is unless the file sets it
+        thresholds = Default_Multiply_Thresholds();
+        thresholds_loaded = true;
+        Load_Multiply_Thresholds(MULTIPLY_THRESHOLDS_FILE);
+    }
+    // Set_Karatsuba_Cutoff can change the cutoff at any time
+    thresholds.karatsuba_cutoff = Get_Karatsuba_Cutoff();
+    return thresholds;
+}
+
+void Set_Multiply_Thresholds(Multiply_Thresholds new_thresholds) {
+    thresholds = new_thresholds;
+    thresholds_loaded = true;
+    Set_Karatsuba_Cutoff(thresholds.karatsuba_cutoff);
+}
+
+bool Load_Multiply_Thresholds(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    Multiply_Thresholds loaded = thresholds_loaded ? thresholds
+                                                    : Default_Multiply_Thresholds();
+    loaded.karatsuba_cutoff = Get_Karatsuba_Cutoff();
+    char line[256], key[64];
+    long value;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        // Comments, empty lines and unknown keys are skipped
+        if (line[0] == '#' || sscanf(line, "%63s %ld", key, &value) != 2) {
+            continue;
+        }
+        for (int i = 0; i < THRESHOLD_KEYS; i++) {
+            if (strcmp(key, threshold_keys[i]) == 0 && value > 0) {
+                *Threshold_Field(&loaded, i) = (value > INT_MAX) ? INT_MAX : (int)value;
+            }
+        }
+    }
+    fclose(file);
+    Set_Multiply_Thresholds(loaded);
+    return true;
+}
+
+bool Save_Multiply_Thresholds(const char *path, Multiply_Thresholds values) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "# Crossover thresholds of polynomial_multiply in decimal digits\n");
+    fprintf(file, "# measured by the threshold tuning, %d means never\n", INT_MAX);
+    for (int i = 0; i < THRESHOLD_KEYS; i++) {
+        fprintf(file, "%s %d\n", threshold_keys[i], *Threshold_Field(&values, i));
+    }
+    return fclose(file) == 0;
+}
+
+const char *Multiply_Engine_Name(Multiply_Engine engine) {
+    switch (engine) {
+    case MULTIPLY_ENGINE_NAIVE:
+        return "naive";
+    case MULTIPLY_ENGINE_KARATSUBA:
+        return "Karatsuba";
+    case MULTIPLY_ENGINE_TOOM:
+        return "Toom-Cook";
+    case MULTIPLY_ENGINE_FFT:
+        return "iterative FFT";
+    case MULTIPLY_ENGINE_MIXED_RADIX:
+        return "mixed-radix FFT";
+    case MULTIPLY_ENGINE_NTT:
+        return "NTT";
+    default:
+        return "unknown";
+    }
+}
+
+Multiply_Engine Choose_Multiply_Engine(int digits) {
+    Multiply_Thresholds current = Get_Multiply_Thresholds();
+    // Checked from the largest engine down, so thresholds that are out of
+    // order still give the engine of the highest threshold passed
+    if (digits >= current.ntt) {
+        return MULTIPLY_ENGINE_NTT;
+    }
+    if (digits >= current.mixed_radix) {
+        return MULTIPLY_ENGINE_MIXED_RADIX;
+    }
+    if (digits >= current.fft) {
+        return MULTIPLY_ENGINE_FFT;
+    }
+    if (digits >= current.toom) {
+        return MULTIPLY_ENGINE_TOOM;
+    }
+    if (digits >= current.karatsuba) {
+        return MULTIPLY_ENGINE_KARATSUBA;
+    }
+    return MULTIPLY_ENGINE_NAIVE;
+}
+
+// Schoolbook multiplication of the digits only, Polynomial_Multiply_Naive
+// always multiplies all n values of the padded arrays
+static double Multiply_Naive_Digits(mpz_t a, mpz_t b, int n, int* total_result,
+                                    Multiply_Context *context) {
+    int *padded_a = (int *)Context_Buffer(context, 0, context->max_n * sizeof(int));
+    int *padded_b = (int *)Context_Buffer(context, 1, context->max_n * sizeof(int));
+
+    int length_input1 = mpz_to_int_array(a, padded_a);
+    int length_input2 = mpz_to_int_array(b, padded_b);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Array_Multiplication(padded_a, padded_b, length_input1, length_input2, total_result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+double polynomial_multiply_engine(Multiply_Engine engine, mpz_t a, mpz_t b, int n,
+                                    int* total_result, Multiply_Context *context) {
+    assert(n <= context->max_n);
+    switch (engine) {
+    case MULTIPLY_ENGINE_NAIVE:
+        return Multiply_Naive_Digits(a, b, n, total_result, context);
+    case MULTIPLY_ENGINE_KARATSUBA:
+        return polynomial_multiply_karatsuba_ctx(a, b, n, total_result, context);
+    case MULTIPLY_ENGINE_TOOM:
+        return polynomial_multiply_toom_ctx(a, b, n, total_result, context);
+    case MULTIPLY_ENGINE_FFT:
+        return polynomial_multiply_iterative_FFT_ctx(a, b, n, total_result, context);
+    case MULTIPLY_ENGINE_MIXED_RADIX:
+        return polynomial_multiply_mixed_radix_ctx(a, b, n, total_result, context);
+    case MULTIPLY_ENGINE_NTT:
+        return polynomial_multiply_NTT_ctx(a, b, n, total_result, context);
+    default:
+        return 0.0;
+    }
+}
+
+double polynomial_multiply(mpz_t a, mpz_t b, int n, int* total_result) {
+    return polynomial_multiply_ctx(a, b, n, total_result, Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_ctx(mpz_t a, mpz_t b, int n, int* total_result,
+                                Multiply_Context *context) {
+    // mpz_sizeinbase is exact or one digit too many, close enough to choose
+    size_t digits_a = mpz_sizeinbase(a, 10);
+    size_t digits_b = mpz_sizeinbase(b, 10);
+    int digits = (int)((digits_a > digits_b) ? digits_a : digits_b);
+    return polynomial_multiply_engine(Choose_Multiply_Engine(digits), a, b, n,
+                                        total_result, context);
+}
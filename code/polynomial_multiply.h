@@ -0,0 +1,86 @@
+#ifndef POLYNOMIAL_MULTIPLY_H
+#define POLYNOMIAL_MULTIPLY_H
+#include <limits.h>
+#include "Helper_Functions.h"
+#include "multiply_context.h"
+#include "karatsuba.h"
+#include "toom_cook.h"
+#include "iterative_fft.h"
+#include "ntt.h"
+#include "mixed_radix_fft.h"
+
+// One entry point for polynomial multiplication
+// Which multiplication is fastest depends on the size of the operands: the
+// schoolbook method for a few digits, Karatsuba and Toom-Cook in the middle
+// and the FFT, the mixed-radix FFT or the NTT for long operands. Where one overtakes the other
+// depends on the cpu and its caches, so the crossovers are thresholds that
+// test/threshold_tuning.c measures on the host and saves in a small text
+// file, which is loaded the first time polynomial_multiply runs:
+//     # comment
+//     karatsuba_cutoff 250
+//     karatsuba 250
+//     ...
+// Every threshold is a number of decimal digits of the longer operand, the
+// engine is used from its threshold up to the threshold of the next one.
+
+#define MULTIPLY_THRESHOLDS_FILE "multiply_thresholds.txt"
+
+// The engines polynomial_multiply can choose from, from small to large sizes
+typedef enum {
+    MULTIPLY_ENGINE_NAIVE,          // Array_Multiplication on the digits
+    MULTIPLY_ENGINE_KARATSUBA,      // polynomial_multiply_karatsuba
+    MULTIPLY_ENGINE_TOOM,           // polynomial_multiply_toom
+    MULTIPLY_ENGINE_FFT,            // polynomial_multiply_iterative_FFT
+    MULTIPLY_ENGINE_MIXED_RADIX,    // polynomial_multiply_mixed_radix
+    MULTIPLY_ENGINE_NTT,            // polynomial_multiply_NTT
+    MULTIPLY_ENGINES
+} Multiply_Engine;
+
+typedef struct {
+    int karatsuba_cutoff;   // Base case length of the Karatsuba recursion
+    // Digits from which each engine is used, INT_MAX if it never is
+    int karatsuba;
+    int toom;
+    int fft;
+    int mixed_radix;
+    int ntt;
+} Multiply_Thresholds;
+
+// The built in thresholds, used when there is no thresholds file
+Multiply_Thresholds Default_Multiply_Thresholds();
+
+// The thresholds in use, loaded from MULTIPLY_THRESHOLDS_FILE on first use.
+// karatsuba_cutoff is always the current Get_Karatsuba_Cutoff, loading only
+// changes it when the file has the key
+Multiply_Thresholds Get_Multiply_Thresholds();
+
+// Use thresholds from now on, also sets the Karatsuba cutoff
+void Set_Multiply_Thresholds(Multiply_Thresholds thresholds);
+
+// Read thresholds from path and use them. Keys that are missing keep their
+// current value, a missing karatsuba_cutoff leaves the Karatsuba cutoff
+// alone. Returns false if the file can not be read
+bool Load_Multiply_Thresholds(const char *path);
+
+// Write thresholds to path, returns false if the file can not be written
+bool Save_Multiply_Thresholds(const char *path, Multiply_Thresholds thresholds);
+
+const char *Multiply_Engine_Name(Multiply_Engine engine);
+
+// Engine polynomial_multiply uses for an operand of digits decimal digits
+Multiply_Engine Choose_Multiply_Engine(int digits);
+
+// Multiply with the given engine, returns the elapsed time of the
+// multiplication without the conversion of the operands like the
+// polynomial_multiply_* functions
+double polynomial_multiply_engine(Multiply_Engine engine, mpz_t a, mpz_t b, int n,
+                                    int* total_result, Multiply_Context *context);
+
+// Multiply with the engine chosen for the size of a and b
+double polynomial_multiply(mpz_t a, mpz_t b, int n, int* total_result);
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_ctx(mpz_t a, mpz_t b, int n, int* total_result,
+                                Multiply_Context *context);
+
+#endif
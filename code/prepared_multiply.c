@@ -0,0 +1,115 @@
+#include "prepared_multiply.h"
+
+
+Prepared_Operand *Prepare_Operand(mpz_t b, int n, Prepared_Engine engine) {
+    assert(n >= 2 && (n & (n - 1)) == 0);
+    Prepared_Operand *prepared = (Prepared_Operand *)calloc(1, sizeof(Prepared_Operand));
+    prepared->engine = engine;
+    prepared->n = n;
+
+    int *digits = (int *)calloc(n, sizeof(int));
+    prepared->length = mpz_to_int_array(b, digits);
+    assert(prepared->length <= n);
+
+    if (engine == PREPARED_ENGINE_FFT) {
+        double *padded = (double *)malloc(n * sizeof(double));
+        complex double *work = (complex double *)malloc((n / 2) * sizeof(complex double));
+        for (int i = 0; i < n; i++) {
+            padded[i] = digits[i];
+        }
+        prepared->spectrum = (complex double *)malloc((n / 2 + 1) * sizeof(complex double));
+        Real_FFT(FFT_Forward, padded, n, prepared->spectrum, work);
+        mpz_init_set(prepared->value, b);
+        free(padded);
+        free(work);
+    } else {
+        // A coefficient of the product is a sum of at most length(b) digit
+        // products, however long a is
+        prepared->primes = NTT_Primes_Needed(81 * (uint64_t)prepared->length);
+        uint32_t *scratch = (uint32_t *)malloc(n * sizeof(uint32_t));
+        for (int i = 0; i < prepared->primes; i++) {
+            prepared->ntt_spectra[i] = (uint32_t *)malloc(n * sizeof(uint32_t));
+            NTT_Reduced_Forward((uint32_t *)digits, n, i, prepared->ntt_spectra[i], scratch);
+        }
+        free(scratch);
+    }
+    free(digits);
+    return prepared;
+}
+
+void Prepared_Operand_Free(Prepared_Operand *prepared) {
+    if (prepared == NULL) {
+        return;
+    }
+    if (prepared->engine == PREPARED_ENGINE_FFT) {
+        mpz_clear(prepared->value);
+    }
+    free(prepared->spectrum);
+    for (int i = 0; i < prepared->primes; i++) {
+        free(prepared->ntt_spectra[i]);
+    }
+    free(prepared);
+}
+
+double polynomial_multiply_prepared(Prepared_Operand *prepared, mpz_t a, int *result) {
+    return polynomial_multiply_prepared_ctx(prepared, a, result,
+                                            Get_Default_Multiply_Context(prepared->n));
+}
+
+double polynomial_multiply_prepared_ctx(Prepared_Operand *prepared, mpz_t a, int *result,
+                                        Multiply_Context *context) {
+    int n = prepared->n;
+    assert(n <= context->max_n);
+    size_t max_n = context->max_n;
+    struct timespec start, end;
+    double elapsed_time;
+
+    if (prepared->engine == PREPARED_ENGINE_FFT) {
+        double *padded = (double *)Context_Buffer(context, 0, max_n * sizeof(double));
+        complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                    (max_n / 2 + 1) * sizeof(complex double));
+        complex double *work = (complex double *)Context_Buffer(context, 2,
+                                (max_n / 2) * sizeof(complex double));
+        double *fft_result = (double *)Context_Buffer(context, 3, max_n * sizeof(double));
+        memset(padded, 0, n * sizeof(double));
+        int length = mpz_to_double_array(a, padded, 1);
+        assert(length + prepared->length - 1 <= n);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        Real_FFT(FFT_Forward, padded, n, spectrum, work);
+        for (int k = 0; k <= n / 2; k++) {
+            spectrum[k] *= prepared->spectrum[k];
+        }
+        Real_IFFT(FFT_Inverse, spectrum, n, fft_result, work);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        // A product that came too close to a rounding error is redone
+        // exactly, which gives up the prepared transform for this call
+        if (!Round_FFT_Result(fft_result, n, result)) {
+            elapsed_time = Exact_Fallback_Multiply(a, prepared->value, n, result, context);
+            return end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0 +
+                    elapsed_time;
+        }
+    } else {
+        int *padded = (int *)Context_Buffer(context, 0, max_n * sizeof(int));
+        uint64_t *ntt_result = (uint64_t *)Context_Buffer(context, 2,
+                                max_n * sizeof(uint64_t));
+        uint32_t *scratch = (uint32_t *)Context_Buffer(context, 3, NTT_SCRATCH_ARRAYS *
+                                                        max_n * sizeof(uint32_t));
+        memset(padded, 0, n * sizeof(int));
+        int length = mpz_to_int_array(a, padded);
+        assert(length + prepared->length - 1 <= n);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        NTT_Convolution_Prepared_ext((uint32_t *)padded, prepared->ntt_spectra,
+                                        prepared->primes, n, ntt_result, scratch);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        for (int i = 0; i < n; i++) {
+            result[i] = (int)ntt_result[i];
+        }
+    }
+
+    elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    return elapsed_time;
+}
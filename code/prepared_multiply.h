@@ -0,0 +1,55 @@
+#ifndef PREPARED_MULTIPLY_H
+#define PREPARED_MULTIPLY_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "real_fft.h"
+#include "ntt.h"
+#include "multiply_context.h"
+#include "fft_rounding.h"
+
+// Multiplication by a fixed operand
+// When many numbers are multiplied by the same constant b, every
+// polynomial_multiply_* call transforms b again. A prepared operand keeps
+// the forward transform of the digits of b for one transform size n, so a
+// multiplication only transforms a, multiplies point-wise and transforms
+// back:
+//     FFT:    the real FFT of b (bins 0..n/2). A call is one real forward
+//             and one real inverse transform of length n/2, where
+//             polynomial_multiply_iterative_FFT needs a complex transform
+//             of length n and a real inverse
+//     NTT:    the spectrum of b modulo every prime the product can need,
+//             a call is one forward and one inverse transform per prime
+//             instead of two forward and one inverse
+// The primes are chosen by NTT_Primes_Needed(81 * length(b)): a coefficient
+// of the product is a sum of at most length(b) digit products, however long
+// a is, so every a of at most n - length(b) + 1 digits can be multiplied.
+
+typedef enum {
+    PREPARED_ENGINE_FFT,
+    PREPARED_ENGINE_NTT
+} Prepared_Engine;
+
+typedef struct {
+    Prepared_Engine engine;
+    int n;                          // Transform size, the length of the results
+    int length;                     // Digits of b
+    complex double *spectrum;       // FFT: bins 0..n/2 of the digits of b
+    mpz_t value;                    // FFT: b, for the exact fallback
+    int primes;                     // NTT: primes used
+    uint32_t *ntt_spectra[NTT_MAX_PRIMES];
+} Prepared_Operand;
+
+// The transform of the digits of b for products of size n (a power of 2)
+Prepared_Operand *Prepare_Operand(mpz_t b, int n, Prepared_Engine engine);
+
+void Prepared_Operand_Free(Prepared_Operand *prepared);
+
+// The digits of a * b into result (prepared->n values). Returns the elapsed
+// time of the transforms like the polynomial_multiply_* functions
+double polynomial_multiply_prepared(Prepared_Operand *prepared, mpz_t a, int *result);
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_prepared_ctx(Prepared_Operand *prepared, mpz_t a, int *result,
+                                        Multiply_Context *context);
+
+#endif
@@ -7,15 +7,34 @@
 #include "test/Runtime_test.h"
 #include "test/karatsuba_optimisation.h"
 #include "test/Runtime_test_systematic.h"
+#include "test/threshold_tuning.h"
+#include "polynomial_multiply.h"
+#include "parallel_fft.h"
+#include "parallel_karatsuba.h"
 #include "Helper_Functions.h"
+#include "file_multiply.h"
 
 
-int main() {
+int main(int argc, char **argv) {
+    // With arguments the program benchmarks or multiplies files instead of
+    // showing the menu
+    if (argc > 1 && strcmp(argv[1], "benchmark") == 0) {
+        return Benchmark_Command(argc, argv);
+    }
+    if (argc > 1) {
+        return File_Multiply_Command(argc, argv);
+    }
+
     printf("Welcome to Polynomial test, these tests include, Naive, DFT, Karatsuba and FFT recursive and iterative\n");
     
-    int input_number, n, m, iterations;
+    int input_number, n, m, iterations, threads;
+
+    // Crossover thresholds measured by an earlier tuning run
+    if (Load_Multiply_Thresholds(MULTIPLY_THRESHOLDS_FILE)) {
+        printf("Loaded the multiplication thresholds from %s\n", MULTIPLY_THRESHOLDS_FILE);
+    }
     while (1){
-        printf("What do you want to test, write 1 for runtime test or 2 for unit test or 3 to compare times, 4 to test optimal karatsuba value, 5 to exit\n");
+        printf("What do you want to test, write 1 for runtime test or 2 for unit test or 3 to compare times, 4 to test optimal karatsuba value, 5 to exit, 6 to set the number of FFT and Karatsuba threads, 7 to tune the multiplication thresholds\n");
         
         if (scanf("%d", &input_number) != 1) {
             fprintf(stderr, "Error reading input for input_number\n");
@@ -31,8 +50,10 @@ int main() {
                 return 1;  
             }
 
+            // The buffers are on the heap so any size fits, but the naive and
+            // DFT multiplications are quadratic
             if (m > 16){
-                printf("Choose a number smaller than 17");
+                printf("m above 16 takes a long time for the naive and DFT multiplications\n");
             }
             n = pow(2, m);
             printf("n has been set to:\t %d\n", n);
@@ -56,6 +77,22 @@ int main() {
             break;
         case 5:
             exit(0);
+        case 6:
+            printf("How many threads should the FFT and Karatsuba use? 0 uses every cpu\n");
+
+            if (scanf("%d", &threads) != 1) {
+                fprintf(stderr, "Error reading input for threads\n");
+                return 1;
+            }
+
+            Set_FFT_Threads(threads);
+            Set_Karatsuba_Threads(threads);
+            printf("FFT threads has been set to:\t %d\n", Get_FFT_Threads());
+            printf("Karatsuba threads has been set to:\t %d\n", Get_Karatsuba_Threads());
+            break;
+        case 7:
+            Threshold_Tuning();
+            break;
         default:
             break;
         }
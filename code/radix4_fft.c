@@ -0,0 +1,86 @@
+#include "radix4_fft.h"
+
+
+static void Radix4_Transform(FFT_Plan *plan, complex double *input,
+                                complex double *output, bool inverse) {
+    int n = plan->n;
+    // Same bit reversal as the radix-2 FFT, the radix-4 passes are two
+    // radix-2 stages each so they expect the same order
+    Plan_Bit_Reverse(plan, input, output);
+
+    int half = 1;
+    // With an odd number of stages the first stage is a plain radix-2 stage,
+    // its only twiddle factor is 1
+    if (plan->log2n & 1) {
+        complex double tmp;
+        for (int k = 0; k < n; k += 2) {
+            tmp = output[k];
+            output[k] = tmp + output[k + 1];
+            output[k + 1] = tmp - output[k + 1];
+        }
+        half = 2;
+    }
+
+    // -i for the forward transform and i for the inverse transform
+    complex double rotation = inverse ? I : -I;
+    complex double w1, w2, w3, a, b, c, d, sum_ab, difference_ab, sum_cd,
+                    difference_cd;
+    for (; half < n; half <<= 2) {
+        int segment_length = half << 2;
+        // w^j = e^{-i*TAU*j/segment_length} is every twiddle_stride'th twiddle
+        int twiddle_stride = n / segment_length;
+
+        for (int k = 0; k < n; k += segment_length) {
+            for (int j = 0; j < half; j++) {
+                w1 = Plan_Twiddle(plan, j * twiddle_stride);
+                w2 = Plan_Twiddle(plan, 2 * j * twiddle_stride);
+                w3 = Plan_Twiddle(plan, 3 * j * twiddle_stride);
+                if (inverse) {
+                    w1 = conj(w1);
+                    w2 = conj(w2);
+                    w3 = conj(w3);
+                }
+
+                complex double *segment = output + k + j;
+                a = segment[0];
+                b = w2 * segment[half];
+                c = w1 * segment[2 * half];
+                d = w3 * segment[3 * half];
+
+                // Radix-4 butterfly, only additions and the free rotation
+                sum_ab = a + b;
+                difference_ab = a - b;
+                sum_cd = c + d;
+                difference_cd = rotation * (c - d);
+
+                segment[0] = sum_ab + sum_cd;
+                segment[half] = difference_ab + difference_cd;
+                segment[2 * half] = sum_ab - sum_cd;
+                segment[3 * half] = difference_ab - difference_cd;
+            }
+        }
+    }
+}
+
+void Radix4_FFT_Plan(FFT_Plan *plan, complex double *input,
+                        complex double *output) {
+    Radix4_Transform(plan, input, output, false);
+}
+
+void Radix4_IFFT_Plan(FFT_Plan *plan, complex double *input,
+                        complex double *output) {
+    Radix4_Transform(plan, input, output, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < plan->n; i++) {
+        output[i] /= plan->n;
+    }
+}
+
+void Radix4_FFT(complex double *input, int n, complex double *output) {
+    Radix4_FFT_Plan(Get_FFT_Plan(n), input, output);
+}
+
+void Radix4_IFFT(complex double *input, int n, complex double *output) {
+    Radix4_IFFT_Plan(Get_FFT_Plan(n), input, output);
+}
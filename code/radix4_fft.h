@@ -0,0 +1,28 @@
+#ifndef RADIX4_FFT_H
+#define RADIX4_FFT_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+
+// Radix-4 FFT
+// After the bit reversal, a segment of length 4h holds four DFTs of length h
+// D0, D1, D2 and D3 of the samples with index 0, 2, 1 and 3 modulo 4. Two
+// radix-2 stages combine them as
+//     X[j]      = a + b + c + d
+//     X[j + h]  = a - b - i(c - d)
+//     X[j + 2h] = a + b - c - d
+//     X[j + 3h] = a - b + i(c - d)
+// with a = D0[j], b = w^{2j} D1[j], c = w^j D2[j], d = w^{3j} D3[j] and
+// w = e^{-i*TAU/4h}. Doing both stages in one pass halves the passes over
+// memory, and multiplying by -i is free, so a radix-4 butterfly needs 3
+// complex multiplications for 4 points where two radix-2 stages need 4.
+// When log2(n) is odd one radix-2 stage is done first.
+
+void Radix4_FFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Radix4_IFFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Radix4_FFT(complex double *input, int n, complex double *output);
+
+void Radix4_IFFT(complex double *input, int n, complex double *output);
+
+#endif
@@ -0,0 +1,89 @@
+#include "real_fft.h"
+
+
+void Real_FFT(Complex_Transform fft, double *input, int n,
+                complex double *output, complex double *work) {
+    int half = n >> 1;
+    // The twiddles e^{-i*TAU*k/n} come from the plan of the full length
+    complex double *twiddles = Get_FFT_Plan(n)->twiddles;
+
+    // Even samples in the real part and odd samples in the imaginary part
+    for (int m = 0; m < half; m++) {
+        work[m] = input[2 * m] + input[2 * m + 1] * I;
+    }
+    fft(work, half, output);
+
+    // Bin 0 and bin n/2 only depend on Z[0]: E[0] = Re(Z[0]), O[0] = Im(Z[0])
+    double even = creal(output[0]), odd = cimag(output[0]);
+    output[0] = even + odd;
+    output[half] = even - odd;
+
+    // Bin k and bin n/2 - k are built from the same two values of Z, so they
+    // are computed together which allows the split to be done in place
+    complex double z_k, z_mirror, even_k, odd_k, even_mirror, odd_mirror;
+    for (int k = 1; k <= half >> 1; k++) {
+        z_k = output[k];
+        z_mirror = output[half - k];
+
+        even_k = (z_k + conj(z_mirror)) * 0.5;
+        odd_k = (z_k - conj(z_mirror)) * -0.5 * I;
+        even_mirror = (z_mirror + conj(z_k)) * 0.5;
+        odd_mirror = (z_mirror - conj(z_k)) * -0.5 * I;
+
+        output[k] = even_k + twiddles[k] * odd_k;
+        output[half - k] = even_mirror + twiddles[half - k] * odd_mirror;
+    }
+}
+
+void Real_IFFT(Complex_Transform ifft, complex double *input, int n,
+                double *output, complex double *work) {
+    Real_IFFT_ext(ifft, input, n, output, work, Get_FFT_Plan(n)->twiddles);
+}
+
+void Real_IFFT_ext(Complex_Transform ifft, complex double *input, int n,
+                    double *output, complex double *work,
+                    const complex double *twiddles) {
+    int half = n >> 1;
+
+    // Undo the split of Real_FFT, E[k] and O[k] are recovered from X[k] and
+    // conj(X[n/2 - k]), and packed back together as Z[k] = E[k] + i*O[k]
+    complex double even = (input[0] + conj(input[half])) * 0.5;
+    complex double odd = (input[0] - conj(input[half])) * 0.5;
+    input[0] = even + odd * I;
+
+    complex double x_k, x_mirror, even_mirror, odd_mirror;
+    for (int k = 1; k <= half >> 1; k++) {
+        x_k = input[k];
+        x_mirror = input[half - k];
+
+        even = (x_k + conj(x_mirror)) * 0.5;
+        odd = (x_k - conj(x_mirror)) * 0.5 * conj(twiddles[k]);
+        even_mirror = (x_mirror + conj(x_k)) * 0.5;
+        odd_mirror = (x_mirror - conj(x_k)) * 0.5 * conj(twiddles[half - k]);
+
+        input[k] = even + odd * I;
+        input[half - k] = even_mirror + odd_mirror * I;
+    }
+
+    // Inverse transform of length n/2, the real and imaginary parts of the
+    // result are the even and odd samples
+    ifft(input, half, work);
+    for (int m = 0; m < half; m++) {
+        output[2 * m] = creal(work[m]);
+        output[2 * m + 1] = cimag(work[m]);
+    }
+}
+
+void Packed_Real_Product(complex double *spectrum, int n) {
+    // A[k] * B[k] = (Z[k] + conj(Z[n - k])) * (Z[k] - conj(Z[n - k])) / 4i
+    //             = (Z[k]^2 - conj(Z[n - k])^2) / 4i
+    // Only bins 0..n/2 are written and bin k only reads Z[k] and Z[n - k],
+    // where n - k is above n/2 for every k except 0 and n/2, so the
+    // product can overwrite the spectrum. Bin 0 is its own mirror
+    complex double z_k, z_mirror;
+    for (int k = 0; k <= n >> 1; k++) {
+        z_k = spectrum[k];
+        z_mirror = conj(spectrum[(k == 0) ? 0 : n - k]);
+        spectrum[k] = (z_k * z_k - z_mirror * z_mirror) * -0.25 * I;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef REAL_FFT_H
+#define REAL_FFT_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+
+// Real input transforms
+// A real sequence x of length n has a Hermitian spectrum, X[n - k] = conj(X[k]),
+// so only the bins 0..n/2 carry information. Packing the even samples into
+// the real part and the odd samples into the imaginary part,
+//     z[m] = x[2m] + i*x[2m + 1]
+// gives a complex sequence of length n/2 whose FFT Z can be split back into
+// the DFTs of the even and odd samples:
+//     E[k] = (Z[k] + conj(Z[n/2 - k])) / 2
+//     O[k] = (Z[k] - conj(Z[n/2 - k])) / 2i
+//     X[k] = E[k] + e^{-i*TAU*k/n} * O[k]
+// The same symmetry lets two real polynomials a and b share one complex FFT
+// of length n, z = a + i*b, since A[k] = (Z[k] + conj(Z[n - k])) / 2 and
+// B[k] = (Z[k] - conj(Z[n - k])) / 2i
+
+// Any complex transform with the (input, n, output) signature, e.g.
+// Iterative_FFT or Recursive_FFT
+typedef void (*Complex_Transform)(complex double *input, int n, complex double *output);
+
+// Forward transform of n real values, n must be a power of 2 and at least 2.
+// output gets the n/2 + 1 bins 0..n/2, work must hold n/2 values
+void Real_FFT(Complex_Transform fft, double *input, int n,
+                complex double *output, complex double *work);
+
+// Inverse of Real_FFT, input holds the bins 0..n/2 and is overwritten,
+// work must hold n/2 values
+void Real_IFFT(Complex_Transform ifft, complex double *input, int n,
+                double *output, complex double *work);
+
+// Real_IFFT with the twiddles e^{-i*TAU*k/n} for k = 0..n/2 given by the
+// caller, so any even n works as long as ifft can transform n/2 values
+void Real_IFFT_ext(Complex_Transform ifft, complex double *input, int n,
+                    double *output, complex double *work,
+                    const complex double *twiddles);
+
+// spectrum is the FFT of a + i*b for two real polynomials a and b. Replace
+// the bins 0..n/2 with the bins of the product A * B, ready for Real_IFFT.
+// n must be even
+void Packed_Real_Product(complex double *spectrum, int n);
+
+#endif
@@ -1,5 +1,21 @@
 #include "Recursive_fft.h"
-
+#include "parallel_fft.h"
+#include "fft_rounding.h"
+
+// Memory of Recursive_FFT and Recursive_IFFT, kept between calls and only
+// reallocated for a larger n
+static complex double *recursive_memory = NULL;
+static int recursive_memory_n = 0;
+
+// The 4 * n values used by Recursive_FFT_ext for a transform of size n
+static complex double *Recursive_Memory(int n) {
+    if (recursive_memory_n < n) {
+        free(recursive_memory);
+        recursive_memory = (complex double *)malloc((n << 2) * sizeof(complex double));
+        recursive_memory_n = n;
+    }
+    return recursive_memory;
+}
 
 
 // Extended FFT function with allocated_memory parameters
@@ -59,16 +75,19 @@ void Recursive_FFT_ext(complex double *input, int n, complex double *out,
 
 // FFT function to allocate memory and call actual FFT functionn
 void Recursive_FFT(complex double *input, int n, complex double *out) {
+    // Fork the recursion over several threads for large transforms
+    if (Use_Parallel_FFT(n)) {
+        Parallel_Recursive_FFT(input, n, out);
+        return;
+    }
+
     // Assign memory outside the recursive loop to save overhead
     // We need 4 arrays, in_even, in_odd, out_even and out_odd. Therefore we need 4 * n
-    int n_bitshifted = n << 2; // * 4
-    complex double *allocated_memory = (complex double *) malloc(n_bitshifted *
-                                        sizeof(complex double));
+    // The memory is reused by the next call
+    complex double *allocated_memory = Recursive_Memory(n);
     
     // Call the actual function
     Recursive_FFT_ext(input, n, out, allocated_memory, n);
-    free(allocated_memory);
-
 }
 
 // Extended IFFT function with allocated_memory parameters
@@ -121,14 +140,16 @@ void Recursive_IFFT_ext(complex double *input, int n, complex double *out,
 
 // IFFT function to allocate memory and call actual IFFT function
 void Recursive_IFFT(complex double *input, int n, complex double *out) {
+    if (Use_Parallel_FFT(n)) {
+        Parallel_Recursive_IFFT(input, n, out);
+        return;
+    }
+
     // Assign memory outside the recursive loop to save overhead
-    int n_bitshifted = n << 2; // * 4
-    complex double *allocated_memory = (complex double *)malloc(n_bitshifted *
-                                        sizeof(complex double));
+    complex double *allocated_memory = Recursive_Memory(n);
     
     // Call the actual function
     Recursive_IFFT_ext(input, n, out, allocated_memory, n);
-    free(allocated_memory);
 
     // Normalize the output by dividing by n
     for (int i = 0; i < n; i++) {
@@ -139,41 +160,53 @@ void Recursive_IFFT(complex double *input, int n, complex double *out) {
 
 double polynomial_multiply_Recursive_FFT(mpz_t a, mpz_t b, int n,
                                         int* recursive_fft_total_result) {
+    return polynomial_multiply_Recursive_FFT_ctx(a, b, n, recursive_fft_total_result,
+                                                    Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_Recursive_FFT_ctx(mpz_t a, mpz_t b, int n,
+                                            int* recursive_fft_total_result,
+                                            Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int max_n = context->max_n;
 
     // Pad the inputs with zeros, the polynomials are represented as arays
     // Padding ensures the data is clean
-    // Arrays help structure the data into parts
-    complex double padded_a[n], padded_b[n], fft_result[n];
-    memset(padded_a, 0, n * sizeof(complex double));
-    memset(padded_b, 0, n * sizeof(complex double));
-    memset(fft_result, 0, n * sizeof(complex double));
-
-    mpz_to_complex_array(a, padded_a);
-    mpz_to_complex_array(b, padded_b);
+    // Both polynomials are real, so they share one complex array with
+    // a in the real part and b in the imaginary part
+    complex double *packed = (complex double *)Context_Buffer(context, 0,
+                                max_n * sizeof(complex double));
+    complex double *spectrum = (complex double *)Context_Buffer(context, 1,
+                                max_n * sizeof(complex double));
+    complex double *work = (complex double *)Context_Buffer(context, 2,
+                            max_n * sizeof(complex double));
+    double *fft_result = (double *)Context_Buffer(context, 3, max_n * sizeof(double));
+    memset(packed, 0, n * sizeof(complex double));
+
+    mpz_to_double_array(a, (double *)packed, 2);
+    mpz_to_double_array(b, (double *)packed + 1, 2);
 
-    // // Apply FFT to both polynomials
-    complex double fa[n], fb[n];
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
-    Recursive_FFT(padded_a, n, fa);
-    Recursive_FFT(padded_b, n, fb);
 
-    // // Point-wise multiply the FFTs
-    for (int i = 0; i < n; i++) {
-        fa[i] *= fb[i];
-    }
+    // // Apply one FFT to both polynomials
+    Recursive_FFT(packed, n, spectrum);
 
-    // // Apply IFFT to get the product polynomial
-    Recursive_IFFT(fa, n, fft_result);
+    // // Point-wise multiply the FFTs, only the bins 0..n/2 are needed since
+    // the product is real
+    Packed_Real_Product(spectrum, n);
 
+    // // Apply the real IFFT, which only needs a transform of length n/2
+    Real_IFFT(Recursive_IFFT, spectrum, n, fft_result, work);
     clock_gettime(CLOCK_MONOTONIC, &end);
 
     double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
-    
-    // Perform the conversion from complex double to int by extracting the real part and rounding
-    for (int i = 0; i < n; i++) {
-        recursive_fft_total_result[i] = (int)round(creal(fft_result[i]));
+
+    // Perform the conversion from double to int by rounding, a product that
+    // came too close to a rounding error is redone exactly
+    if (!Round_FFT_Result(fft_result, n, recursive_fft_total_result)) {
+        elapsed_time += Exact_Fallback_Multiply(a, b, n, recursive_fft_total_result, context);
     }
-    
+
     return elapsed_time;
 }
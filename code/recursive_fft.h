@@ -1,6 +1,8 @@
 #ifndef FFT_H
 #define FFT_H
 #include "Helper_Functions.h"
+#include "real_fft.h"
+#include "multiply_context.h"
 
 
 // X0,...,N−1 ← ditfft2(x, N, s):             DFT of (x0, xs, x2s, ..., x(N-1)s):
@@ -21,11 +23,19 @@ void Recursive_FFT_ext(complex double *input, int n, complex double *out, comple
 
 void Recursive_IFFT_ext(complex double *input, int n, complex double *out, complex double *allocated_memory, int allocated_memory_size);
 
+// Transforms with the 4 * n values of scratch memory kept between calls, so
+// they must not run on two threads at the same time (Parallel_Recursive_FFT
+// allocates its own)
 void Recursive_FFT(complex double *input, int n, complex double *out);
 
 void Recursive_IFFT(complex double *input, int n, complex double *out);
 
 double polynomial_multiply_Recursive_FFT(mpz_t a, mpz_t b, int n, int* dft_total_result);
 
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_Recursive_FFT_ctx(mpz_t a, mpz_t b, int n,
+                                            int* recursive_fft_total_result,
+                                            Multiply_Context *context);
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "six_step_fft.h"
+
+// Plans created by Get_Six_Step_Plan, indexed by log2(n)
+static Six_Step_Plan *six_step_plan_cache[32];
+
+// Guards six_step_plan_cache, so threads can ask for plans at the same time
+static pthread_mutex_t six_step_plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Scratch buffers of a transform, slot 0 for the second buffer of the
+// transpose and slots 1 and 2 for the blocks of TRANSPOSE_BLOCK columns.
+// Every thread has one context per log2(n), as the row and column FFTs can
+// be six-step transforms themselves when the threshold is low. They are
+// freed when the thread exits
+static pthread_key_t six_step_work_key;
+static pthread_once_t six_step_work_once = PTHREAD_ONCE_INIT;
+
+// 0 until the threshold is computed or set
+static int six_step_threshold = 0;
+
+// L2 size used when sysconf does not know it
+#define DEFAULT_L2_CACHE_SIZE (1 << 20)
+
+
+Six_Step_Plan *Six_Step_Plan_Create(int n) {
+    Six_Step_Plan *six_step_plan = (Six_Step_Plan *)malloc(sizeof(Six_Step_Plan));
+    int log2n = log2(n);
+    six_step_plan->n = n;
+    six_step_plan->log2n1 = log2n / 2;
+    six_step_plan->n1 = 1 << six_step_plan->log2n1;
+    six_step_plan->n2 = n / six_step_plan->n1;
+    six_step_plan->coarse = (complex double *)malloc(six_step_plan->n2 *
+                                                        sizeof(complex double));
+    six_step_plan->fine = (complex double *)malloc(six_step_plan->n1 *
+                                                    sizeof(complex double));
+
+    // Both tables are computed directly, so a twiddle is the product of two
+    // accurate values and has no accumulated recurrence error. The coarse
+    // twiddles e^{-i*TAU*i/n2} are the ones of the plan of size n2, which
+    // are reflected from the first octant. cexp of the angles up to TAU
+    // would be off by up to 4 units of 2^-53 from the rounding of the angle
+    // alone, the products stay within 2.5 units up to n = 2^24
+    FFT_Plan *coarse_plan = Get_FFT_Plan(six_step_plan->n2);
+    for (int i = 0; i < six_step_plan->n2; i++) {
+        six_step_plan->coarse[i] = Plan_Twiddle(coarse_plan, i);
+    }
+    for (int i = 0; i < six_step_plan->n1; i++) {
+        six_step_plan->fine[i] = cexp(-I * TAU * i / n);
+    }
+    return six_step_plan;
+}
+
+void Six_Step_Plan_Free(Six_Step_Plan *six_step_plan) {
+    if (six_step_plan == NULL) {
+        return;
+    }
+    free(six_step_plan->coarse);
+    free(six_step_plan->fine);
+    free(six_step_plan);
+}
+
+Six_Step_Plan *Get_Six_Step_Plan(int n) {
+    int log2n = log2(n);
+    pthread_mutex_lock(&six_step_plan_cache_lock);
+    if (six_step_plan_cache[log2n] == NULL) {
+        six_step_plan_cache[log2n] = Six_Step_Plan_Create(n);
+    }
+    Six_Step_Plan *six_step_plan = six_step_plan_cache[log2n];
+    pthread_mutex_unlock(&six_step_plan_cache_lock);
+    return six_step_plan;
+}
+
+static void Six_Step_Work_Free(void *memory) {
+    Multiply_Context **work = (Multiply_Context **)memory;
+    for (int i = 0; i < 32; i++) {
+        Multiply_Context_Free(work[i]);
+    }
+    free(work);
+}
+
+static void Six_Step_Work_Key_Create() {
+    pthread_key_create(&six_step_work_key, Six_Step_Work_Free);
+}
+
+// The scratch context of the calling thread for size 2^log2n
+static Multiply_Context *Six_Step_Work(int log2n) {
+    pthread_once(&six_step_work_once, Six_Step_Work_Key_Create);
+    Multiply_Context **work = (Multiply_Context **)pthread_getspecific(six_step_work_key);
+    if (work == NULL) {
+        work = (Multiply_Context **)calloc(32, sizeof(Multiply_Context *));
+        pthread_setspecific(six_step_work_key, work);
+    }
+    if (work[log2n] == NULL) {
+        work[log2n] = Multiply_Context_Create(1 << log2n);
+    }
+    return work[log2n];
+}
+
+int Six_Step_Threshold() {
+    if (six_step_threshold == 0) {
+        long l2_cache_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (l2_cache_size <= 0) {
+            l2_cache_size = DEFAULT_L2_CACHE_SIZE;
+        }
+        // Measured on a 2 MB L2 the radix-2 engines keep up until n values
+        // are about twice the L2 size, the first stages still run in cache
+        int n = 1;
+        while (n * (long)sizeof(complex double) <= 2 * l2_cache_size) {
+            n <<= 1;
+        }
+        six_step_threshold = n;
+    }
+    return six_step_threshold;
+}
+
+void Set_Six_Step_Threshold(int n) {
+    six_step_threshold = n;
+}
+
+// Step 1 to 4 without the transposes: the columns of x are FFTed in blocks
+// of TRANSPOSE_BLOCK columns. A block is copied into column_block with
+// every column as one contiguous row, transformed into row_block, and
+// written back as columns multiplied by the twiddles. Every row of x is
+// read and written in runs of TRANSPOSE_BLOCK values, and the block of
+// n1 x TRANSPOSE_BLOCK values stays in the cache while it is transformed
+static void Column_Transforms(Six_Step_Plan *six_step_plan, complex double *input,
+                                complex double *output, bool inverse,
+                                Multiply_Context *scratch) {
+    int n1 = six_step_plan->n1, n2 = six_step_plan->n2;
+    int log2n1 = six_step_plan->log2n1, fine_mask = n1 - 1;
+    int block = (n2 < TRANSPOSE_BLOCK) ? n2 : TRANSPOSE_BLOCK;
+    size_t block_bytes = (size_t)block * n1 * sizeof(complex double);
+    complex double *column_block = (complex double *)Context_Buffer(scratch, 1, block_bytes);
+    complex double *row_block = (complex double *)Context_Buffer(scratch, 2, block_bytes);
+    complex double w;
+
+    for (int first = 0; first < n2; first += block) {
+        for (int j1 = 0; j1 < n1; j1++) {
+            for (int c = 0; c < block; c++) {
+                column_block[c * n1 + j1] = input[j1 * n2 + first + c];
+            }
+        }
+        for (int c = 0; c < block; c++) {
+            if (inverse) {
+                FFT_Inverse(column_block + c * n1, n1, row_block + c * n1);
+            } else {
+                FFT_Forward(column_block + c * n1, n1, row_block + c * n1);
+            }
+        }
+        // Element (k1, j2) gets the twiddle W_n^(j2*k1), the product is below
+        // n so it never wraps around the circle
+        for (int k1 = 0; k1 < n1; k1++) {
+            for (int c = 0; c < block; c++) {
+                int m = (first + c) * k1;
+                w = six_step_plan->coarse[m >> log2n1] *
+                    six_step_plan->fine[m & fine_mask];
+                if (inverse) {
+                    w = conj(w);
+                }
+                output[k1 * n2 + first + c] = row_block[c * n1 + k1] * w;
+            }
+        }
+    }
+}
+
+static void Six_Step_Transform(complex double *input, int n,
+                                complex double *output, bool inverse) {
+    // Too small to split into a matrix
+    if (n < 4) {
+        if (inverse) {
+            Iterative_IFFT(input, n, output);
+        } else {
+            Iterative_FFT(input, n, output);
+        }
+        return;
+    }
+
+    Six_Step_Plan *six_step_plan = Get_Six_Step_Plan(n);
+    int n1 = six_step_plan->n1, n2 = six_step_plan->n2;
+    Multiply_Context *scratch = Six_Step_Work(log2(n));
+    complex double *work = (complex double *)Context_Buffer(scratch, 0,
+                                                            n * sizeof(complex double));
+
+    // Step 1 to 4: column FFTs of length n1 with the twiddles, x stays an
+    // n1 x n2 matrix so the first two transposes are not needed
+    Column_Transforms(six_step_plan, input, output, inverse, scratch);
+    // Step 5: n1 FFTs of length n2 on the rows. These are inverse
+    // transforms for the IFFT, so the normalisation by n1 and n2 gives the
+    // division by n
+    for (int k1 = 0; k1 < n1; k1++) {
+        if (inverse) {
+            FFT_Inverse(output + k1 * n2, n2, work + k1 * n2);
+        } else {
+            FFT_Forward(output + k1 * n2, n2, work + k1 * n2);
+        }
+    }
+    // Step 6: transpose to n2 x n1, element (k2, k1) is X[k1 + n1*k2]
+    Transpose_Blocked(work, n1, n2, output);
+}
+
+void Six_Step_FFT(complex double *input, int n, complex double *output) {
+    Six_Step_Transform(input, n, output, false);
+}
+
+void Six_Step_IFFT(complex double *input, int n, complex double *output) {
+    Six_Step_Transform(input, n, output, true);
+}
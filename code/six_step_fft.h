@@ -0,0 +1,57 @@
+#ifndef SIX_STEP_FFT_H
+#define SIX_STEP_FFT_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+#include "multiply_context.h"
+
+// Six-step FFT, Bailey "FFTs in external or hierarchical memory"
+// Once n values no longer fit in the cache every stage of the radix-2 loop
+// streams the whole array from memory. The six-step FFT writes n = n1 * n2
+// with n1, n2 close to sqrt(n), so index j = j1 * n2 + j2 and k = k1 + n1 * k2:
+//     X[k1 + n1*k2] = sum_j2 W_n2^(j2*k2) * W_n^(j2*k1) * sum_j1 x[j1*n2 + j2] * W_n1^(j1*k1)
+// which is computed as
+//     1. transpose the n1 x n2 matrix x to n2 x n1
+//     2. n2 FFTs of length n1 on the rows
+//     3. multiply element (j2, k1) by the twiddle W_n^(j2*k1)
+//     4. transpose to n1 x n2
+//     5. n1 FFTs of length n2 on the rows
+//     6. transpose to n2 x n1, which is X in natural order
+// The small FFTs stay in the cache, so the whole array only passes through
+// memory a few times instead of log2(n) times. Step 1 to 4 are done as one
+// pass: blocks of columns are copied into a buffer, transformed, and written
+// back with the twiddles (the "four-step" form), and step 6 is a cache
+// blocked transpose.
+
+typedef struct {
+    int n;
+    int n1;                 // Rows of the input matrix, 2^floor(log2(n)/2)
+    int n2;                 // Columns of the input matrix, n / n1
+    int log2n1;
+    // W_n^m for m < n is coarse[m >> log2n1] * fine[m & (n1 - 1)], the two
+    // tables take O(sqrt(n)) memory instead of a full n x n twiddle table
+    complex double *coarse; // coarse[i] = e^{-i*TAU*i*n1/n} for i < n2
+    complex double *fine;   // fine[i] = e^{-i*TAU*i/n} for i < n1
+} Six_Step_Plan;
+
+Six_Step_Plan *Six_Step_Plan_Create(int n);
+
+void Six_Step_Plan_Free(Six_Step_Plan *six_step_plan);
+
+// Cached plan for size n, created on first use
+Six_Step_Plan *Get_Six_Step_Plan(int n);
+
+// Size from which FFT_Forward and FFT_Inverse use the six-step FFT. It is
+// the first size where n complex values take more than twice the L2 cache,
+// from sysconf when the C library knows the cache size
+int Six_Step_Threshold();
+
+// Override the threshold, 0 goes back to the cache derived value
+void Set_Six_Step_Threshold(int n);
+
+// The second buffer of the transpose and the column blocks are scratch
+// buffers of the calling thread, so threads can share the cached plans
+void Six_Step_FFT(complex double *input, int n, complex double *output);
+
+void Six_Step_IFFT(complex double *input, int n, complex double *output);
+
+#endif
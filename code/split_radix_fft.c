@@ -0,0 +1,74 @@
+#include "split_radix_fft.h"
+
+
+// Transform of length n of input[0], input[stride], ..., input[(n-1)*stride]
+// into output[0..n-1]. stride * n is always the plan size, so the twiddle
+// e^{-i*TAU*k/n} is the plan twiddle k * stride
+static void Split_Radix_Recursive(FFT_Plan *plan, complex double *input,
+                                    int stride, complex double *output, int n,
+                                    bool inverse) {
+    if (n == 1) {
+        output[0] = input[0];
+        return;
+    }
+    if (n == 2) {
+        complex double a = input[0], b = input[stride];
+        output[0] = a + b;
+        output[1] = a - b;
+        return;
+    }
+
+    int half = n >> 1, quarter = n >> 2;
+    // U in the first half, Z in the third quarter and Z' in the last quarter
+    // of the output, which are exactly the positions the butterflies update
+    Split_Radix_Recursive(plan, input, stride << 1, output, half, inverse);
+    Split_Radix_Recursive(plan, input + stride, stride << 2, output + half,
+                            quarter, inverse);
+    Split_Radix_Recursive(plan, input + 3 * stride, stride << 2,
+                            output + half + quarter, quarter, inverse);
+
+    complex double rotation = inverse ? I : -I;
+    complex double w1, w3, z, z_prime, sum, difference, u0, u1;
+    for (int k = 0; k < quarter; k++) {
+        w1 = Plan_Twiddle(plan, k * stride);
+        w3 = Plan_Twiddle(plan, 3 * k * stride);
+        if (inverse) {
+            w1 = conj(w1);
+            w3 = conj(w3);
+        }
+        z = w1 * output[half + k];
+        z_prime = w3 * output[half + quarter + k];
+        sum = z + z_prime;
+        difference = rotation * (z - z_prime);
+
+        u0 = output[k];
+        u1 = output[k + quarter];
+        output[k] = u0 + sum;
+        output[k + half] = u0 - sum;
+        output[k + quarter] = u1 + difference;
+        output[k + half + quarter] = u1 - difference;
+    }
+}
+
+void Split_Radix_FFT_Plan(FFT_Plan *plan, complex double *input,
+                            complex double *output) {
+    Split_Radix_Recursive(plan, input, 1, output, plan->n, false);
+}
+
+void Split_Radix_IFFT_Plan(FFT_Plan *plan, complex double *input,
+                            complex double *output) {
+    Split_Radix_Recursive(plan, input, 1, output, plan->n, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < plan->n; i++) {
+        output[i] /= plan->n;
+    }
+}
+
+void Split_Radix_FFT(complex double *input, int n, complex double *output) {
+    Split_Radix_FFT_Plan(Get_FFT_Plan(n), input, output);
+}
+
+void Split_Radix_IFFT(complex double *input, int n, complex double *output) {
+    Split_Radix_IFFT_Plan(Get_FFT_Plan(n), input, output);
+}
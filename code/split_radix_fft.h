@@ -0,0 +1,27 @@
+#ifndef SPLIT_RADIX_FFT_H
+#define SPLIT_RADIX_FFT_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+
+// Split-radix FFT
+// The DFT is split into one half length DFT U of the even samples and two
+// quarter length DFTs Z and Z' of the samples with index 1 and 3 modulo 4:
+//     X[k]          = U[k]       + (w^k Z[k] + w^{3k} Z'[k])
+//     X[k + n/2]    = U[k]       - (w^k Z[k] + w^{3k} Z'[k])
+//     X[k + n/4]    = U[k + n/4] - i(w^k Z[k] - w^{3k} Z'[k])
+//     X[k + 3n/4]   = U[k + n/4] + i(w^k Z[k] - w^{3k} Z'[k])
+// with w = e^{-i*TAU/n}. This has the lowest operation count of the power of
+// 2 algorithms (about 4 n log2(n) real operations against 5 n log2(n) for
+// radix-2). The recursion reads the input with a stride, so no bit reversal
+// pass is needed, and it works depth first so the small transforms stay in
+// cache.
+
+void Split_Radix_FFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Split_Radix_IFFT_Plan(FFT_Plan *plan, complex double *input, complex double *output);
+
+void Split_Radix_FFT(complex double *input, int n, complex double *output);
+
+void Split_Radix_IFFT(complex double *input, int n, complex double *output);
+
+#endif
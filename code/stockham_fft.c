@@ -0,0 +1,87 @@
+#include "stockham_fft.h"
+
+// Plans created by Get_Stockham_Plan, indexed by log2(n)
+static Stockham_Plan *stockham_plan_cache[32];
+
+
+Stockham_Plan *Stockham_Plan_Create(int n) {
+    Stockham_Plan *stockham_plan = (Stockham_Plan *)malloc(sizeof(Stockham_Plan));
+    stockham_plan->plan = Get_FFT_Plan(n);
+    stockham_plan->work = (complex double *)malloc(n * sizeof(complex double));
+    return stockham_plan;
+}
+
+void Stockham_Plan_Free(Stockham_Plan *stockham_plan) {
+    if (stockham_plan == NULL) {
+        return;
+    }
+    free(stockham_plan->work);
+    free(stockham_plan);
+}
+
+Stockham_Plan *Get_Stockham_Plan(int n) {
+    int log2n = log2(n);
+    if (stockham_plan_cache[log2n] == NULL) {
+        stockham_plan_cache[log2n] = Stockham_Plan_Create(n);
+    }
+    return stockham_plan_cache[log2n];
+}
+
+static void Stockham_Transform(complex double *input, int n,
+                                complex double *output, bool inverse) {
+    Stockham_Plan *stockham_plan = Get_Stockham_Plan(n);
+    FFT_Plan *plan = stockham_plan->plan;
+    if (n == 1) {
+        output[0] = input[0];
+        return;
+    }
+
+    // The last stage has to write into output, so the first stage writes
+    // into output when the number of stages is odd and into work otherwise
+    complex double *x = input;
+    complex double *y = (plan->log2n & 1) ? output : stockham_plan->work;
+    complex double *other = (y == output) ? stockham_plan->work : output;
+
+    complex double w, a, b;
+    int stride = 1;
+    for (int length = n; length > 1; length >>= 1) {
+        int half = length >> 1;
+        for (int p = 0; p < half; p++) {
+            // e^{-i*TAU*p/length} is plan twiddle p * stride since
+            // length * stride = n
+            w = plan->twiddles[p * stride];
+            if (inverse) {
+                w = conj(w);
+            }
+            complex double *x_top = x + stride * p;
+            complex double *x_bottom = x + stride * (p + half);
+            complex double *y_even = y + stride * 2 * p;
+            complex double *y_odd = y_even + stride;
+            // The inner loop runs over consecutive memory in all 4 arrays
+            for (int q = 0; q < stride; q++) {
+                a = x_top[q];
+                b = x_bottom[q];
+                y_even[q] = a + b;
+                y_odd[q] = (a - b) * w;
+            }
+        }
+        // The output of this stage is the input of the next one
+        x = y;
+        y = other;
+        other = x;
+        stride <<= 1;
+    }
+}
+
+void Stockham_FFT(complex double *input, int n, complex double *output) {
+    Stockham_Transform(input, n, output, false);
+}
+
+void Stockham_IFFT(complex double *input, int n, complex double *output) {
+    Stockham_Transform(input, n, output, true);
+
+    // Normalize the output by dividing by n
+    for (int i = 0; i < n; i++) {
+        output[i] /= n;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef STOCKHAM_FFT_H
+#define STOCKHAM_FFT_H
+#include "Helper_Functions.h"
+#include "iterative_fft.h"
+
+// Stockham autosort FFT
+// The Cooley-Tukey FFT reorders the input with a bit reversal before the
+// first stage. The Stockham formulation instead lets every stage write its
+// butterflies to a second buffer in an order that already sorts the data,
+// with n_s = n / 2^s and stride 2^s in stage s:
+//     y[q + stride*(2p)]     = x[q + stride*p] + x[q + stride*(p + n_s/2)]
+//     y[q + stride*(2p + 1)] = (x[q + stride*p] - x[q + stride*(p + n_s/2)]) * w^p
+// with w = e^{-i*TAU/n_s}. After log2(n) stages the result is in natural
+// order, so there is no permutation pass and every stage reads and writes
+// memory sequentially. The price is a second buffer of n values, the stages
+// ping-pong between the output and the plan work buffer.
+
+typedef struct {
+    FFT_Plan *plan;         // Shared twiddle table
+    // Second buffer of the ping-pong, so one plan must not be executed by
+    // two threads at the same time
+    complex double *work;
+} Stockham_Plan;
+
+Stockham_Plan *Stockham_Plan_Create(int n);
+
+void Stockham_Plan_Free(Stockham_Plan *stockham_plan);
+
+// Cached plan for size n, created on first use
+Stockham_Plan *Get_Stockham_Plan(int n);
+
+void Stockham_FFT(complex double *input, int n, complex double *output);
+
+void Stockham_IFFT(complex double *input, int n, complex double *output);
+
+#endif
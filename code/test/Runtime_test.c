@@ -12,14 +12,29 @@ void Runtime_test(int n, int iterations) {
 
     // Set up timers
     double time_default = 0.0, time_standard = 0.0, time_dft = 0.0, time_fft = 0.0,
-            time_iterative_fft = 0.0, time_karatsuba = 0.0;
+            time_iterative_fft = 0.0, time_karatsuba = 0.0, time_ntt = 0.0,
+            time_toom = 0.0, time_mixed_radix = 0.0;
     struct timespec start, end;
     double elapsed_time;
 
     // Loop through the test multiple times to allow bigger tests
     // Also allows us to test n size vs iterations and their effect
-    int naive_result[n], dft_result[n], karatsuba_result[n],
-        recursive_FFT_result[n], iterative_FFT_result[n];
+    // The result arrays are on the heap, n ints each would overflow the
+    // stack for large n
+    int *naive_result = (int *)malloc(n * sizeof(int));
+    int *dft_result = (int *)malloc(n * sizeof(int));
+    int *karatsuba_result = (int *)malloc(n * sizeof(int));
+    int *recursive_FFT_result = (int *)malloc(n * sizeof(int));
+    int *iterative_FFT_result = (int *)malloc(n * sizeof(int));
+    int *ntt_result = (int *)malloc(n * sizeof(int));
+    int *toom_result = (int *)malloc(n * sizeof(int));
+    int *mixed_radix_result = (int *)malloc(n * sizeof(int));
+
+    // Create the FFT plan and the multiplication context once before the
+    // loop, every iteration reuses them so the twiddle table setup and the
+    // buffer allocation are not part of the measured time
+    Get_FFT_Plan(n);
+    Get_Default_Multiply_Context(n);
     
     for (int i = 1; i <= iterations; i++) {
         mpz_inits(random_Value_a, random_Value_b, NULL);
@@ -29,6 +44,9 @@ void Runtime_test(int n, int iterations) {
         memset(dft_result, 0, n * sizeof(int));
         memset(recursive_FFT_result, 0, n * sizeof(int));
         memset(iterative_FFT_result, 0, n * sizeof(int));
+        memset(ntt_result, 0, n * sizeof(int));
+        memset(toom_result, 0, n * sizeof(int));
+        memset(mixed_radix_result, 0, n * sizeof(int));
 
         // Generate a random number with n bits
         mpz_urandomb(random_Value_a, state, n);
@@ -40,6 +58,9 @@ void Runtime_test(int n, int iterations) {
         // Karatsuba test
         time_karatsuba += polynomial_multiply_karatsuba(random_Value_a, random_Value_b, n, karatsuba_result);
 
+        // Toom-Cook test
+        time_toom += polynomial_multiply_toom(random_Value_a, random_Value_b, n, toom_result);
+
         // DFT TEST
         time_dft += polynomial_multiply_DFT(random_Value_a, random_Value_b,
                                             n, dft_result);
@@ -50,10 +71,19 @@ void Runtime_test(int n, int iterations) {
         // Iterative FFT test
         time_iterative_fft += polynomial_multiply_iterative_FFT(random_Value_a, random_Value_b, n, iterative_FFT_result);
 
+        // Mixed-radix FFT test
+        time_mixed_radix += polynomial_multiply_mixed_radix(random_Value_a, random_Value_b, n, mixed_radix_result);
+
+        // NTT test
+        time_ntt += polynomial_multiply_NTT(random_Value_a, random_Value_b, n, ntt_result);
+
         if (Polynomial_Correctness(naive_result, karatsuba_result, n)  &&
             Polynomial_Correctness(naive_result, dft_result, n)  &&
             Polynomial_Correctness(naive_result, recursive_FFT_result, n)  &&
-            Polynomial_Correctness(naive_result, iterative_FFT_result, n)){
+            Polynomial_Correctness(naive_result, iterative_FFT_result, n)  &&
+            Polynomial_Correctness(naive_result, ntt_result, n)  &&
+            Polynomial_Correctness(naive_result, toom_result, n)  &&
+            Polynomial_Correctness(naive_result, mixed_radix_result, n)){
                 success++;
         }else{
             fail ++;
@@ -69,9 +99,20 @@ void Runtime_test(int n, int iterations) {
     printf("standard polynomial multiplication time:\t%f seconds.\n", time_standard);
     printf("DFT polynomial multiplication time:\t\t%f seconds.\n", time_dft);
     printf("Karatsuba polynomial multiplication time:\t%f seconds.\n", time_karatsuba);
+    printf("Toom-Cook polynomial multiplication time:\t%f seconds.\n", time_toom);
     printf("Recursive_FFT polynomial multiplication time:\t%f seconds.\n", time_fft);
     printf("Iterative_FFT polynomial multiplication time:\t%f seconds.\n", time_iterative_fft);
+    printf("Mixed-radix FFT polynomial multiplication time:\t%f seconds.\n", time_mixed_radix);
+    printf("NTT polynomial multiplication time:\t\t%f seconds.\n", time_ntt);
     
     gmp_randclear(state);
+    free(naive_result);
+    free(dft_result);
+    free(karatsuba_result);
+    free(recursive_FFT_result);
+    free(iterative_FFT_result);
+    free(ntt_result);
+    free(toom_result);
+    free(mixed_radix_result);
 
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "../Helper_Functions.h"
 #include "../Recursive_fft.h"
 #include "../iterative_fft.h"
+#include "../mixed_radix_fft.h"
+#include "../ntt.h"
 #include "../dft.h"
 #include "../karatsuba.h"
+#include "../toom_cook.h"
 #include "../Naive_Polynomial_Multiplication.h"
 #include <check.h>
 
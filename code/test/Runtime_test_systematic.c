@@ -1,126 +1,311 @@
+// sched_setaffinity and the CPU_SET macros
+#define _GNU_SOURCE
+#include <sched.h>
 #include "Runtime_test_systematic.h"
 
-void Runtime_test_systematic() {
-    // Set up correctness meassure
-    int fail = 0, n = 0;
-    mpz_t random_Value_a, random_Value_b;
+typedef double (*Multiply_Function)(mpz_t a, mpz_t b, int n, int *result);
 
-    // Seed the random state with current time
-    gmp_randstate_t state;
-    gmp_randinit_default(state);
-    gmp_randseed_ui(state, time(NULL));
+// Operations of one multiplication of size n, for the GFLOPS estimate
+typedef double (*Operation_Count)(int n);
 
-    // Set up timers
-    double time_naive = 0.0, time_dft = 0.0, time_fft = 0.0,
-            time_iterative_fft = 0.0, time_karatsuba = 0.0;
+typedef struct {
+    const char *name;
+    Multiply_Function multiply;
+    Operation_Count operations;
+} Benchmark_Algorithm;
 
+typedef struct {
+    int samples;
+    double min, median, median_low, median_high, p95, p99;
+} Benchmark_Statistics;
 
-    // Open the file in write mode ("w")
-    FILE *file;
-    file = fopen("test/Computation_times.txt", "w");
 
-    // Check if the file was opened successfully
-    if (file == NULL) {
-        printf("Error opening file!\n");
-        exit(1);
+static double Naive_Operations(int n) {
+    double digits = n / 2.0;
+    return 2 * digits * digits;
+}
+
+static double DFT_Operations(int n) {
+    // Two forward DFTs and one inverse, a complex multiply and add per term
+    return 3 * 8.0 * n * (double)n;
+}
+
+// The sums and the subtractions of every level and the schoolbook products
+// at the cutoff
+static double Karatsuba_Length_Operations(double length, int cutoff) {
+    if (length <= cutoff) {
+        return 2 * length * length;
     }
-    int max_n_size = 16;
-    int n_array[20];
-
-    float naive_time_array[20], karatsuba_time_array[20], dft_time_array[20], recursive_fft_time_array[20], iterative_fft_time_array[20];
-    for (int i = 1; i <= max_n_size; i++) {
-        n = pow(2, i);
-        n_array[i] = n;
-        // Allocate memory in each iteration for new n value,
-        // Using Realloc will cause issues if more iterations are being done
-        int* naive_result = (int *)malloc(n * sizeof(int));
-        int* dft_result = (int *)malloc(n * sizeof(int));
-        int* karatsuba_result = (int *)malloc(n * sizeof(int));
-        int* recursive_FFT_result = (int *)malloc(n * sizeof(int));
-        int* iterative_FFT_result = (int *)malloc(n * sizeof(int));
-
-
-        // Set all the relevant memory to 0 for clean test
-        memset(naive_result, 0, n * sizeof(int));
-        memset(karatsuba_result, 0, n * sizeof(int));
-        memset(dft_result, 0, n * sizeof(int));
-        memset(recursive_FFT_result, 0, n * sizeof(int));
-        memset(iterative_FFT_result, 0, n * sizeof(int));
-
-
-        // Generate a random number with n bits
-        mpz_inits(random_Value_a, random_Value_b, NULL);
-        mpz_urandomb(random_Value_a, state, n);
-        mpz_urandomb(random_Value_b, state, n);
-
-        // Standard TEST
-        time_naive = Polynomial_Multiply_Naive(random_Value_a, random_Value_b, n, naive_result);
-        naive_time_array[i] = time_naive;
-
-        // DFT TEST
-        time_dft = polynomial_multiply_DFT(random_Value_a, random_Value_b, n, dft_result);
-        dft_time_array[i] = time_dft;
-
-        // Recursive FFT test
-        time_fft = polynomial_multiply_Recursive_FFT(random_Value_a, random_Value_b, n, recursive_FFT_result);
-        recursive_fft_time_array[i] = time_fft;
-
-        // Iterative FFT test
-        time_iterative_fft = polynomial_multiply_iterative_FFT(random_Value_a, random_Value_b, n, iterative_FFT_result);
-        iterative_fft_time_array[i] = time_iterative_fft;
-
-        // Karatsuba test
-        time_karatsuba = polynomial_multiply_karatsuba(random_Value_a, random_Value_b, n, karatsuba_result);
-        karatsuba_time_array[i] = time_karatsuba;
-
-        // DFT can be removed on second line if it's to slow
-        if (Polynomial_Correctness(naive_result, karatsuba_result, n)  &&
-            Polynomial_Correctness(naive_result, dft_result, n)  &&
-            Polynomial_Correctness(naive_result, recursive_FFT_result, n)  &&
-            Polynomial_Correctness(naive_result, iterative_FFT_result, n)){     
-        }else{
-            exit(1);
-        }
+    double half = ceil(length / 2);
+    return 3 * Karatsuba_Length_Operations(half, cutoff) + 8 * half;
+}
+
+static double Karatsuba_Operations(int n) {
+    return Karatsuba_Length_Operations(n / 2.0, Get_Karatsuba_Cutoff());
+}
 
-        // Free the memory so we can malloc it again and have clean data
-        free(naive_result);
-        free(dft_result);
-        free(karatsuba_result);
-        free(recursive_FFT_result);
-        free(iterative_FFT_result);
-        mpz_clears(random_Value_a, random_Value_b, NULL);
+static double FFT_Operations(int n) {
+    // The packed forward transform of length n, the real inverse of length
+    // n/2 and the splitting of the spectra around them
+    return 5.0 * n * log2(n) + 5.0 * (n / 2) * log2(n / 2) + 10.0 * n;
+}
+
+static double NTT_Operations(int n) {
+    // Three transforms of n/2 * log2(n) butterflies of a multiply, an add
+    // and a subtract, and the point-wise products
+    return 3 * 3.0 * (n / 2) * log2(n) + 2.0 * n;
+}
 
-        Loading_Screen(max_n_size, i);
+static const Benchmark_Algorithm benchmark_algorithms[] = {
+    {"Naive", Polynomial_Multiply_Naive, Naive_Operations},
+    {"DFT", polynomial_multiply_DFT, DFT_Operations},
+    {"Karatsuba", polynomial_multiply_karatsuba, Karatsuba_Operations},
+    {"Recursive_FFT", polynomial_multiply_Recursive_FFT, FFT_Operations},
+    {"Iterative_FFT", polynomial_multiply_iterative_FFT, FFT_Operations},
+    {"NTT", polynomial_multiply_NTT, NTT_Operations},
+};
+
+#define BENCHMARK_ALGORITHMS (int)(sizeof(benchmark_algorithms) / sizeof(benchmark_algorithms[0]))
+
+
+Benchmark_Config Default_Benchmark_Config() {
+    Benchmark_Config config;
+    config.min_log2n = 1;
+    config.max_log2n = 20;
+    config.warmup = 3;
+    config.repeats = 31;
+    config.time_budget = 1.0;
+    config.cpu = -1;
+    config.format = BENCHMARK_FORMAT_CSV;
+    config.path = BENCHMARK_FILE;
+    return config;
+}
+
+static double Wall_Time() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+static int Compare_Doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank percentile of sorted samples
+static double Percentile(const double *sorted, int count, double percent) {
+    int rank = (int)ceil(percent / 100 * count);
+    return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+static Benchmark_Statistics Statistics(double *samples, int count) {
+    Benchmark_Statistics statistics;
+    qsort(samples, count, sizeof(double), Compare_Doubles);
+    statistics.samples = count;
+    statistics.min = samples[0];
+    statistics.median = (count & 1) ? samples[count / 2] :
+                        (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    // The number of samples below the median is binomial(count, 1/2), so
+    // the order statistics count/2 -+ 1.96 * sqrt(count)/2 enclose it 95%
+    // of the time
+    int low = (int)floor(count / 2.0 - 0.98 * sqrt(count));
+    int high = (int)ceil(count / 2.0 + 0.98 * sqrt(count));
+    statistics.median_low = samples[(low > 0) ? low : 0];
+    statistics.median_high = samples[(high < count - 1) ? high : count - 1];
+    statistics.p95 = Percentile(samples, count, 95);
+    statistics.p99 = Percentile(samples, count, 99);
+    return statistics;
+}
+
+static void Write_Header(FILE *file, Benchmark_Config config) {
+    if (config.format == BENCHMARK_FORMAT_CSV) {
+        fprintf(file, "algorithm,n,samples,min_s,median_s,median_ci_low_s,median_ci_high_s,"
+                        "p95_s,p99_s,ns_per_coefficient,gflops,correct\n");
+    } else {
+        fprintf(file, "{\n  \"config\": {\"warmup\": %d, \"repeats\": %d, "
+                        "\"time_budget_s\": %g, \"cpu\": %d},\n  \"results\": [",
+                config.warmup, config.repeats, config.time_budget, config.cpu);
     }
-    gmp_randclear(state);
+}
+
+static void Write_Row(FILE *file, Benchmark_Config config, bool first,
+                        const Benchmark_Algorithm *algorithm, int n,
+                        Benchmark_Statistics statistics, bool correct) {
+    double ns_per_coefficient = statistics.median / n * 1e9;
+    double gflops = algorithm->operations(n) / statistics.median / 1e9;
+    if (statistics.median <= 0) {
+        gflops = 0;
+    }
+    if (config.format == BENCHMARK_FORMAT_CSV) {
+        fprintf(file, "%s,%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.6g,%.6g,%d\n",
+                algorithm->name, n, statistics.samples, statistics.min, statistics.median,
+                statistics.median_low, statistics.median_high, statistics.p95,
+                statistics.p99, ns_per_coefficient, gflops, correct);
+    } else {
+        fprintf(file, "%s\n    {\"algorithm\": \"%s\", \"n\": %d, \"samples\": %d, "
+                "\"min_s\": %.9g, \"median_s\": %.9g, \"median_ci_low_s\": %.9g, "
+                "\"median_ci_high_s\": %.9g, \"p95_s\": %.9g, \"p99_s\": %.9g, "
+                "\"ns_per_coefficient\": %.6g, \"gflops\": %.6g, \"correct\": %s}",
+                first ? "" : ",", algorithm->name, n, statistics.samples, statistics.min,
+                statistics.median, statistics.median_low, statistics.median_high,
+                statistics.p95, statistics.p99, ns_per_coefficient, gflops,
+                correct ? "true" : "false");
+    }
+}
+
+static bool Pin_To_Cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // Threads created later inherit the mask, so the parallel engines run on
+    // this cpu as well
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("sched_setaffinity");
+        return false;
+    }
+    return true;
+}
 
-    // Print to file that Python code can read
-    putchar('\n');
-    fprintf(file, "n_size:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%d ", n_array[i]);
+bool Runtime_Benchmark(Benchmark_Config config) {
+    if (config.cpu >= 0 && !Pin_To_Cpu(config.cpu)) {
+        return false;
     }
-    fprintf(file, "\nNaive multiplication:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%f ", naive_time_array[i]);
+    FILE *file = fopen(config.path, "w");
+    if (file == NULL) {
+        perror(config.path);
+        return false;
     }
-    fprintf(file, "\nDFT multiplication:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%f ", dft_time_array[i]);
+    if (config.repeats < 1) {
+        config.repeats = 1;
     }
-    fprintf(file, "\nKaratsuba multiplication:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%f ", karatsuba_time_array[i]);
+    Write_Header(file, config);
+
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, BENCHMARK_SEED);
+    mpz_t a, b;
+    mpz_inits(a, b, NULL);
+    double *samples = (double *)malloc(config.repeats * sizeof(double));
+    // Median of the previous size, to predict the next one
+    double previous[BENCHMARK_ALGORITHMS];
+    bool active[BENCHMARK_ALGORITHMS];
+    for (int i = 0; i < BENCHMARK_ALGORITHMS; i++) {
+        previous[i] = 0;
+        active[i] = true;
+    }
+    bool first = true, all_correct = true;
+
+    for (int log2n = config.min_log2n; log2n <= config.max_log2n; log2n++) {
+        int n = 1 << log2n;
+        // n/2 digits, so the product fits in the n coefficients
+        int digits = (n / 2 > 0) ? n / 2 : 1;
+        Random_Digits(a, state, digits);
+        Random_Digits(b, state, digits);
+        int *expected = (int *)calloc(n, sizeof(int));
+        int *result = (int *)calloc(n, sizeof(int));
+        polynomial_multiply_NTT(a, b, n, expected);
+
+        for (int i = 0; i < BENCHMARK_ALGORITHMS; i++) {
+            if (!active[i]) {
+                continue;
+            }
+            const Benchmark_Algorithm *algorithm = &benchmark_algorithms[i];
+
+            // The budget counts the whole calls, conversions included
+            double spent = 0;
+            for (int run = 0; run < config.warmup && spent < config.time_budget; run++) {
+                double start = Wall_Time();
+                algorithm->multiply(a, b, n, result);
+                spent += Wall_Time() - start;
+            }
+            int count = 0;
+            while (count < config.repeats && (count == 0 || spent < config.time_budget)) {
+                memset(result, 0, n * sizeof(int));
+                double start = Wall_Time();
+                samples[count++] = algorithm->multiply(a, b, n, result);
+                spent += Wall_Time() - start;
+            }
+            bool correct = Polynomial_Correctness(result, expected, n);
+            all_correct &= correct;
+            if (!correct) {
+                printf("%s gave a wrong product for n = %d\n", algorithm->name, n);
+            }
+
+            Benchmark_Statistics statistics = Statistics(samples, count);
+            Write_Row(file, config, first, algorithm, n, statistics, correct);
+            first = false;
+
+            // The time of one run at the next size, from the growth between
+            // the last two sizes but at least doubling
+            double growth = 2;
+            if (previous[i] > 0 && statistics.median / previous[i] > growth) {
+                growth = statistics.median / previous[i];
+            }
+            previous[i] = statistics.median;
+            if (statistics.median * growth > config.time_budget) {
+                active[i] = false;
+                printf("%s stops at n = %d\n", algorithm->name, n);
+            }
+        }
+        free(expected);
+        free(result);
+        printf("n = %d done\n", n);
     }
-    fprintf(file, "\nRecursive_FFT multiplication:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%f ", recursive_fft_time_array[i]);
+
+    if (config.format == BENCHMARK_FORMAT_JSON) {
+        fprintf(file, "\n  ]\n}\n");
     }
-    fprintf(file, "\nIterative_FFT multiplication:\t");
-    for (int i = 1; i <= max_n_size; i++) {
-        fprintf(file, "%f ", iterative_fft_time_array[i]);
+    free(samples);
+    mpz_clears(a, b, NULL);
+    gmp_randclear(state);
+    if (fclose(file) != 0) {
+        perror(config.path);
+        return false;
     }
+    printf("Results written to %s\n", config.path);
+    return all_correct;
+}
 
-    fclose(file);
+int Benchmark_Command(int argc, char **argv) {
+    Benchmark_Config config = Default_Benchmark_Config();
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        const char *option = argv[i], *value = argv[++i];
+        if (strcmp(option, "--format") == 0 && strcmp(value, "csv") == 0) {
+            config.format = BENCHMARK_FORMAT_CSV;
+        } else if (strcmp(option, "--format") == 0 && strcmp(value, "json") == 0) {
+            config.format = BENCHMARK_FORMAT_JSON;
+        } else if (strcmp(option, "--output") == 0) {
+            config.path = value;
+        } else if (strcmp(option, "--cpu") == 0) {
+            config.cpu = atoi(value);
+        } else if (strcmp(option, "--min") == 0) {
+            config.min_log2n = atoi(value);
+        } else if (strcmp(option, "--max") == 0) {
+            config.max_log2n = atoi(value);
+        } else if (strcmp(option, "--warmup") == 0) {
+            config.warmup = atoi(value);
+        } else if (strcmp(option, "--repeats") == 0) {
+            config.repeats = atoi(value);
+        } else if (strcmp(option, "--budget") == 0) {
+            config.time_budget = atof(value);
+        } else {
+            fprintf(stderr, "Usage: %s benchmark [--format csv|json] [--output path] "
+                    "[--cpu n] [--min log2n] [--max log2n] [--warmup runs] "
+                    "[--repeats runs] [--budget seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (config.min_log2n < 1 || config.max_log2n > 26 || config.min_log2n > config.max_log2n) {
+        fprintf(stderr, "The sizes must be within 2^1 .. 2^26\n");
+        return 1;
+    }
+    return Runtime_Benchmark(config) ? 0 : 1;
+}
 
+void Runtime_test_systematic() {
+    Runtime_Benchmark(Default_Benchmark_Config());
 }
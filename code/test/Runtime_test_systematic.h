@@ -1,9 +1,70 @@
+#ifndef Runtime_test_systematic_H
+#define Runtime_test_systematic_H
 #include "../Helper_Functions.h"
 #include "../Recursive_fft.h"
 #include "../iterative_fft.h"
 #include "../dft.h"
 #include "../karatsuba.h"
+#include "../ntt.h"
 #include "../Naive_Polynomial_Multiplication.h"
-#include <check.h>
 
-void Runtime_test_systematic();
\ No newline at end of file
+// Benchmark of the multiplication algorithms over n = 2^min_log2n .. 2^max_log2n
+// A single run per size mostly measures whatever else the machine was doing.
+// Every algorithm and size is instead run warmup times untimed (plans,
+// buffers and caches are set up, the cpu clock ramps up) and then up to
+// repeats times, and the spread of the runs is reported:
+//     min, median, p95 and p99 of the elapsed times the functions return
+//     a 95% confidence interval of the median from the order statistics,
+//     ranks n/2 -+ 0.98 * sqrt(n), which needs no assumption on the
+//     distribution of the times
+//     ns per coefficient of the result, median / n
+//     GFLOPS from the operation count of the algorithm at the median time:
+//     2 * l^2 for the naive method on l = n/2 digits, 3 DFTs of 8 * n^2,
+//     the Karatsuba recursion down to its cutoff, 5 * n * log2(n) per
+//     complex FFT and 3 operations per NTT butterfly
+// Every algorithm gets time_budget seconds per size. It stops repeating
+// when the budget is spent (but runs at least once), and it is left out of
+// the larger sizes once the growth of its times predicts that one run would
+// not fit in the budget, so the quadratic methods do not stall the sweep.
+// Every result is checked against the exact NTT product.
+
+typedef enum {
+    BENCHMARK_FORMAT_CSV,
+    BENCHMARK_FORMAT_JSON
+} Benchmark_Format;
+
+typedef struct {
+    int min_log2n;
+    int max_log2n;
+    int warmup;             // Untimed runs before the samples
+    int repeats;            // Most timed runs per algorithm and size
+    double time_budget;     // Seconds per algorithm and size
+    int cpu;                // Pin the process to this cpu, -1 to not pin
+    Benchmark_Format format;
+    const char *path;       // Output file
+} Benchmark_Config;
+
+#define BENCHMARK_FILE "test/Computation_times.csv"
+
+// Operands are random but the same for every run of the benchmark
+#define BENCHMARK_SEED 12345
+
+// 2^1 .. 2^20, 3 warmup runs, up to 31 samples, 1 second per algorithm and
+// size, no pinning, CSV to BENCHMARK_FILE
+Benchmark_Config Default_Benchmark_Config();
+
+// Run the benchmark and write the results, returns false if the output
+// can not be written or an algorithm gave a wrong product
+bool Runtime_Benchmark(Benchmark_Config config);
+
+// The command line mode of the program:
+//     program benchmark [--format csv|json] [--output path] [--cpu n]
+//                       [--min log2n] [--max log2n] [--warmup runs]
+//                       [--repeats runs] [--budget seconds]
+// Returns the exit status
+int Benchmark_Command(int argc, char **argv);
+
+// The benchmark with the default settings
+void Runtime_test_systematic();
+
+#endif
@@ -65,6 +65,165 @@ START_TEST(Karatsuba_test_basic_multiplication) {
 }
 END_TEST
 
+START_TEST(Karatsuba_Scratch_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // A cutoff of 1 makes the recursion go all the way down, on the zero
+    // padded digits so the high halves and the sums are used
+    int padded_a[n], padded_b[n], result_karatsuba[n];
+    memset(padded_a, 0, n * sizeof(int));
+    memset(padded_b, 0, n * sizeof(int));
+    memset(result_karatsuba, 0, n * sizeof(int));
+    mpz_to_int_array(global_a_value, padded_a);
+    mpz_to_int_array(global_b_value, padded_b);
+    int length = n >> 1;
+    int scratch[Karatsuba_Scratch_Size(length, length, 1) + 1];
+    Karatsuba_Polynomial_ext(padded_a, padded_b, length, length, result_karatsuba, scratch, 1);
+    if (!Polynomial_Correctness(result_karatsuba, global_expected_result, n)) {
+        ck_abort_msg("Karatsuba with scratch memory did not produce the expected result.");
+    }
+    free(global_expected_result);
+}
+END_TEST
+
+START_TEST(Parallel_Karatsuba_test_basic_multiplication) {
+
+    // Long random polynomials so the top levels are forked, with more
+    // threads than cpus and with uneven lengths, against the serial result
+    int length1 = 6 * PARALLEL_KARATSUBA_GRAIN, length2 = 5 * PARALLEL_KARATSUBA_GRAIN + 7;
+    int *input1 = (int *)malloc(length1 * sizeof(int));
+    int *input2 = (int *)malloc(length2 * sizeof(int));
+    int *expected = (int *)malloc((length1 + length2) * sizeof(int));
+    int *result = (int *)malloc((length1 + length2) * sizeof(int));
+    for (int i = 0; i < length1; i++) {
+        input1[i] = (i * 7 + n) % 10;
+    }
+    for (int i = 0; i < length2; i++) {
+        input2[i] = (i * 3 + 1) % 10;
+    }
+    int threads = Get_Karatsuba_Threads();
+    Set_Karatsuba_Threads(1);
+    Karatsuba_Polynomial(input1, input2, length1, length2, expected);
+    Set_Karatsuba_Threads(4);
+    Karatsuba_Polynomial(input1, input2, length1, length2, result);
+    bool correct = Polynomial_Correctness(result, expected, length1 + length2 - 1);
+    Set_Karatsuba_Threads(threads);
+
+    free(input1);
+    free(input2);
+    free(expected);
+    free(result);
+    if (!correct) {
+        ck_abort_msg("Parallel Karatsuba did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Toom_Cook_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    int result_toom[n];
+    memset(result_toom, 0, n * sizeof(int));
+    polynomial_multiply_toom(global_a_value, global_b_value, n, result_toom);
+    bool correct = Polynomial_Correctness(result_toom, global_expected_result, n);
+
+    // The test numbers are below the cutoff, so also multiply long
+    // polynomials of 9s (the largest values the bounds are made for) with
+    // both splits and check against the schoolbook method
+    int length = 1000;
+    int *nines = (int *)malloc(length * sizeof(int));
+    int *expected_long = (int *)malloc(2 * length * sizeof(int));
+    int *result_long = (int *)malloc(2 * length * sizeof(int));
+    for (int i = 0; i < length; i++) {
+        nines[i] = 9;
+    }
+    Array_Multiplication(nines, nines, length, length / 3, expected_long);
+    Toom3_Polynomial(nines, nines, length, length / 3, result_long);
+    correct &= Polynomial_Correctness(result_long, expected_long, length + length / 3 - 1);
+    Array_Multiplication(nines, nines, length, length, expected_long);
+    Toom4_Polynomial(nines, nines, length, length, result_long);
+    correct &= Polynomial_Correctness(result_long, expected_long, 2 * length - 1);
+
+    free(nines);
+    free(expected_long);
+    free(result_long);
+    free(global_expected_result);
+    if (!correct) {
+        ck_abort_msg("Toom-Cook did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Polynomial_Multiply_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // The chosen engine and every engine the dispatcher can choose
+    int result_dispatch[n];
+    memset(result_dispatch, 0, n * sizeof(int));
+    polynomial_multiply(global_a_value, global_b_value, n, result_dispatch);
+    bool correct = Polynomial_Correctness(result_dispatch, global_expected_result, n);
+    Multiply_Context *context = Get_Default_Multiply_Context(n);
+    for (int engine = 0; engine < MULTIPLY_ENGINES; engine++) {
+        memset(result_dispatch, 0, n * sizeof(int));
+        polynomial_multiply_engine(engine, global_a_value, global_b_value, n,
+                                    result_dispatch, context);
+        correct &= Polynomial_Correctness(result_dispatch, global_expected_result, n);
+    }
+
+    // Saved thresholds load back the same, and a missing file keeps them
+    Multiply_Thresholds saved = Get_Multiply_Thresholds();
+    Multiply_Thresholds changed = saved;
+    changed.toom = 12345;
+    changed.mixed_radix = 5000;
+    changed.ntt = INT_MAX;
+    const char *path = "test/thresholds_test.txt";
+    correct &= Save_Multiply_Thresholds(path, changed);
+    Set_Multiply_Thresholds(Default_Multiply_Thresholds());
+    correct &= Load_Multiply_Thresholds(path);
+    correct &= !Load_Multiply_Thresholds("test/no_such_file.txt");
+    Multiply_Thresholds loaded = Get_Multiply_Thresholds();
+    correct &= loaded.toom == 12345 && loaded.ntt == INT_MAX &&
+                loaded.mixed_radix == 5000 &&
+                Choose_Multiply_Engine(6000) == MULTIPLY_ENGINE_MIXED_RADIX &&
+                loaded.karatsuba_cutoff == changed.karatsuba_cutoff &&
+                Get_Karatsuba_Cutoff() == changed.karatsuba_cutoff;
+    remove(path);
+
+    // Loading a file without the cutoff keeps the cutoff that was set
+    // directly, the defaults keep the one Karatsuba starts with
+    FILE *file = fopen(path, "w");
+    correct &= file != NULL;
+    if (file != NULL) {
+        fprintf(file, "toom 777\n");
+        fclose(file);
+    }
+    Set_Karatsuba_Cutoff(77);
+    correct &= Load_Multiply_Thresholds(path);
+    correct &= Get_Karatsuba_Cutoff() == 77 && Get_Multiply_Thresholds().toom == 777 &&
+                Get_Multiply_Thresholds().karatsuba_cutoff == 77;
+    remove(path);
+    correct &= Default_Multiply_Thresholds().karatsuba_cutoff == KARATSUBA_CUTOFF;
+    Set_Multiply_Thresholds(saved);
+
+    free(global_expected_result);
+    if (!correct) {
+        ck_abort_msg("polynomial_multiply did not produce the expected result.");
+    }
+}
+END_TEST
+
 START_TEST(Recursive_FFT_test_basic_multiplication) {
 
     // Verify with naive approach
@@ -103,12 +262,799 @@ START_TEST(Iterative_FFT_test_basic_multiplication) {
 }
 END_TEST
 
+START_TEST(FFT_Engines_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // Run the iterative FFT multiplication with every engine
+    FFT_Engine engines[] = {FFT_ENGINE_RADIX2, FFT_ENGINE_SIMD,
+                            FFT_ENGINE_RADIX4, FFT_ENGINE_SPLIT_RADIX,
+                            FFT_ENGINE_STOCKHAM};
+    int engine_count = sizeof(engines) / sizeof(engines[0]);
+    FFT_Engine default_engine = Get_FFT_Engine();
+    int result_engine[n];
+    for (int i = 0; i < engine_count; i++) {
+        Set_FFT_Engine(engines[i]);
+        memset(result_engine, 0, n * sizeof(int));
+        polynomial_multiply_iterative_FFT(global_a_value, global_b_value, n, result_engine);
+        if (!Polynomial_Correctness(result_engine, global_expected_result, n)) {
+            Set_FFT_Engine(default_engine);
+            free(global_expected_result);
+            ck_abort_msg("%s FFT engine did not produce the expected result.", FFT_Engine_Name(engines[i]));
+        }
+    }
+    Set_FFT_Engine(default_engine);
+    free(global_expected_result);
+}
+END_TEST
+
+START_TEST(Six_Step_FFT_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // Lower the threshold so the small test sizes also take the six-step path
+    Set_Six_Step_Threshold(4);
+    int result_six_step[n];
+    memset(result_six_step, 0, n * sizeof(int));
+    polynomial_multiply_iterative_FFT(global_a_value, global_b_value, n, result_six_step);
+    Set_Six_Step_Threshold(0);
+
+    bool correct = Polynomial_Correctness(result_six_step, global_expected_result, n);
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("Six-step FFT did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Mixed_Radix_FFT_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    int result_mixed_radix[n];
+    memset(result_mixed_radix, 0, n * sizeof(int));
+    polynomial_multiply_mixed_radix(global_a_value, global_b_value, n, result_mixed_radix);
+    bool correct = Polynomial_Correctness(result_mixed_radix, global_expected_result, n);
+
+    // The transform itself against the DFT on a length with every radix
+    int length = 2 * 3 * 4 * 5 * 7;
+    complex double input[length], expected[length], output[length];
+    for (int i = 0; i < length; i++) {
+        input[i] = (i % 10) + ((i * 7) % 10) * I;
+    }
+    DFT(input, length, expected);
+    Mixed_Radix_FFT(input, length, output);
+    for (int i = 0; i < length; i++) {
+        correct &= cabs(output[i] - expected[i]) < 1e-6;
+    }
+    Mixed_Radix_IFFT(output, length, output);
+    for (int i = 0; i < length; i++) {
+        correct &= cabs(output[i] - input[i]) < 1e-9;
+    }
+    correct &= Next_Smooth_Size(1025) == 1029 && Next_Smooth_Size(11) == 12 &&
+                Next_Smooth_Size(64) == 64;
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("Mixed-radix FFT did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Bluestein_FFT_test) {
+
+    // A prime length against the DFT, and the inverse back to the input
+    int length = 101;
+    complex double input[length], expected[length], output[length];
+    for (int i = 0; i < length; i++) {
+        input[i] = (i % 10) + ((i * 7) % 10) * I;
+    }
+    DFT(input, length, expected);
+    Bluestein_FFT(input, length, output);
+    bool correct = true;
+    for (int i = 0; i < length; i++) {
+        correct &= cabs(output[i] - expected[i]) < 1e-6;
+    }
+    Bluestein_IFFT(output, length, output);
+    for (int i = 0; i < length; i++) {
+        correct &= cabs(output[i] - input[i]) < 1e-9;
+    }
+
+    // 16 frequencies between 0.25 and 0.3 cycles per sample against the sum
+    int bins = 16;
+    complex double zoomed[bins];
+    Zoom_FFT(input, length, zoomed, bins, 0.25, 0.3);
+    for (int k = 0; k < bins; k++) {
+        complex double sum = 0;
+        for (int j = 0; j < length; j++) {
+            sum += input[j] * cexp(-I * TAU * j * (0.25 + k * 0.05 / bins));
+        }
+        correct &= cabs(zoomed[k] - sum) < 1e-6;
+    }
+
+    if (!correct) {
+        ck_abort_msg("Bluestein FFT did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Batch_FFT_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // The lane kernels follow Set_Split_FFT_Kernel, so the batches run once
+    // with each of them. Kernels the cpu lacks fall back to scalar
+    Split_FFT_Kernel kernel = Get_Split_FFT_Kernel();
+    Split_FFT_Kernel kernels[] = {SPLIT_KERNEL_SCALAR, SPLIT_KERNEL_SSE2,
+                                  SPLIT_KERNEL_AVX2, SPLIT_KERNEL_AVX512};
+    bool correct = true;
+    int s = 0;
+    for (; s < 4; s++) {
+        Set_Split_FFT_Kernel(kernels[s]);
+
+        // An odd batch, so one product has no partner in the inverse
+        int count = 3;
+        mpz_t a[count], b[count];
+        for (int i = 0; i < count; i++) {
+            mpz_init_set(a[i], global_a_value);
+            mpz_init_set(b[i], global_b_value);
+        }
+        int *results = (int *)calloc(count * n, sizeof(int));
+        polynomial_multiply_batch(a, b, count, n, results);
+        for (int i = 0; i < count; i++) {
+            correct &= Polynomial_Correctness(results + i * n, global_expected_result, n);
+            mpz_clears(a[i], b[i], NULL);
+        }
+        free(results);
+
+        // Both layouts against one FFT per vector, with more vectors than
+        // the widest kernel has lanes and some left over
+        int length = 16, batch = 11;
+        complex double input[length * batch], output[length * batch];
+        complex double vector[length], expected[length];
+        for (int i = 0; i < length * batch; i++) {
+            input[i] = (i % 10) + ((i * 7) % 10) * I;
+        }
+        Batch_Layout layouts[] = {BATCH_LAYOUT_INTERLEAVED, BATCH_LAYOUT_CONTIGUOUS};
+        for (int l = 0; l < 2; l++) {
+            Batch_FFT(input, length, batch, layouts[l], output);
+            for (int v = 0; v < batch; v++) {
+                for (int k = 0; k < length; k++) {
+                    vector[k] = (l == 0) ? input[k * batch + v] : input[v * length + k];
+                }
+                FFT_Forward(vector, length, expected);
+                for (int k = 0; k < length; k++) {
+                    complex double value = (l == 0) ? output[k * batch + v] : output[v * length + k];
+                    correct &= cabs(value - expected[k]) < 1e-9;
+                }
+            }
+            Batch_IFFT(output, length, batch, layouts[l], output);
+            for (int i = 0; i < length * batch; i++) {
+                correct &= cabs(output[i] - input[i]) < 1e-9;
+            }
+        }
+        if (!correct) {
+            break;
+        }
+    }
+    Split_FFT_Kernel failed = Get_Split_FFT_Kernel();
+    Set_Split_FFT_Kernel(kernel);
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("Batched FFT did not produce the expected result with the %s kernel.",
+                     Split_FFT_Kernel_Name(failed));
+    }
+}
+END_TEST
+
+START_TEST(Block_Convolver_test) {
+
+    // A stream pushed and pulled in uneven chunks against the direct
+    // convolution, in both modes
+    int kernel_length = 13, length = 1000;
+    double kernel[kernel_length], input[length];
+    double expected[length + kernel_length - 1], output[length + kernel_length - 1];
+    for (int i = 0; i < kernel_length; i++) {
+        kernel[i] = (i * 3) % 10;
+    }
+    for (int i = 0; i < length; i++) {
+        input[i] = (i * 7) % 10;
+    }
+    memset(expected, 0, sizeof(expected));
+    for (int i = 0; i < length; i++) {
+        for (int j = 0; j < kernel_length; j++) {
+            expected[i + j] += input[i] * kernel[j];
+        }
+    }
+
+    bool correct = true;
+    Convolve_Mode modes[] = {CONVOLVE_OVERLAP_ADD, CONVOLVE_OVERLAP_SAVE};
+    for (int m = 0; m < 2; m++) {
+        Block_Convolver *convolver = Block_Convolver_Create(kernel, kernel_length, 0, modes[m]);
+        int pushed = 0, pulled = 0, pulled_now;
+        while (pushed < length) {
+            int count = (length - pushed < 37) ? length - pushed : 37;
+            pushed += Block_Convolver_Push(convolver, input + pushed, count);
+            pulled += Block_Convolver_Pull(convolver, output + pulled, 11);
+        }
+        Block_Convolver_Finish(convolver);
+        while ((pulled_now = Block_Convolver_Pull(convolver, output + pulled, 11)) > 0) {
+            pulled += pulled_now;
+        }
+        Block_Convolver_Free(convolver);
+
+        correct &= pulled == length + kernel_length - 1;
+        for (int i = 0; i < pulled && correct; i++) {
+            correct &= fabs(output[i] - expected[i]) < 1e-6;
+        }
+    }
+
+    if (!correct) {
+        ck_abort_msg("Block convolution did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(FFT_Rounding_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // With a margin of 0 every product that is not exactly integer falls
+    // back to the exact engine, the result must be the same either way
+    int result_fallback[n];
+    double margin = Get_FFT_Rounding_Margin();
+    Reset_FFT_Rounding_Stats();
+    Set_FFT_Rounding_Margin(0.0);
+    memset(result_fallback, 0, n * sizeof(int));
+    polynomial_multiply_iterative_FFT(global_a_value, global_b_value, n, result_fallback);
+    bool correct = Polynomial_Correctness(result_fallback, global_expected_result, n);
+    memset(result_fallback, 0, n * sizeof(int));
+    polynomial_multiply_Recursive_FFT(global_a_value, global_b_value, n, result_fallback);
+    correct &= Polynomial_Correctness(result_fallback, global_expected_result, n);
+    memset(result_fallback, 0, n * sizeof(int));
+    polynomial_multiply_mixed_radix(global_a_value, global_b_value, n, result_fallback);
+    correct &= Polynomial_Correctness(result_fallback, global_expected_result, n);
+    Prepared_Operand *prepared = Prepare_Operand(global_b_value, n, PREPARED_ENGINE_FFT);
+    memset(result_fallback, 0, n * sizeof(int));
+    polynomial_multiply_prepared(prepared, global_a_value, result_fallback);
+    correct &= Polynomial_Correctness(result_fallback, global_expected_result, n);
+    Prepared_Operand_Free(prepared);
+
+    // Two products in one batch, every lane is rounded on its own
+    mpz_t a[2], b[2];
+    for (int i = 0; i < 2; i++) {
+        mpz_init_set(a[i], global_a_value);
+        mpz_init_set(b[i], global_b_value);
+    }
+    int *results = (int *)calloc(2 * n, sizeof(int));
+    polynomial_multiply_batch(a, b, 2, n, results);
+    for (int i = 0; i < 2; i++) {
+        correct &= Polynomial_Correctness(results + i * n, global_expected_result, n);
+        mpz_clears(a[i], b[i], NULL);
+    }
+    free(results);
+
+    // The integer products fall back to GMP
+    mpz_t expected_integer, result_integer;
+    mpz_inits(expected_integer, result_integer, NULL);
+    mpz_mul(expected_integer, global_a_value, global_b_value);
+    mpz_multiply_FFT(result_integer, global_a_value, global_b_value);
+    correct &= Correctness_Check(result_integer, expected_integer);
+    mpz_multiply_FFT_decimal(result_integer, global_a_value, global_b_value);
+    correct &= Correctness_Check(result_integer, expected_integer);
+    mpz_pow_ui(expected_integer, global_a_value, 5);
+    mpz_power_FFT(result_integer, global_a_value, 5);
+    correct &= Correctness_Check(result_integer, expected_integer);
+    mpz_clears(expected_integer, result_integer, NULL);
+    Set_FFT_Rounding_Margin(margin);
+
+    FFT_Rounding_Stats stats = Get_FFT_Rounding_Stats();
+    // The six digit products are always rounded, the integer products only
+    // for non-zero operands and the power, at least two products, only for
+    // |a| > 1
+    long long products = 6;
+    products += (mpz_sgn(global_a_value) * mpz_sgn(global_b_value) != 0) ? 2 : 0;
+    products += (mpz_cmpabs_ui(global_a_value, 1) > 0) ? 2 : 0;
+    correct &= stats.multiplications >= products;
+    // Only a product with no rounding error at all stays on the FFT
+    correct &= stats.fallbacks <= stats.multiplications &&
+                (stats.fallbacks > 0) == (stats.max_error > 0);
+    correct &= stats.max_error < 0.5 && stats.last_error <= stats.max_error;
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("FFT rounding fallback did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(FFT_Rounding_test_fallback_engine) {
+    const NTT_Prime *first = Get_NTT_Prime(0), *second = Get_NTT_Prime(1);
+    // The longest operands one prime covers, one more digit needs the second
+    size_t single = (first->p - 1) / 81;
+    int longest = 1 << first->max_log2n, second_longest = 1 << second->max_log2n;
+
+    bool correct = Exact_Fallback_Engine(longest, single, single) == EXACT_ENGINE_NTT;
+    correct &= Exact_Fallback_Engine(longest, single + 1, single + 1) == EXACT_ENGINE_KARATSUBA;
+    // Only the shorter operand counts
+    correct &= Exact_Fallback_Engine(longest, single, longest) == EXACT_ENGINE_NTT;
+    correct &= Exact_Fallback_Engine(second_longest, single + 1, single + 1) == EXACT_ENGINE_NTT;
+    correct &= Exact_Fallback_Engine(2 * longest, 1, 1) == EXACT_ENGINE_KARATSUBA;
+    correct &= NTT_Primes_Needed(81 * (uint64_t)single) == 1;
+    correct &= NTT_Primes_Needed(81 * (uint64_t)(single + 1)) == 2;
+
+    if (!correct) {
+        ck_abort_msg("FFT rounding fallback picked an engine that can not take the product.");
+    }
+}
+END_TEST
+
+START_TEST(NTT_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // Compute polynomial multiplication using the NTT, with the scalar and
+    // the vector butterflies. Without AVX2 both runs are scalar
+    bool vector_kernel = Get_NTT_Vector_Kernel();
+    int result_NTT[n];
+    bool correct = true;
+    for (int enable = 0; enable < 2; enable++) {
+        Set_NTT_Vector_Kernel(enable);
+        memset(result_NTT, 0, n * sizeof(int));
+        polynomial_multiply_NTT(global_a_value, global_b_value, n, result_NTT);
+        correct &= Polynomial_Correctness(result_NTT, global_expected_result, n);
+    }
+
+    // The transforms are exact, so both kernels give the same values
+    int length = 1 << 10;
+    uint32_t values[length], scalar[length], vector[length];
+    const NTT_Prime *prime = Get_NTT_Prime(0);
+    for (int i = 0; i < length; i++) {
+        values[i] = (uint32_t)(((uint64_t)i * 2654435761u) % prime->p);
+    }
+    NTT_Plan *plan = Get_NTT_Plan(length, 0);
+    Set_NTT_Vector_Kernel(false);
+    NTT_Forward(plan, values, scalar);
+    Set_NTT_Vector_Kernel(true);
+    NTT_Forward(plan, values, vector);
+    correct &= memcmp(scalar, vector, sizeof(scalar)) == 0;
+    NTT_Inverse(plan, vector, scalar);
+    correct &= memcmp(values, scalar, sizeof(values)) == 0;
+    Set_NTT_Vector_Kernel(vector_kernel);
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("NTT did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Integer_FFT_test_basic_multiplication) {
+
+    // Verify with GMP, the binary coefficients are not digits so the whole
+    // product is compared
+    mpz_t expected_result, result_integer_FFT;
+    mpz_inits(expected_result, result_integer_FFT, NULL);
+    mpz_mul(expected_result, global_a_value, global_b_value);
+
+    mpz_multiply_FFT(result_integer_FFT, global_a_value, global_b_value);
+    bool correct = Correctness_Check(result_integer_FFT, expected_result);
+    mpz_multiply_FFT_decimal(result_integer_FFT, global_a_value, global_b_value);
+    correct &= Correctness_Check(result_integer_FFT, expected_result);
+    if (!correct) {
+        mpz_clears(expected_result, result_integer_FFT, NULL);
+        ck_abort_msg("Integer FFT did not produce the expected result.");
+    }
+    mpz_clears(expected_result, result_integer_FFT, NULL);
+}
+END_TEST
+
+// The conditions FFT_Coefficient_Bits and FFT_Decimal_Digits must meet for
+// count_a and count_b coefficients up to largest: integer products within
+// 2^53 and FFT_Error_Bound below 0.5 at a transform of size
+static bool Exact_By_Bound(size_t count_a, size_t count_b, double largest, int size) {
+    size_t terms = (count_a < count_b) ? count_a : count_b;
+    return size >= count_a + count_b && (size & (size - 1)) == 0 &&
+            terms * largest * largest < 9007199254740992.0 &&
+            FFT_Error_Bound(size, sqrt(count_a) * largest, sqrt(count_b) * largest) < 0.5;
+}
+
+// Smallest power of 2 of at least count, the FFT length for count coefficients
+static int Transform_Size(size_t count) {
+    int size = 2;
+    while (size < count) {
+        size <<= 1;
+    }
+    return size;
+}
+
+START_TEST(Integer_FFT_test_error_bound) {
+    bool correct = true;
+    double epsilon = DBL_EPSILON / 2;
+    for (int n = 2; n <= (1 << 26); n <<= 1) {
+        // Quadratic in the norms and growing with the length
+        double unit = FFT_Error_Bound(n, 1, 0);
+        correct &= unit > 0 && FFT_Error_Bound(2 * n, 1, 0) > unit;
+        correct &= fabs(FFT_Error_Bound(n, 3, 4) - 25 * unit) <= 1e-12 * 25 * unit;
+        // To first order every round adds e, e*sqrt(5) and the twiddle error
+        int rounds = 3 * (__builtin_ctz(n) + 1) + 3;
+        double first_order = (rounds * (1 + sqrt(5) + FFT_TWIDDLE_ERROR) + sqrt(5)) * epsilon;
+        correct &= fabs(unit / first_order - 1) < 1e-6;
+    }
+
+    // The widths chosen meet the bound and one more bit or digit does not,
+    // for operands of equal and of different lengths
+    for (size_t length = 8; length <= ((size_t)1 << 28); length = length * 3 + 1) {
+        size_t other = length / 5 + 1;
+        int size;
+        int bits = FFT_Coefficient_Bits(length, other, &size);
+        correct &= bits >= 1 && bits <= FFT_MAX_COEFFICIENT_BITS;
+        correct &= Exact_By_Bound((length + bits - 1) / bits, (other + bits - 1) / bits,
+                                    ldexp(1, bits) - 1, size);
+        if (bits < FFT_MAX_COEFFICIENT_BITS) {
+            int wider = bits + 1;
+            size_t count_a = (length + wider - 1) / wider, count_b = (other + wider - 1) / wider;
+            correct &= !Exact_By_Bound(count_a, count_b, ldexp(1, wider) - 1,
+                                        Transform_Size(count_a + count_b));
+        }
+
+        int digits = FFT_Decimal_Digits(length, other, &size);
+        double largest = pow(10, digits) - 1;
+        correct &= digits >= 1 && digits <= 9;
+        correct &= Exact_By_Bound((length + digits - 1) / digits, (other + digits - 1) / digits,
+                                    largest, size);
+        if (digits < 9) {
+            int wider = digits + 1;
+            size_t count_a = (length + wider - 1) / wider, count_b = (other + wider - 1) / wider;
+            correct &= !Exact_By_Bound(count_a, count_b, pow(10, wider) - 1,
+                                        Transform_Size(count_a + count_b));
+        }
+    }
+
+    if (!correct) {
+        ck_abort_msg("FFT error bound or the coefficient sizes chosen from it are wrong.");
+    }
+}
+END_TEST
+
+START_TEST(Integer_FFT_test_worst_case) {
+    // Every coefficient at its largest value, at the longest operands that
+    // still get the coefficient size. Nothing falls back with a margin of
+    // 0.5, so the FFT product itself must be exact
+    bool correct = true;
+    double margin = Get_FFT_Rounding_Margin();
+    Set_FFT_Rounding_Margin(0.5);
+    mpz_t operand, expected, result;
+    mpz_inits(operand, expected, result, NULL);
+    int size;
+
+    for (int bits = 17; bits >= 14; bits--) {
+        size_t low = bits, high = (size_t)1 << 22;
+        while (low < high) {
+            size_t middle = (low + high + 1) / 2;
+            if (FFT_Coefficient_Bits(middle, middle, &size) >= bits) {
+                low = middle;
+            } else {
+                high = middle - 1;
+            }
+        }
+        mpz_set_ui(operand, 0);
+        mpz_setbit(operand, low);
+        mpz_sub_ui(operand, operand, 1);
+        mpz_mul(expected, operand, operand);
+        Reset_FFT_Rounding_Stats();
+        mpz_multiply_FFT(result, operand, operand);
+        FFT_Rounding_Stats stats = Get_FFT_Rounding_Stats();
+        correct &= Correctness_Check(result, expected) && stats.fallbacks == 0 &&
+                    stats.max_error < 0.5;
+    }
+
+    for (int digits = 5; digits >= 4; digits--) {
+        size_t low = digits, high = (size_t)1 << 20;
+        while (low < high) {
+            size_t middle = (low + high + 1) / 2;
+            if (FFT_Decimal_Digits(middle, middle, &size) >= digits) {
+                low = middle;
+            } else {
+                high = middle - 1;
+            }
+        }
+        // low nines, mpz_sizeinbase gives exactly low for them
+        mpz_ui_pow_ui(operand, 10, low);
+        mpz_sub_ui(operand, operand, 1);
+        mpz_mul(expected, operand, operand);
+        Reset_FFT_Rounding_Stats();
+        mpz_multiply_FFT_decimal(result, operand, operand);
+        FFT_Rounding_Stats stats = Get_FFT_Rounding_Stats();
+        correct &= Correctness_Check(result, expected) && stats.fallbacks == 0 &&
+                    stats.max_error < 0.5;
+    }
+    mpz_clears(operand, expected, result, NULL);
+    Set_FFT_Rounding_Margin(margin);
+
+    if (!correct) {
+        ck_abort_msg("Integer FFT was not exact for the largest coefficients its bound allows.");
+    }
+}
+END_TEST
+
+START_TEST(Prepared_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // b prepared once for both engines, each used twice so the prepared
+    // transform must survive a multiplication
+    int result_prepared[n];
+    bool correct = true;
+    Prepared_Engine engines[] = {PREPARED_ENGINE_FFT, PREPARED_ENGINE_NTT};
+    for (int e = 0; e < 2; e++) {
+        Prepared_Operand *prepared = Prepare_Operand(global_b_value, n, engines[e]);
+        for (int repeat = 0; repeat < 2; repeat++) {
+            memset(result_prepared, 0, n * sizeof(int));
+            polynomial_multiply_prepared(prepared, global_a_value, result_prepared);
+            correct &= Polynomial_Correctness(result_prepared, global_expected_result, n);
+        }
+        Prepared_Operand_Free(prepared);
+    }
+    free(global_expected_result);
+
+    if (!correct) {
+        ck_abort_msg("Prepared operand multiplication did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Square_test_basic_multiplication) {
+
+    // Verify with the naive product of a with itself
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_a_value, n, global_expected_result);
+
+    int result_square[n];
+    bool correct = true;
+    memset(result_square, 0, n * sizeof(int));
+    polynomial_square_iterative_FFT(global_a_value, n, result_square);
+    correct &= Polynomial_Correctness(result_square, global_expected_result, n);
+    // A margin of 0 sends every inexact square to the exact fallback
+    double margin = Get_FFT_Rounding_Margin();
+    Set_FFT_Rounding_Margin(0.0);
+    memset(result_square, 0, n * sizeof(int));
+    polynomial_square_iterative_FFT(global_a_value, n, result_square);
+    correct &= Polynomial_Correctness(result_square, global_expected_result, n);
+    Set_FFT_Rounding_Margin(margin);
+    memset(result_square, 0, n * sizeof(int));
+    polynomial_square_NTT(global_a_value, n, result_square);
+    correct &= Polynomial_Correctness(result_square, global_expected_result, n);
+    memset(result_square, 0, n * sizeof(int));
+    polynomial_square_karatsuba(global_a_value, n, result_square);
+    correct &= Polynomial_Correctness(result_square, global_expected_result, n);
+
+    // A cutoff of 1 runs the squaring recursion all the way down
+    int padded[n], scratch[Karatsuba_Scratch_Size(n, n, 1) + 1];
+    memset(padded, 0, n * sizeof(int));
+    int length = mpz_to_int_array(global_a_value, padded);
+    memset(result_square, 0, n * sizeof(int));
+    Karatsuba_Square_ext(padded, length, result_square, scratch, 1);
+    correct &= Polynomial_Correctness(result_square, global_expected_result, n);
+    free(global_expected_result);
+
+    // The binary squaring and powers against GMP
+    mpz_t expected_result, result_power;
+    mpz_inits(expected_result, result_power, NULL);
+    mpz_mul(expected_result, global_a_value, global_a_value);
+    mpz_square_FFT(result_power, global_a_value);
+    correct &= Correctness_Check(result_power, expected_result);
+    unsigned long exponents[] = {0, 1, 2, 5, 13, 64};
+    for (int i = 0; i < 6; i++) {
+        mpz_pow_ui(expected_result, global_a_value, exponents[i]);
+        mpz_power_FFT(result_power, global_a_value, exponents[i]);
+        correct &= Correctness_Check(result_power, expected_result);
+    }
+    mpz_clears(expected_result, result_power, NULL);
+
+    if (!correct) {
+        ck_abort_msg("Squaring did not produce the expected result.");
+    }
+}
+END_TEST
+
+// Write size bytes to a new temporary file, path gets its name
+static void Write_Test_File(char *path, const void *data, size_t size) {
+    strcpy(path, "/tmp/fft_test_XXXXXX");
+    int fd = mkstemp(path);
+    FILE *file = fdopen(fd, "wb");
+    if (size > 0) {
+        fwrite(data, 1, size, file);
+    }
+    fclose(file);
+}
+
+// Read a whole file, size gets its length
+static void *Read_Test_File(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void *data = malloc(*size + 1);
+    *size = fread(data, 1, *size, file);
+    fclose(file);
+    return data;
+}
+
+START_TEST(File_Multiply_test_basic_multiplication) {
+
+    // The operands as limb files, the product read back must be a * b
+    char path_a[32], path_b[32], path_result[32];
+    size_t a_count, b_count, result_size;
+    void *a_limbs = mpz_export(NULL, &a_count, -1, sizeof(mp_limb_t), 0, 0, global_a_value);
+    void *b_limbs = mpz_export(NULL, &b_count, -1, sizeof(mp_limb_t), 0, 0, global_b_value);
+    Write_Test_File(path_a, a_limbs, a_count * sizeof(mp_limb_t));
+    Write_Test_File(path_b, b_limbs, b_count * sizeof(mp_limb_t));
+    Write_Test_File(path_result, NULL, 0);
+    free(a_limbs);
+    free(b_limbs);
+
+    mpz_t expected_result, result_file;
+    mpz_inits(expected_result, result_file, NULL);
+    mpz_mul(expected_result, global_a_value, global_b_value);
+    bool correct = File_Multiply(path_a, path_b, path_result, FILE_FORMAT_LIMBS);
+    void *result_limbs = Read_Test_File(path_result, &result_size);
+    mpz_import(result_file, result_size / sizeof(mp_limb_t), -1, sizeof(mp_limb_t), 0, 0,
+                result_limbs);
+    correct &= Correctness_Check(result_file, expected_result);
+    free(result_limbs);
+    mpz_clears(expected_result, result_file, NULL);
+
+    // Coefficient files of different lengths against the direct convolution
+    uint32_t a[100], b[37];
+    uint64_t expected[136] = {0};
+    for (int i = 0; i < 100; i++) {
+        a[i] = 2000000000u - i * 12345;
+    }
+    for (int i = 0; i < 37; i++) {
+        b[i] = 100000000u + i * 777;
+    }
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 37; j++) {
+            expected[i + j] += (uint64_t)a[i] * b[j];
+        }
+    }
+    unlink(path_a);
+    unlink(path_b);
+    Write_Test_File(path_a, a, sizeof(a));
+    Write_Test_File(path_b, b, sizeof(b));
+    correct &= File_Multiply(path_a, path_b, path_result, FILE_FORMAT_COEFFICIENTS);
+    uint64_t *result = (uint64_t *)Read_Test_File(path_result, &result_size);
+    correct &= result_size == sizeof(expected) &&
+                memcmp(result, expected, sizeof(expected)) == 0;
+    free(result);
+    unlink(path_a);
+    unlink(path_b);
+    unlink(path_result);
+
+    if (!correct) {
+        ck_abort_msg("File multiplication did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Array_To_Mpz_test_basic_multiplication) {
+
+    // Turning the digit products back into a number must give a * b
+    mpz_t expected_result, result_int_array, result_complex_array;
+    mpz_inits(expected_result, result_int_array, result_complex_array, NULL);
+    mpz_mul(expected_result, global_a_value, global_b_value);
+
+    int result_Iterative_FFT[n];
+    complex double result_complex[n];
+    memset(result_Iterative_FFT, 0, n * sizeof(int));
+    polynomial_multiply_iterative_FFT(global_a_value, global_b_value, n, result_Iterative_FFT);
+    for (int i = 0; i < n; i++) {
+        result_complex[i] = result_Iterative_FFT[i];
+    }
+    int_array_to_mpz(result_Iterative_FFT, n, &result_int_array);
+    complex_array_to_mpz(result_complex, n, &result_complex_array);
+
+    bool correct = Correctness_Check(result_int_array, expected_result) &&
+                    Correctness_Check(result_complex_array, expected_result);
+    mpz_clears(expected_result, result_int_array, result_complex_array, NULL);
+    if (!correct) {
+        ck_abort_msg("Array to mpz conversion did not produce the expected result.");
+    }
+}
+END_TEST
+
+START_TEST(Multiply_Context_test_basic_multiplication) {
+
+    // Verify with naive approach
+    int* global_expected_result = (int *)malloc(n * sizeof(int));
+    memset(global_expected_result, 0, n * sizeof(int));
+    Polynomial_Multiply_Naive(global_a_value, global_b_value, n, global_expected_result);
+
+    // A context larger than n, used twice by every engine to check that
+    // the reused buffers give the same result
+    Multiply_Context *context = Multiply_Context_Create(2 * n);
+    int result_context[n];
+    bool correct = true;
+    for (int i = 0; i < 2; i++) {
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_iterative_FFT_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_Recursive_FFT_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_DFT_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_karatsuba_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_NTT_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_toom_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+        memset(result_context, 0, n * sizeof(int));
+        polynomial_multiply_mixed_radix_ctx(global_a_value, global_b_value, n, result_context, context);
+        correct &= Polynomial_Correctness(result_context, global_expected_result, n);
+    }
+    Multiply_Context_Free(context);
+    if (!correct) {
+        ck_abort_msg("Multiplication with a context did not produce the expected result.");
+    }
+}
+END_TEST
+
 void Call_Test(TCase *Case){
     tcase_add_test(Case, DFT_test_basic_multiplication);
     tcase_add_test(Case, Naive_test_basic_multiplication);
     tcase_add_test(Case, Karatsuba_test_basic_multiplication);
+    tcase_add_test(Case, Karatsuba_Scratch_test_basic_multiplication);
+    tcase_add_test(Case, Parallel_Karatsuba_test_basic_multiplication);
+    tcase_add_test(Case, Toom_Cook_test_basic_multiplication);
+    tcase_add_test(Case, Polynomial_Multiply_test_basic_multiplication);
     tcase_add_test(Case, Recursive_FFT_test_basic_multiplication);
     tcase_add_test(Case, Iterative_FFT_test_basic_multiplication);
+    tcase_add_test(Case, FFT_Engines_test_basic_multiplication);
+    tcase_add_test(Case, Six_Step_FFT_test_basic_multiplication);
+    tcase_add_test(Case, Mixed_Radix_FFT_test_basic_multiplication);
+    tcase_add_test(Case, Bluestein_FFT_test);
+    tcase_add_test(Case, Batch_FFT_test_basic_multiplication);
+    tcase_add_test(Case, Block_Convolver_test);
+    tcase_add_test(Case, FFT_Rounding_test_basic_multiplication);
+    tcase_add_test(Case, FFT_Rounding_test_fallback_engine);
+    tcase_add_test(Case, NTT_test_basic_multiplication);
+    tcase_add_test(Case, Integer_FFT_test_basic_multiplication);
+    tcase_add_test(Case, File_Multiply_test_basic_multiplication);
+    tcase_add_test(Case, Square_test_basic_multiplication);
+    tcase_add_test(Case, Prepared_test_basic_multiplication);
+    tcase_add_test(Case, Array_To_Mpz_test_basic_multiplication);
+    tcase_add_test(Case, Multiply_Context_test_basic_multiplication);
 }
 
 
@@ -319,6 +1265,406 @@ void Uneven_Polynomial_Setup(){
 
 
 
+START_TEST(Parallel_FFT_test) {
+    // Both parallel transforms and their inverses with several thread
+    // counts against the radix-2 FFT, from sizes below PARALLEL_FFT_MIN_N
+    // (the recursive one stays serial there) to sizes with every stage
+    // split between the threads
+    int threads = Get_FFT_Threads();
+    int max_n = 1 << 18;
+    complex double *input = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *expected = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *output = (complex double *)malloc(max_n * sizeof(complex double));
+    for (int i = 0; i < max_n; i++) {
+        input[i] = (i % 10) + ((i * 7) % 10) * I;
+    }
+    bool correct = true;
+    int thread_counts[] = {2, 3, 4, 8};
+    for (int t = 0; t < 4; t++) {
+        Set_FFT_Threads(thread_counts[t]);
+        for (int size = 1 << 4; size <= max_n; size <<= 2) {
+            // The error grows with the size and the values
+            double tolerance = 1e-12 * size * 10;
+            Iterative_FFT(input, size, expected);
+            Parallel_Iterative_FFT(input, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - expected[i]) < tolerance;
+            }
+            Parallel_Recursive_FFT(input, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - expected[i]) < tolerance;
+            }
+            FFT_Forward(input, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - expected[i]) < tolerance;
+            }
+
+            Parallel_Iterative_IFFT(expected, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - input[i]) < 1e-9;
+            }
+            Parallel_Recursive_IFFT(expected, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - input[i]) < 1e-9;
+            }
+        }
+    }
+    Set_FFT_Threads(threads);
+    free(input);
+    free(expected);
+    free(output);
+
+    if (!correct) {
+        ck_abort_msg("Parallel FFT did not match the radix-2 FFT.");
+    }
+}
+END_TEST
+
+START_TEST(Split_FFT_Kernels_test) {
+    // Every kernel Set_Split_FFT_Kernel accepts against the scalar one, the
+    // vector kernels only reorder the butterflies so they must agree to
+    // rounding. Kernels the cpu lacks fall back to scalar and are skipped
+    Split_FFT_Kernel kernel = Get_Split_FFT_Kernel();
+    int max_n = 1 << 14;
+    complex double *input = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *expected = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *expected_inverse = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *output = (complex double *)malloc(max_n * sizeof(complex double));
+    for (int i = 0; i < max_n; i++) {
+        input[i] = (i % 10) + ((i * 7) % 10) * I;
+    }
+    bool correct = true;
+    Split_FFT_Kernel kernels[] = {SPLIT_KERNEL_SSE2, SPLIT_KERNEL_AVX2,
+                                  SPLIT_KERNEL_AVX512};
+    int k = 0, size = 1;
+    for (; k < 3 && correct; k++) {
+        for (size = 1; size <= max_n; size <<= 1) {
+            double tolerance = 1e-12 * size * 10;
+            Set_Split_FFT_Kernel(SPLIT_KERNEL_SCALAR);
+            Iterative_FFT_Split(input, size, expected);
+            Iterative_IFFT_Split(expected, size, expected_inverse);
+
+            Set_Split_FFT_Kernel(kernels[k]);
+            if (Get_Split_FFT_Kernel() != kernels[k]) {
+                break;
+            }
+            Iterative_FFT_Split(input, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - expected[i]) < tolerance;
+            }
+            Iterative_IFFT_Split(expected, size, output);
+            for (int i = 0; i < size; i++) {
+                correct &= cabs(output[i] - expected_inverse[i]) < 1e-9;
+                correct &= cabs(output[i] - input[i]) < 1e-9;
+            }
+            if (!correct) {
+                break;
+            }
+        }
+    }
+    Set_Split_FFT_Kernel(kernel);
+    free(input);
+    free(expected);
+    free(expected_inverse);
+    free(output);
+
+    if (!correct) {
+        ck_abort_msg("%s split FFT kernel did not match the scalar kernel for n = %d.",
+                     Split_FFT_Kernel_Name(kernels[k - 1]), size);
+    }
+}
+END_TEST
+
+START_TEST(COBRA_Bit_Reverse_test) {
+    // The blocked permutation against Bit_Reverse of every index, from the
+    // smallest size COBRA takes to sizes from COBRA_MIN_LOG2N up where
+    // Plan_Bit_Reverse uses it. The values are only moved, so they must be
+    // equal
+    int max_log2n = COBRA_MIN_LOG2N + 3;
+    int max_n = 1 << max_log2n;
+    complex double *input = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *output = (complex double *)malloc(max_n * sizeof(complex double));
+    for (int i = 0; i < max_n; i++) {
+        input[i] = i - i * I;
+    }
+    bool correct = true;
+    int sizes[] = {2 * COBRA_BLOCK_BITS, COBRA_MIN_LOG2N, COBRA_MIN_LOG2N + 1, max_log2n};
+    for (int s = 0; s < 4; s++) {
+        int log2n = sizes[s];
+        COBRA_Bit_Reverse(input, output, log2n);
+        for (int i = 0; i < (1 << log2n); i++) {
+            correct &= output[i] == input[Bit_Reverse(i, log2n)];
+        }
+        Plan_Bit_Reverse(Get_FFT_Plan(1 << log2n), input, output);
+        for (int i = 0; i < (1 << log2n); i++) {
+            correct &= output[i] == input[Bit_Reverse(i, log2n)];
+        }
+    }
+    free(input);
+    free(output);
+
+    if (!correct) {
+        ck_abort_msg("COBRA bit reversal did not match Bit_Reverse.");
+    }
+}
+END_TEST
+
+START_TEST(FFT_Plan_test_twiddles) {
+    // Every twiddle of the plans against e^{-i*TAU*k/n} in long double. The
+    // table is built to be exact to rounding, so it must stay within one
+    // ulp at every size, closer than cexp of the rounded double angle which
+    // is off by up to about 3.3 ulp
+    long double tau = 4 * acosl(0);
+    bool correct = true;
+    int size = 1;
+    for (int log2n = 1; log2n <= 20; log2n++) {
+        size = 1 << log2n;
+        FFT_Plan *plan = Get_FFT_Plan(size);
+        for (int k = 0; k < size; k++) {
+            long double complex expected = cexpl(-I * tau * k / size);
+            correct &= cabsl(Plan_Twiddle(plan, k) - expected) <= DBL_EPSILON;
+        }
+        if (!correct) {
+            break;
+        }
+    }
+
+    if (!correct) {
+        ck_abort_msg("FFT plan twiddles were more than one ulp from e^{-i*TAU*k/n} for n = %d.",
+                     size);
+    }
+}
+END_TEST
+
+START_TEST(Real_FFT_test) {
+    // The real transform against the complex FFT of the same real input,
+    // and the real inverse back to the input, with both complex transforms
+    // it can run on
+    int max_n = 1 << 16;
+    double *input = (double *)malloc(max_n * sizeof(double));
+    double *output = (double *)malloc(max_n * sizeof(double));
+    complex double *complex_input = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *expected = (complex double *)malloc(max_n * sizeof(complex double));
+    complex double *bins = (complex double *)malloc((max_n / 2 + 1) * sizeof(complex double));
+    complex double *work = (complex double *)malloc(max_n / 2 * sizeof(complex double));
+    for (int i = 0; i < max_n; i++) {
+        input[i] = (i * 7) % 10;
+        complex_input[i] = input[i];
+    }
+    Complex_Transform forward[] = {Iterative_FFT, Recursive_FFT};
+    Complex_Transform inverse[] = {Iterative_IFFT, Recursive_IFFT};
+    bool correct = true;
+    for (int t = 0; t < 2; t++) {
+        for (int size = 2; size <= max_n; size <<= 1) {
+            double tolerance = 1e-12 * size * 10;
+            Iterative_FFT(complex_input, size, expected);
+            Real_FFT(forward[t], input, size, bins, work);
+            for (int k = 0; k <= size / 2; k++) {
+                correct &= cabs(bins[k] - expected[k]) < tolerance;
+            }
+            Real_IFFT(inverse[t], bins, size, output, work);
+            for (int i = 0; i < size; i++) {
+                correct &= fabs(output[i] - input[i]) < 1e-9;
+            }
+        }
+    }
+    free(input);
+    free(output);
+    free(complex_input);
+    free(expected);
+    free(bins);
+    free(work);
+
+    if (!correct) {
+        ck_abort_msg("Real FFT did not match the complex FFT of the same input.");
+    }
+}
+END_TEST
+
+START_TEST(Batch_FFT_test_in_place) {
+    // Contiguous vectors of BATCH_BLOCK values go one by one to
+    // FFT_Forward, which only transforms in place with the SIMD engine. In
+    // place batches must match the out of place transform with every engine
+    FFT_Engine engines[] = {FFT_ENGINE_RADIX2, FFT_ENGINE_SIMD,
+                            FFT_ENGINE_RADIX4, FFT_ENGINE_SPLIT_RADIX,
+                            FFT_ENGINE_STOCKHAM};
+    int engine_count = sizeof(engines) / sizeof(engines[0]);
+    FFT_Engine default_engine = Get_FFT_Engine();
+    int length = BATCH_BLOCK, batch = 2;
+    size_t values = (size_t)length * batch;
+    complex double *input = (complex double *)malloc(values * sizeof(complex double));
+    complex double *expected = (complex double *)malloc(values * sizeof(complex double));
+    complex double *data = (complex double *)malloc(values * sizeof(complex double));
+    for (size_t i = 0; i < values; i++) {
+        input[i] = (i % 10) + ((i * 7) % 10) * I;
+    }
+    bool correct = true;
+    int i = 0;
+    for (; i < engine_count; i++) {
+        Set_FFT_Engine(engines[i]);
+        for (int v = 0; v < batch; v++) {
+            FFT_Forward(input + (size_t)v * length, length, expected + (size_t)v * length);
+        }
+        memcpy(data, input, values * sizeof(complex double));
+        Batch_FFT(data, length, batch, BATCH_LAYOUT_CONTIGUOUS, data);
+        for (size_t k = 0; k < values; k++) {
+            correct &= cabs(data[k] - expected[k]) < 1e-6;
+        }
+        Batch_IFFT(data, length, batch, BATCH_LAYOUT_CONTIGUOUS, data);
+        for (size_t k = 0; k < values; k++) {
+            correct &= cabs(data[k] - input[k]) < 1e-9;
+        }
+        if (!correct) {
+            break;
+        }
+    }
+    Set_FFT_Engine(default_engine);
+    free(input);
+    free(expected);
+    free(data);
+
+    if (!correct) {
+        ck_abort_msg("In place batched FFT did not match the FFT with the %s engine.",
+                     FFT_Engine_Name(engines[i]));
+    }
+}
+END_TEST
+
+// One thread of Concurrent_FFT_Correct, transforms its own input again and
+// again and checks every result
+typedef struct {
+    Complex_Transform transform;
+    complex double *input;
+    complex double *expected;
+    int n;
+    double tolerance;
+    bool correct;
+} FFT_Thread_Args;
+
+static void *FFT_Thread(void *arg) {
+    FFT_Thread_Args *args = (FFT_Thread_Args *)arg;
+    complex double *output = (complex double *)malloc(args->n * sizeof(complex double));
+    for (int round = 0; round < 50; round++) {
+        args->transform(args->input, args->n, output);
+        for (int i = 0; i < args->n; i++) {
+            args->correct &= cabs(output[i] - args->expected[i]) < args->tolerance;
+        }
+    }
+    free(output);
+    return NULL;
+}
+
+// Run transform of size on different inputs from several threads at once,
+// which share the cached plans, and compare with the radix-2 FFT
+static bool Concurrent_FFT_Correct(Complex_Transform transform, int size, double tolerance) {
+    int threads = 4;
+    FFT_Thread_Args args[threads];
+    pthread_t handles[threads];
+    for (int t = 0; t < threads; t++) {
+        args[t].transform = transform;
+        args[t].input = (complex double *)malloc(size * sizeof(complex double));
+        args[t].expected = (complex double *)malloc(size * sizeof(complex double));
+        args[t].n = size;
+        args[t].tolerance = tolerance;
+        args[t].correct = true;
+        for (int i = 0; i < size; i++) {
+            args[t].input[i] = ((i + t) % 10) + ((i * (t + 3)) % 10) * I;
+        }
+        Iterative_FFT(args[t].input, size, args[t].expected);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&handles[t], NULL, FFT_Thread, &args[t]);
+    }
+    bool correct = true;
+    for (int t = 0; t < threads; t++) {
+        pthread_join(handles[t], NULL);
+        correct &= args[t].correct;
+        free(args[t].input);
+        free(args[t].expected);
+    }
+    return correct;
+}
+
+START_TEST(Split_FFT_test_threads) {
+    if (!Concurrent_FFT_Correct(Iterative_FFT_Split, 1 << 12, 1e-9)) {
+        ck_abort_msg("Split FFT gave wrong results when run from several threads.");
+    }
+}
+END_TEST
+
+START_TEST(Six_Step_FFT_test_threads) {
+    if (!Concurrent_FFT_Correct(Six_Step_FFT, 1 << 14, 1e-6)) {
+        ck_abort_msg("Six-step FFT gave wrong results when run from several threads.");
+    }
+}
+END_TEST
+
+static void Count_Task(void *argument) {
+    atomic_fetch_add((atomic_int *)argument, 1);
+}
+
+START_TEST(Thread_Pool_test_shared) {
+    // Alternating thread counts, as the FFT and Karatsuba with different
+    // settings do, keep one pool per count instead of replacing the pool
+    Thread_Pool *two = Get_Thread_Pool(2);
+    Thread_Pool *three = Get_Thread_Pool(3);
+    bool correct = two != three && two->threads == 2 && three->threads == 3;
+    correct &= Get_Thread_Pool(2) == two && Get_Thread_Pool(3) == three;
+
+    // Both pools still run their tasks
+    Thread_Pool *pools[] = {two, three};
+    for (int p = 0; p < 2; p++) {
+        atomic_int count;
+        atomic_init(&count, 0);
+        Task_Group group;
+        Task_Group_Init(&group);
+        for (int i = 0; i < 100; i++) {
+            Thread_Pool_Spawn(pools[p], &group, Count_Task, &count);
+        }
+        Thread_Pool_Wait(pools[p], &group);
+        correct &= atomic_load(&count) == 100;
+    }
+
+    if (!correct) {
+        ck_abort_msg("Get_Thread_Pool did not keep one working pool per thread count.");
+    }
+}
+END_TEST
+
+// Tests that do not depend on the test numbers, added once
+void Call_Fixed_Tests(TCase *Case) {
+    tcase_add_test(Case, Integer_FFT_test_error_bound);
+    tcase_add_test(Case, Integer_FFT_test_worst_case);
+    tcase_add_test(Case, Parallel_FFT_test);
+    tcase_add_test(Case, Thread_Pool_test_shared);
+    tcase_add_test(Case, Split_FFT_Kernels_test);
+    tcase_add_test(Case, Split_FFT_test_threads);
+    tcase_add_test(Case, Six_Step_FFT_test_threads);
+    tcase_add_test(Case, COBRA_Bit_Reverse_test);
+    tcase_add_test(Case, FFT_Plan_test_twiddles);
+    tcase_add_test(Case, Real_FFT_test);
+    tcase_add_test(Case, Batch_FFT_test_in_place);
+}
+
+
+Suite* Fixed_Test_suite(void) {
+    Suite *s = suite_create("FixedSuite");
+
+    TCase *tc_fixed = tcase_create("FixedInputs");
+    Call_Fixed_Tests(tc_fixed);
+    suite_add_tcase(s, tc_fixed);
+    return s;
+}
+
+
+void Fixed_Setup(){
+    SRunner *sr = srunner_create(Fixed_Test_suite());
+    srunner_run_all(sr, CK_NORMAL);
+    srunner_free(sr);
+}
+
+
+
 void Test_Setup(){
     mpz_inits(global_a_value, global_b_value, NULL);
     Basic_Math_Setup();
@@ -343,6 +1689,8 @@ void Test_Setup(){
     mpz_inits(global_a_value, global_b_value, NULL);
     Uneven_Polynomial_Setup();
     mpz_clears(global_a_value, global_b_value, NULL);
+
+    Fixed_Setup();
     
 
 
@@ -1,8 +1,22 @@
 #include "../Helper_Functions.h"
 #include "../Recursive_fft.h"
 #include "../iterative_fft.h"
+#include "../parallel_fft.h"
+#include "../ntt.h"
+#include "../fft_rounding.h"
+#include "../integer_multiply.h"
+#include "../file_multiply.h"
+#include "../prepared_multiply.h"
+#include "../six_step_fft.h"
+#include "../mixed_radix_fft.h"
+#include "../bluestein_fft.h"
+#include "../batch_fft.h"
+#include "../block_convolver.h"
 #include "../dft.h"
 #include "../karatsuba.h"
+#include "../parallel_karatsuba.h"
+#include "../toom_cook.h"
+#include "../polynomial_multiply.h"
 #include "../Naive_Polynomial_Multiplication.h"
 #include <check.h>
 
@@ -1,26 +1,36 @@
+import json
+import sys
 import pandas as pd
 import matplotlib.pyplot as plt
 
 def read_computation_times(file_path):
+    # The benchmark writes one row per algorithm and size, as CSV or JSON
+    if file_path.endswith('.json'):
+        with open(file_path, 'r') as file:
+            return pd.DataFrame(json.load(file)["results"])
+    if file_path.endswith('.csv'):
+        return pd.read_csv(file_path)
+
+    # Old format, one line of times per algorithm
     data = {}
-    
     with open(file_path, 'r') as file:
         for line in file:
             name, values = line.split(':')
             name = name.strip().replace(' multiplication', '').replace(' ', '_')
             values = [float(x) for x in values.split()]
             data[name] = values
-    
-    return data
+    wide = pd.DataFrame(data)
+    df = wide.melt(id_vars="n_size", var_name="algorithm", value_name="median_s")
+    df = df.rename(columns={"n_size": "n"})
+    df["median_ci_low_s"] = df["median_s"]
+    df["median_ci_high_s"] = df["median_s"]
+    return df
 
-# Path to the txt file
-file_path = 'Computation_times.txt'
+# Path to the results, CSV or JSON from the benchmark
+file_path = sys.argv[1] if len(sys.argv) > 1 else 'Computation_times.csv'
 
 # Read the data
-data = read_computation_times(file_path)
-
-# Convert to DataFrame
-df = pd.DataFrame(data)
+df = read_computation_times(file_path)
 
 # Plotting
 plt.figure(figsize=(12, 8))
@@ -31,15 +41,21 @@ colors = {
     "DFT": "green",
     "Karatsuba": "red",
     "Recursive_FFT": "magenta",
-    "Iterative_FFT": "blue"
+    "Iterative_FFT": "blue",
+    "NTT": "black"
 }
 
-# Draw
-for column in df.columns[1:]:
-    plt.plot(df["n_size"], df[column], marker='o', label=column.replace('_', ' '), color=colors[column])
+# Draw the median with its 95% confidence interval as error bars
+for algorithm, rows in df.groupby("algorithm", sort=False):
+    errors = [rows["median_s"] - rows["median_ci_low_s"],
+              rows["median_ci_high_s"] - rows["median_s"]]
+    plt.errorbar(rows["n"], rows["median_s"], yerr=errors, marker='o', capsize=3,
+                 label=algorithm.replace('_', ' '), color=colors.get(algorithm))
 
+plt.xscale("log", base=2)
+plt.yscale("log")
 plt.xlabel("n size")
-plt.ylabel("Time in seconds")
+plt.ylabel("Median time in seconds")
 plt.title("Polynomial Multiplication Algorithms Performance")
 plt.legend()
 plt.grid(True, which="both", ls="--")
@@ -1,85 +1,14 @@
 #include "karatsuba_optimisation.h"
 
 // Karatsuba multiplication for polynomials
+// Same as Karatsuba_Polynomial with the base case size as a parameter
 void Karatsuba_Multiply_optimised(int *input1, int *input2, int naive_switch, int length_input1,
                             int length_input2, int *result) {
-    
-    // Check if either number is 2 digits, if yes then multiply.
-    // C is really fast for small number multiplication, so it doesn't need to check for 1 digit
-    if (length_input1 <= naive_switch || length_input2 <= naive_switch) { // Base case for the smallest size
-        Array_Multiplication(input1, input2, length_input1,
-                                length_input2, result);
-        return;
-    }
-    // Calculate half length
-    int half_length1 = (length_input1 + 1) >> 1; // Equivalent to ceil(length_input1 / 2)
-    int half_length2 = (length_input2 + 1) >> 1; // Equivalent to ceil(length_input2 / 2)
-
-    // Find the longest half length
-    int half_length = (half_length1 > half_length2) ? half_length1 : half_length2;
-
-
-    // Allocate memory
-    int *low1 = calloc(half_length, sizeof(int));
-    int *low2 = calloc(half_length, sizeof(int));
-    int *high1 = calloc(half_length, sizeof(int));
-    int *high2 = calloc(half_length, sizeof(int));
-    int *result_low = calloc(length_input1 + length_input2 - 1, sizeof(int));
-    int *result_high = calloc(length_input1 + length_input2 - 1, sizeof(int));
-    int *result_middle = calloc(length_input1 + length_input2 - 1, sizeof(int));
-
-    // Seperate the polynomials into highs and lows
-    memcpy(low1, input1, half_length * sizeof(int));
-    memcpy(low2, input2, half_length * sizeof(int));
-    memcpy(high1, input1 + half_length,
-            (length_input1 - half_length1) * sizeof(int));
-    memcpy(high2, input2 + half_length,
-            (length_input2 - half_length2) * sizeof(int));
-    
-    // First 2 recursive calls
-    Karatsuba_Multiply_optimised(low1, low2, naive_switch, half_length, half_length, result_low);
-    Karatsuba_Multiply_optimised(high1, high2, naive_switch, half_length, half_length, result_high);
-
-    // Third recursive call
-    // long long product_middle  = karatsuba(low1 + high1, low2 + high2);
-    int *temp1 = calloc(half_length, sizeof(int));
-    int *temp2 = calloc(half_length, sizeof(int));
-    Array_Addition(low1, high1, half_length, temp1);
-    Array_Addition(low2, high2, half_length, temp2);
-    Karatsuba_Multiply_optimised(temp1, temp2, naive_switch, half_length, half_length, result_middle);
-
-    // Calculate middle coefficients (result_middle = result_middle - result_low - result_high)
-    Array_Subtraction(result_middle, result_low, length_input1 + length_input2
-                        - 1, result_middle);
-    Array_Subtraction(result_middle, result_high, length_input1 + length_input2
-                        - 1, result_middle);
-
-    // Assemble final result
-    // result = result_low + (result_middle << half_length1) + (result_high << (half_length1 * 2))
-    int max_length = length_input1 + length_input2 - 1;
-
-    for (int i = 0; i < max_length; i++) {
-        result[i] = result_low[i];  // Set result to low part
-
-        // Add middle part if within its valid range
-        if (i >= half_length) {
-            result[i] += result_middle[i - half_length];
-        }
-
-        // Add high part if within its valid range
-        if (i >= 2 * half_length) {
-            result[i] += result_high[i - 2 * half_length];
-        }
-    }
-    free(low1);
-    free(low2);
-    free(high1);
-    free(high2);
-    free(result_low);
-    free(result_middle);
-    free(result_high);
-    free(temp1);
-    free(temp2);
+    int *scratch = (int *)malloc(Karatsuba_Scratch_Size(length_input1, length_input2,
+                                    naive_switch) * sizeof(int) + sizeof(int));
+    Karatsuba_Polynomial_ext(input1, input2, length_input1, length_input2, result,
+                                scratch, naive_switch);
+    free(scratch);
 }
 
 // Function to measure execution time of the Karatsuba function
@@ -0,0 +1,150 @@
+#include "threshold_tuning.h"
+
+// Every time is the fastest of at least TUNING_REPEATS runs and of as many
+// runs as fit in TUNING_MIN_TIME seconds, the fastest run is the one least
+// disturbed by the rest of the system
+#define TUNING_REPEATS 5
+#define TUNING_MIN_TIME 0.05
+
+// Sizes grow by this factor between measurements, up to TUNING_MAX_DIGITS
+#define TUNING_STEP 1.25
+#define TUNING_MAX_DIGITS 524288
+
+// A larger engine only wins when it is this much faster, at small sizes the
+// engines run the same base case and the difference is noise
+#define TUNING_MARGIN 0.95
+
+
+// Length of the result arrays, a power of two that holds the product
+static int Result_Size(int digits) {
+    int n = 2;
+    while (n < 2 * digits) {
+        n <<= 1;
+    }
+    return n;
+}
+
+// Fastest time of engine on two random numbers of digits digits
+static double Engine_Time(Multiply_Engine engine, int digits, gmp_randstate_t state) {
+    int n = Result_Size(digits);
+    mpz_t a, b;
+    mpz_inits(a, b, NULL);
+    Random_Digits(a, state, digits);
+    Random_Digits(b, state, digits);
+    int *result = (int *)calloc(n, sizeof(int));
+    Multiply_Context *context = Get_Default_Multiply_Context(n);
+
+    // The first call creates the plans and buffers
+    polynomial_multiply_engine(engine, a, b, n, result, context);
+
+    double best = INFINITY, total = 0.0;
+    for (int i = 0; i < TUNING_REPEATS || total < TUNING_MIN_TIME; i++) {
+        double time = polynomial_multiply_engine(engine, a, b, n, result, context);
+        total += time;
+        if (time < best) {
+            best = time;
+        }
+    }
+    free(result);
+    mpz_clears(a, b, NULL);
+    return best;
+}
+
+// Karatsuba cutoff with the fastest multiplication of 4096 digits
+static int Tune_Karatsuba_Cutoff(gmp_randstate_t state) {
+    int cutoffs[] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+    int count = sizeof(cutoffs) / sizeof(cutoffs[0]);
+    int best_cutoff = KARATSUBA_CUTOFF;
+    double best_time = INFINITY;
+    printf("\nKaratsuba cutoff\n");
+    for (int i = 0; i < count; i++) {
+        Set_Karatsuba_Cutoff(cutoffs[i]);
+        double time = Engine_Time(MULTIPLY_ENGINE_KARATSUBA, 4096, state);
+        printf("%8d:\t%f seconds\n", cutoffs[i], time);
+        if (time < best_time) {
+            best_time = time;
+            best_cutoff = cutoffs[i];
+        }
+    }
+    Set_Karatsuba_Cutoff(best_cutoff);
+    return best_cutoff;
+}
+
+void Threshold_Tuning() {
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, time(NULL));
+
+    int cutoff = Tune_Karatsuba_Cutoff(state);
+
+    // Walk up the sizes with the engine that is fastest so far. At every size
+    // it is timed against all larger engines, and the fastest of those takes
+    // over when it wins by TUNING_MARGIN at two sizes in a row. An engine that is overtaken
+    // before it ever wins is never used
+    int thresholds[MULTIPLY_ENGINES];
+    for (int engine = 0; engine < MULTIPLY_ENGINES; engine++) {
+        thresholds[engine] = INT_MAX;
+    }
+    Multiply_Engine current = MULTIPLY_ENGINE_NAIVE;
+    Multiply_Engine candidate = MULTIPLY_ENGINES;
+    int candidate_digits = 0;
+    printf("\n%8s", "digits");
+    for (int engine = 0; engine < MULTIPLY_ENGINES; engine++) {
+        printf("\t%14s", Multiply_Engine_Name(engine));
+    }
+    printf("\n");
+    for (double size = 16; size <= TUNING_MAX_DIGITS &&
+                            current != MULTIPLY_ENGINES - 1; size *= TUNING_STEP) {
+        int digits = (int)size;
+        printf("%8d", digits);
+        for (int engine = 0; engine < current; engine++) {
+            printf("\t%14s", "");
+        }
+        double time_current = Engine_Time(current, digits, state);
+        printf("\t%14f", time_current);
+        Multiply_Engine winner = MULTIPLY_ENGINES;
+        double time_winner = time_current * TUNING_MARGIN;
+        for (int engine = current + 1; engine < MULTIPLY_ENGINES; engine++) {
+            double time = Engine_Time(engine, digits, state);
+            printf("\t%14f", time);
+            if (time < time_winner) {
+                time_winner = time;
+                winner = engine;
+            }
+        }
+        printf("\n");
+
+        if (winner != MULTIPLY_ENGINES && winner == candidate) {
+            thresholds[winner] = candidate_digits;
+            current = winner;
+            candidate = MULTIPLY_ENGINES;
+        } else {
+            candidate = winner;
+            candidate_digits = digits;
+        }
+    }
+
+    Multiply_Thresholds tuned = {
+        .karatsuba_cutoff = cutoff,
+        .karatsuba = thresholds[MULTIPLY_ENGINE_KARATSUBA],
+        .toom = thresholds[MULTIPLY_ENGINE_TOOM],
+        .fft = thresholds[MULTIPLY_ENGINE_FFT],
+        .mixed_radix = thresholds[MULTIPLY_ENGINE_MIXED_RADIX],
+        .ntt = thresholds[MULTIPLY_ENGINE_NTT],
+    };
+
+    printf("\nKaratsuba cutoff:\t%d\n", tuned.karatsuba_cutoff);
+    printf("Karatsuba from:\t\t%d digits\n", tuned.karatsuba);
+    printf("Toom-Cook from:\t\t%d digits\n", tuned.toom);
+    printf("FFT from:\t\t%d digits\n", tuned.fft);
+    printf("Mixed radix from:\t%d digits\n", tuned.mixed_radix);
+    printf("NTT from:\t\t%d digits\n", tuned.ntt);
+
+    Set_Multiply_Thresholds(tuned);
+    if (Save_Multiply_Thresholds(MULTIPLY_THRESHOLDS_FILE, tuned)) {
+        printf("Saved to %s\n", MULTIPLY_THRESHOLDS_FILE);
+    } else {
+        printf("Error writing %s\n", MULTIPLY_THRESHOLDS_FILE);
+    }
+    gmp_randclear(state);
+}
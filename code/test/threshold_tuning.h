@@ -0,0 +1,15 @@
+#ifndef threshold_tuning_H
+#define threshold_tuning_H
+#include "../Helper_Functions.h"
+#include "../polynomial_multiply.h"
+
+// Measure the crossover thresholds of polynomial_multiply on this machine
+// The Karatsuba cutoff is found first by timing Karatsuba with a range of
+// cutoffs. Then the engines are timed on random operands of growing size,
+// starting with the naive multiplication. The engine in use is compared with
+// every larger one, and the threshold of an engine is the first size from
+// which it is the fastest twice in a row. The thresholds are used right
+// away and saved to MULTIPLY_THRESHOLDS_FILE for the next start.
+void Threshold_Tuning();
+
+#endif
@@ -0,0 +1,217 @@
+#include "thread_pool.h"
+
+// Pools created by Get_Thread_Pool, one per thread count
+static Thread_Pool *shared_pools = NULL;
+static pthread_mutex_t shared_pools_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The pool and index of the running thread, set by every worker at start
+static __thread Thread_Pool *thread_pool = NULL;
+static __thread int thread_index = 0;
+
+typedef struct {
+    Thread_Pool *pool;
+    int index;
+} Worker_Start;
+
+
+static void Deque_Push(Task_Deque *deque, Task task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom == deque->capacity) {
+        if (deque->top > 0) {
+            // Move the tasks down over the stolen ones
+            memmove(deque->tasks, deque->tasks + deque->top,
+                    (deque->bottom - deque->top) * sizeof(Task));
+            deque->bottom -= deque->top;
+            deque->top = 0;
+        } else {
+            deque->capacity *= 2;
+            deque->tasks = (Task *)realloc(deque->tasks, deque->capacity * sizeof(Task));
+        }
+    }
+    deque->tasks[deque->bottom++] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+// The newest task for the owner (bottom) or the oldest for a thief (top)
+static bool Deque_Take(Task_Deque *deque, bool steal, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->bottom > deque->top;
+    if (found) {
+        *task = steal ? deque->tasks[deque->top++] : deque->tasks[--deque->bottom];
+        if (deque->top == deque->bottom) {
+            deque->top = 0;
+            deque->bottom = 0;
+        }
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Run one queued task, the own deque first, then steal from the others
+static bool Run_One_Task(Thread_Pool *pool, int index) {
+    if (atomic_load(&pool->queued) == 0) {
+        return false;
+    }
+    Task task;
+    bool found = Deque_Take(&pool->deques[index], false, &task);
+    for (int i = 1; i < pool->threads && !found; i++) {
+        found = Deque_Take(&pool->deques[(index + i) % pool->threads], true, &task);
+    }
+    if (!found) {
+        return false;
+    }
+    atomic_fetch_sub(&pool->queued, 1);
+    task.function(task.argument);
+    // The task's writes are visible to whoever sees the count drop. The
+    // last task of a group wakes the thread sleeping in Thread_Pool_Wait
+    if (atomic_fetch_sub(&task.group->pending, 1) == 1) {
+        pthread_mutex_lock(&pool->sleep_lock);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->sleep_lock);
+    }
+    return true;
+}
+
+static void *Worker(void *argument) {
+    Worker_Start *start = (Worker_Start *)argument;
+    Thread_Pool *pool = start->pool;
+    thread_pool = pool;
+    thread_index = start->index;
+    free(start);
+
+    while (true) {
+        if (Run_One_Task(pool, thread_index)) {
+            continue;
+        }
+        // Nothing to do, sleep until a task is spawned. queued is checked
+        // under the lock the spawner signals with, so no wake up is lost
+        pthread_mutex_lock(&pool->sleep_lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->sleep_lock);
+        }
+        bool stop = pool->stop;
+        pthread_mutex_unlock(&pool->sleep_lock);
+        if (stop) {
+            return NULL;
+        }
+    }
+}
+
+Thread_Pool *Thread_Pool_Create(int threads) {
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+    Thread_Pool *pool = (Thread_Pool *)calloc(1, sizeof(Thread_Pool));
+    pool->threads = threads;
+    pool->deques = (Task_Deque *)calloc(threads, sizeof(Task_Deque));
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->deques[i].capacity = 64;
+        pool->deques[i].tasks = (Task *)malloc(64 * sizeof(Task));
+    }
+    atomic_init(&pool->queued, 0);
+    pthread_mutex_init(&pool->sleep_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    pool->workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for (int i = 1; i < threads; i++) {
+        Worker_Start *start = (Worker_Start *)malloc(sizeof(Worker_Start));
+        start->pool = pool;
+        start->index = i;
+        pthread_create(&pool->workers[i], NULL, Worker, start);
+    }
+    return pool;
+}
+
+void Thread_Pool_Free(Thread_Pool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->sleep_lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->sleep_lock);
+    for (int i = 1; i < pool->threads; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    for (int i = 0; i < pool->threads; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].tasks);
+    }
+    pthread_mutex_destroy(&pool->sleep_lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
+
+Thread_Pool *Get_Thread_Pool(int threads) {
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+    pthread_mutex_lock(&shared_pools_lock);
+    Thread_Pool *pool = shared_pools;
+    while (pool != NULL && pool->threads != threads) {
+        pool = pool->next;
+    }
+    if (pool == NULL) {
+        pool = Thread_Pool_Create(threads);
+        pool->next = shared_pools;
+        shared_pools = pool;
+    }
+    pthread_mutex_unlock(&shared_pools_lock);
+    return pool;
+}
+
+void Free_Thread_Pool() {
+    pthread_mutex_lock(&shared_pools_lock);
+    while (shared_pools != NULL) {
+        Thread_Pool *next = shared_pools->next;
+        Thread_Pool_Free(shared_pools);
+        shared_pools = next;
+    }
+    pthread_mutex_unlock(&shared_pools_lock);
+}
+
+void Task_Group_Init(Task_Group *group) {
+    atomic_init(&group->pending, 0);
+}
+
+void Thread_Pool_Spawn(Thread_Pool *pool, Task_Group *group, Task_Function function,
+                        void *argument) {
+    Task task = {function, argument, group};
+    atomic_fetch_add(&group->pending, 1);
+    Deque_Push(&pool->deques[(thread_pool == pool) ? thread_index : 0], task);
+    atomic_fetch_add(&pool->queued, 1);
+
+    pthread_mutex_lock(&pool->sleep_lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->sleep_lock);
+}
+
+void Thread_Pool_Wait(Thread_Pool *pool, Task_Group *group) {
+    int index = (thread_pool == pool) ? thread_index : 0;
+    while (atomic_load(&group->pending) > 0) {
+        // Help with the queued tasks, some of them are likely our own
+        if (Run_One_Task(pool, index)) {
+            continue;
+        }
+        // Our tasks are running on other threads, sleep until they are done
+        // or a new task can be helped with
+        pthread_mutex_lock(&pool->sleep_lock);
+        while (atomic_load(&group->pending) > 0 && atomic_load(&pool->queued) == 0) {
+            pthread_cond_wait(&pool->wake, &pool->sleep_lock);
+        }
+        pthread_mutex_unlock(&pool->sleep_lock);
+    }
+}
+
+int Thread_Pool_Thread_Index() {
+    return thread_index;
+}
@@ -0,0 +1,84 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <pthread.h>
+#include <stdatomic.h>
+#include "Helper_Functions.h"
+
+// Work-stealing thread pool for fork-join recursions
+// The parallel FFT splits its work evenly up front. A recursion like
+// Karatsuba makes tasks of uneven size while it runs, and waiting for a
+// thread per task would cost more than small tasks. Here the worker threads
+// are started once and kept, and both run their tasks on them. Every
+// thread has its own deque of tasks: a thread pushes the tasks it spawns to
+// the bottom of its deque and takes its next task from the bottom (the most
+// recent, smallest one, whose data is still in its cache). An idle thread
+// steals from the top of another thread's deque, which holds the oldest and
+// largest tasks, so one steal moves a big piece of work. A thread that waits
+// for its tasks runs queued tasks meanwhile and only sleeps when there are
+// none, so nested waits never deadlock.
+//
+// The thread that calls into the pool counts as thread 0 and the workers as
+// 1 .. threads - 1. Only one outside thread may use a pool at a time.
+
+typedef void (*Task_Function)(void *argument);
+
+// Tasks spawned into a group are waited for together
+typedef struct {
+    atomic_int pending;
+} Task_Group;
+
+typedef struct {
+    Task_Function function;
+    void *argument;
+    Task_Group *group;
+} Task;
+
+// Tasks of one thread, tasks[top .. bottom - 1]. The owner works at the
+// bottom and thieves at the top
+typedef struct {
+    pthread_mutex_t lock;
+    Task *tasks;
+    int capacity;
+    int top;
+    int bottom;
+} Task_Deque;
+
+typedef struct Thread_Pool {
+    int threads;                // Including the calling thread
+    pthread_t *workers;         // threads - 1 worker threads
+    Task_Deque *deques;         // One per thread
+    atomic_int queued;          // Tasks in all deques
+    pthread_mutex_t sleep_lock; // Idle workers sleep on wake
+    pthread_cond_t wake;
+    bool stop;
+    struct Thread_Pool *next;   // Next pool in the list of Get_Thread_Pool
+} Thread_Pool;
+
+Thread_Pool *Thread_Pool_Create(int threads);
+
+void Thread_Pool_Free(Thread_Pool *pool);
+
+// The pool of threads threads shared by the parallel algorithms, created on
+// first use and kept. The FFT and Karatsuba can be set to different thread
+// counts, each count has its own pool so switching between them never
+// restarts the workers. 0 threads uses every online cpu
+Thread_Pool *Get_Thread_Pool(int threads);
+
+// Free every pool created by Get_Thread_Pool
+void Free_Thread_Pool();
+
+void Task_Group_Init(Task_Group *group);
+
+// Queue function(argument) as part of group
+void Thread_Pool_Spawn(Thread_Pool *pool, Task_Group *group, Task_Function function,
+                        void *argument);
+
+// Return when every task of group has finished, running queued tasks of the
+// pool while waiting
+void Thread_Pool_Wait(Thread_Pool *pool, Task_Group *group);
+
+// Index of the calling thread in its pool, 0 for a thread outside the pool.
+// Lets tasks use per-thread memory
+int Thread_Pool_Thread_Index();
+
+#endif
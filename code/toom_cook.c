@@ -0,0 +1,343 @@
+#include "toom_cook.h"
+
+// Largest value of h * (bound of the evaluated values)^2 a split may reach.
+// The pointwise products are at most that large and the interpolation
+// combines a few of them with factors up to 64 before dividing, so this
+// leaves 2^8 of room below 2^63
+#define TOOM_SAFE_PRODUCT (36028797018963968.0) // 2^55
+
+// How much larger than the input values the evaluated values can get:
+// |A(1)| <= 2B for Karatsuba, |A(-2)| <= 7B for Toom-3 and
+// |A(2)|, |A(-2)|, |8 A(1/2)| <= 15B for Toom-4
+static const double toom_growth[5] = {0, 0, 2, 7, 15};
+
+// Weights of the parts a_0 .. a_{k-1} for every evaluation point
+//     way 2: 0, 1, inf
+//     way 3: 0, 1, -1, -2, inf
+//     way 4: 0, 1, -1, 2, -2, 1/2 (times 8), inf
+static const int toom_weights[5][7][4] = {
+    [2] = {{1, 0}, {1, 1}, {0, 1}},
+    [3] = {{1, 0, 0}, {1, 1, 1}, {1, -1, 1}, {1, -2, 4}, {0, 0, 1}},
+    [4] = {{1, 0, 0, 0}, {1, 1, 1, 1}, {1, -1, 1, -1}, {1, 2, 4, 8},
+            {1, -2, 4, -8}, {8, 4, 2, 1}, {0, 0, 0, 1}},
+};
+
+
+// Split used for inputs of these lengths with values of at most bound,
+// 0 for the schoolbook multiplication
+static int Toom_Way(int length_a, int length_b, int way, double bound) {
+    if (length_a <= TOOM_CUTOFF || length_b <= TOOM_CUTOFF) {
+        return 0;
+    }
+    int length = (length_a > length_b) ? length_a : length_b;
+    for (int k = way; k >= 2; k--) {
+        int h = (length + k - 1) / k;
+        double child_bound = bound * toom_growth[k];
+        if ((double)h * child_bound * child_bound < TOOM_SAFE_PRODUCT) {
+            return k;
+        }
+    }
+    return 0;
+}
+
+// Scratch memory of Toom_Recursive, the 2k - 1 evaluations of both inputs
+// and the 2k - 1 products of each level, the levels stack up since every
+// recursive call of a level has the same size
+static int Toom_Recursive_Scratch(int length_a, int length_b, int way, double bound) {
+    int size = 0;
+    int k;
+    int length_short = (length_a < length_b) ? length_a : length_b;
+    int length_long = (length_a > length_b) ? length_a : length_b;
+    if (length_short > TOOM_CUTOFF && 2 * length_short <= length_long) {
+        // The chunk product and the padded last chunk of Toom_Unbalanced
+        size += 3 * length_short;
+        length_a = length_short;
+        length_b = length_short;
+    }
+    while ((k = Toom_Way(length_a, length_b, way, bound)) != 0) {
+        int length = (length_a > length_b) ? length_a : length_b;
+        int h = (length + k - 1) / k;
+        size += 4 * (2 * k - 1) * h;
+        length_a = h;
+        length_b = h;
+        bound *= toom_growth[k];
+    }
+    return size;
+}
+
+int Toom_Scratch_Size(int length_input1, int length_input2, int way,
+                        int max_coefficient) {
+    // The inputs and the result as long long, then the recursion
+    return 2 * (length_input1 + length_input2) +
+            Toom_Recursive_Scratch(length_input1, length_input2, way, max_coefficient);
+}
+
+static void Schoolbook_Long(const long long *a, const long long *b, int length_a,
+                            int length_b, long long *result) {
+    memset(result, 0, (length_a + length_b - 1) * sizeof(long long));
+    for (int i = 0; i < length_a; i++) {
+        for (int j = 0; j < length_b; j++) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+}
+
+// Turn the values at the points into the coefficients c_0 .. c_{2k-2} of the
+// product, in place. products[p] holds the product at point p for each of
+// the length coefficients, the points are in the order of toom_weights
+static void Toom_Interpolate(long long *products, int stride, int length, int way) {
+    long long *r0 = products;
+    long long *r1 = products + stride;
+    long long *r2 = products + 2 * stride;
+    long long *r3 = products + 3 * stride;
+    long long *r4 = products + 4 * stride;
+    long long *r5 = products + 5 * stride;
+    long long *r6 = products + 6 * stride;
+
+    if (way == 2) {
+        // Karatsuba, c1 = r(1) - r(0) - r(inf)
+        for (int t = 0; t < length; t++) {
+            r1[t] -= r0[t] + r2[t];
+        }
+    } else if (way == 3) {
+        // Bodrato's sequence for the points 0, 1, -1, -2, inf
+        for (int t = 0; t < length; t++) {
+            long long value_inf = r4[t];
+            long long c3 = (r3[t] - r1[t]) / 3;
+            long long c1 = (r1[t] - r2[t]) >> 1;
+            long long c2 = r2[t] - r0[t];
+            c3 = ((c2 - c3) >> 1) + 2 * value_inf;
+            c2 = c2 + c1 - value_inf;
+            c1 = c1 - c3;
+            r1[t] = c1;
+            r2[t] = c2;
+            r3[t] = c3;
+        }
+    } else {
+        // Points 0, 1, -1, 2, -2, 1/2, inf. The even and odd parts of
+        // r(1), r(-1) and r(2), r(-2) give c2 + c4 and c2 + 4 c4, and three
+        // equations for c1, c3 and c5:
+        //     c1 + c3 + c5 = odd1
+        //     c1 + 4 c3 + 16 c5 = odd2
+        //     16 c1 + 4 c3 + c5 = (64 r(1/2) - 64 c0 - 16 c2 - 4 c4 - c6) / 2
+        for (int t = 0; t < length; t++) {
+            long long c0 = r0[t];
+            long long c6 = r6[t];
+            long long even1 = (r1[t] + r2[t]) >> 1;
+            long long odd1 = (r1[t] - r2[t]) >> 1;
+            long long even2 = (r3[t] + r4[t]) >> 1;
+            long long odd2 = (r3[t] - r4[t]) >> 2;
+            long long sum24 = even1 - c0 - c6;                      // c2 + c4
+            long long c4 = ((even2 - c0 - 64 * c6) / 4 - sum24) / 3;
+            long long c2 = sum24 - c4;
+            long long half = (r5[t] - 64 * c0 - 16 * c2 - 4 * c4 - c6) >> 1;
+            long long u = (odd2 - odd1) / 3;                        // c3 + 5 c5
+            long long w = (half - odd1) / 3;                        // 5 c1 + c3
+            long long c3 = (5 * odd1 - u - w) / 3;
+            r1[t] = (w - c3) / 5;
+            r2[t] = c2;
+            r3[t] = c3;
+            r4[t] = c4;
+            r5[t] = (u - c3) / 5;
+        }
+    }
+}
+
+// Evaluate the input of length values, split in way parts of h values, at
+// every point of the split into evaluations (h values per point)
+static void Toom_Evaluate(const long long *input, int length, int h, int way,
+                            long long *evaluations) {
+    int points = 2 * way - 1;
+    memset(evaluations, 0, points * h * sizeof(long long));
+    for (int j = 0; j < way; j++) {
+        // The last parts can be short or empty, their missing values are zero
+        int part_length = length - j * h;
+        if (part_length > h) {
+            part_length = h;
+        }
+        const long long *part = input + j * h;
+        for (int p = 0; p < points; p++) {
+            long long weight = toom_weights[way][p][j];
+            if (weight == 0) {
+                continue;
+            }
+            long long *value = evaluations + p * h;
+            for (int i = 0; i < part_length; i++) {
+                value[i] += weight * part[i];
+            }
+        }
+    }
+}
+
+static void Toom_Recursive(const long long *a, const long long *b, int length_a,
+                            int length_b, long long *result, long long *scratch,
+                            int way, double bound);
+
+// Multiplication of a long input with one at most half as long. Splitting
+// both in k parts would make most parts of the short input zero, so the long
+// input is cut in chunks of the short length instead, and the balanced chunk
+// products are added up at their offsets. The last chunk is zero padded to
+// the full length so every chunk product is balanced
+static void Toom_Unbalanced(const long long *long_input, int length_long,
+                            const long long *short_input, int length_short,
+                            long long *result, long long *scratch, int way,
+                            double bound) {
+    long long *chunk_product = scratch;
+    long long *padded_chunk = chunk_product + 2 * length_short;
+    long long *next_scratch = padded_chunk + length_short;
+    int max_length = length_long + length_short - 1;
+    memset(result, 0, max_length * sizeof(long long));
+    for (int offset = 0; offset < length_long; offset += length_short) {
+        const long long *chunk = long_input + offset;
+        int chunk_length = length_long - offset;
+        if (chunk_length < length_short) {
+            memcpy(padded_chunk, chunk, chunk_length * sizeof(long long));
+            memset(padded_chunk + chunk_length, 0,
+                    (length_short - chunk_length) * sizeof(long long));
+            chunk = padded_chunk;
+        }
+        Toom_Recursive(chunk, short_input, length_short, length_short,
+                        chunk_product, next_scratch, way, bound);
+        // The padded part of the product is zero
+        int product_length = 2 * length_short - 1;
+        if (product_length > max_length - offset) {
+            product_length = max_length - offset;
+        }
+        for (int t = 0; t < product_length; t++) {
+            result[offset + t] += chunk_product[t];
+        }
+    }
+}
+
+// Toom-Cook multiplication on long long values of at most bound
+static void Toom_Recursive(const long long *a, const long long *b, int length_a,
+                            int length_b, long long *result, long long *scratch,
+                            int way, double bound) {
+    if (length_a > TOOM_CUTOFF && 2 * length_a <= length_b) {
+        Toom_Unbalanced(b, length_b, a, length_a, result, scratch, way, bound);
+        return;
+    }
+    if (length_b > TOOM_CUTOFF && 2 * length_b <= length_a) {
+        Toom_Unbalanced(a, length_a, b, length_b, result, scratch, way, bound);
+        return;
+    }
+    int k = Toom_Way(length_a, length_b, way, bound);
+    if (k == 0) {
+        Schoolbook_Long(a, b, length_a, length_b, result);
+        return;
+    }
+    int length = (length_a > length_b) ? length_a : length_b;
+    int h = (length + k - 1) / k;
+    int points = 2 * k - 1;
+    int max_length = length_a + length_b - 1;
+
+    // Views into the scratch memory
+    long long *evaluations_a = scratch;
+    long long *evaluations_b = evaluations_a + points * h;
+    long long *products = evaluations_b + points * h;       // Stride 2 * h
+    long long *next_scratch = products + points * 2 * h;
+
+    Toom_Evaluate(a, length_a, h, k, evaluations_a);
+    Toom_Evaluate(b, length_b, h, k, evaluations_b);
+
+    // 2k - 1 recursive calls of a k'th of the size
+    double child_bound = bound * toom_growth[k];
+    for (int p = 0; p < points; p++) {
+        Toom_Recursive(evaluations_a + p * h, evaluations_b + p * h, h, h,
+                        products + p * 2 * h, next_scratch, way, child_bound);
+    }
+
+    Toom_Interpolate(products, 2 * h, 2 * h - 1, k);
+
+    // result = sum of c_p << (p * h), the coefficients past the length of the
+    // product are zero
+    memset(result, 0, max_length * sizeof(long long));
+    for (int p = 0; p < points; p++) {
+        int offset = p * h;
+        int coefficient_length = 2 * h - 1;
+        if (coefficient_length > max_length - offset) {
+            coefficient_length = max_length - offset;
+        }
+        long long *coefficient = products + p * 2 * h;
+        for (int t = 0; t < coefficient_length; t++) {
+            result[offset + t] += coefficient[t];
+        }
+    }
+}
+
+void Toom_Polynomial_ext(int *input1, int *input2, int length_input1,
+                            int length_input2, int *result, long long *scratch,
+                            int way, int max_coefficient) {
+    int max_length = length_input1 + length_input2 - 1;
+    long long *a = scratch;
+    long long *b = a + length_input1;
+    long long *product = b + length_input2;
+    long long *next_scratch = product + length_input1 + length_input2;
+
+    for (int i = 0; i < length_input1; i++) {
+        a[i] = input1[i];
+    }
+    for (int i = 0; i < length_input2; i++) {
+        b[i] = input2[i];
+    }
+    Toom_Recursive(a, b, length_input1, length_input2, product, next_scratch,
+                    way, max_coefficient);
+    for (int i = 0; i < max_length; i++) {
+        result[i] = (int)product[i];
+    }
+}
+
+// Allocate the scratch memory once and multiply
+static void Toom_Polynomial(int *input1, int *input2, int length_input1,
+                            int length_input2, int *result, int way) {
+    long long *scratch = (long long *)malloc(
+        Toom_Scratch_Size(length_input1, length_input2, way, 9) * sizeof(long long));
+    Toom_Polynomial_ext(input1, input2, length_input1, length_input2, result,
+                        scratch, way, 9);
+    free(scratch);
+}
+
+void Toom3_Polynomial(int *input1, int *input2, int length_input1,
+                        int length_input2, int *result) {
+    Toom_Polynomial(input1, input2, length_input1, length_input2, result, 3);
+}
+
+void Toom4_Polynomial(int *input1, int *input2, int length_input1,
+                        int length_input2, int *result) {
+    Toom_Polynomial(input1, input2, length_input1, length_input2, result, 4);
+}
+
+
+double polynomial_multiply_toom(mpz_t a, mpz_t b, int n, int* toom_total_result) {
+    return polynomial_multiply_toom_ctx(a, b, n, toom_total_result,
+                                        Get_Default_Multiply_Context(n));
+}
+
+double polynomial_multiply_toom_ctx(mpz_t a, mpz_t b, int n, int* toom_total_result,
+                                    Multiply_Context *context) {
+    assert(n <= context->max_n);
+    int *padded_a = (int *)Context_Buffer(context, 0, context->max_n * sizeof(int));
+    int *padded_b = (int *)Context_Buffer(context, 1, context->max_n * sizeof(int));
+
+    memset(padded_a, 0, n * sizeof(int));
+    memset(padded_b, 0, n * sizeof(int));
+
+    int length_input1 = mpz_to_int_array(a, padded_a);
+    int length_input2 = mpz_to_int_array(b, padded_b);
+    int length = (length_input1 > length_input2) ? length_input1 : length_input2;
+    int way = (length < TOOM4_THRESHOLD) ? 3 : 4;
+
+    // The scratch size depends on the splits the bounds allow, the slot
+    // only grows when a call needs more than the previous ones
+    long long *scratch = (long long *)Context_Buffer(context, 2,
+        Toom_Scratch_Size(length_input1, length_input2, way, 9) * sizeof(long long));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Toom_Polynomial_ext(padded_a, padded_b, length_input1, length_input2,
+                        toom_total_result, scratch, way, 9);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_time = end.tv_sec - start.tv_sec + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    return elapsed_time;
+}
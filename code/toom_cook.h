@@ -0,0 +1,58 @@
+#ifndef TOOM_COOK_H
+#define TOOM_COOK_H
+#include "Helper_Functions.h"
+#include "multiply_context.h"
+
+// Toom-Cook multiplication for polynomials
+// Karatsuba splits both inputs in 2 parts and gets the product from 3
+// products of half the size. Toom-k splits them in k parts of h values,
+// A(x) = a_0 + a_1 x^h + ... + a_{k-1} x^{(k-1)h}, evaluates both at 2k - 1
+// points, multiplies the values pointwise (recursively) and interpolates the
+// 2k - 1 coefficients of the product back:
+//     Toom-3: 5 products of n/3, O(n^{log_3 5}) = O(n^1.46)
+//     Toom-4: 7 products of n/4, O(n^{log_4 7}) = O(n^1.40)
+// The points are 0, 1, -1, -2 and infinity for Toom-3 (interpolation
+// sequence by Bodrato) and 0, 1, -1, 2, -2, 1/2 and infinity for Toom-4,
+// where A(1/2) is scaled by 2^{k-1} to stay an integer. Every division of the
+// interpolation is exact.
+//
+// The evaluated values grow with every level of the recursion (up to 7
+// times for Toom-3 and 15 times for Toom-4), so the recursion works on long
+// long and checks the bound of the values before each split. When the next
+// split could overflow it uses a smaller split (Toom-4, Toom-3, Karatsuba)
+// or the schoolbook multiplication.
+
+// Length at or below which the schoolbook multiplication is used
+#define TOOM_CUTOFF 48
+
+// Length from which polynomial_multiply_toom uses Toom-4 instead of Toom-3
+#define TOOM4_THRESHOLD 1024
+
+// Number of long long values of scratch memory Toom_Polynomial_ext needs
+int Toom_Scratch_Size(int length_input1, int length_input2, int way,
+                        int max_coefficient);
+
+// Toom-way multiplication (way 3 or 4) of two polynomials with coefficients
+// of at most max_coefficient in absolute value into result
+// (length_input1 + length_input2 - 1 values), with the scratch memory
+// passed in
+void Toom_Polynomial_ext(int *input1, int *input2, int length_input1,
+                            int length_input2, int *result, long long *scratch,
+                            int way, int max_coefficient);
+
+// Toom-3 and Toom-4 multiplication of two polynomials of digits, allocates the
+// scratch memory
+void Toom3_Polynomial(int *input1, int *input2, int length_input1,
+                        int length_input2, int *result);
+
+void Toom4_Polynomial(int *input1, int *input2, int length_input1,
+                        int length_input2, int *result);
+
+// Toom-3 below TOOM4_THRESHOLD digits and Toom-4 from it
+double polynomial_multiply_toom(mpz_t a, mpz_t b, int n, int* toom_total_result);
+
+// Same multiplication with the scratch buffers of context
+double polynomial_multiply_toom_ctx(mpz_t a, mpz_t b, int n, int* toom_total_result,
+                                    Multiply_Context *context);
+
+#endif